@@ -0,0 +1,451 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "region_array.h"
+
+/*
+  CPU tile binner: object lists without the TA
+
+  CORE renders from a region array, object lists and ISP/TSP parameters (see
+  triangle_core.c); the TA is only one way to build them. For static or
+  already transformed (screen space) geometry, binner_build builds all three
+  on the CPU, for any tile count up to BINNER__TILE_MAX:
+
+  - ISP/TSP parameters: every triangle of a BINNER__TRIANGLES object is a
+    complete triangle parameter (instruction words and three vertices). A
+    BINNER__STRIP object is split into strips of at most
+    BINNER__STRIP_VERTICES vertices (six triangles); each strip repeats the
+    last two vertices of the previous one.
+
+  - object lists: one per tile, contiguous, ended by an end of list link.
+    Consecutive triangles that cover a tile share one triangle array entry
+    (OBJECT_LIST__POINTER_TYPE__TRIANGLE_ARRAY, up to 16 triangles). Each
+    strip that covers a tile is one triangle strip entry, whose mask selects
+    the strip's triangles that cover the tile.
+
+  - the region array: one entry per tile, with the opaque list pointer at the
+    tile's object list, or EMPTY for a tile that nothing covers.
+
+  A triangle covers a tile when its bounding box overlaps the tile, and none
+  of its edges has all four tile corners outside of it. This is
+  conservative: a triangle may be listed in a tile that it only nearly
+  touches. Degenerate (zero area) triangles are not listed.
+
+  Object lists are built in two passes over the geometry: the first counts
+  the words of each tile's list, the second writes them, so that every list
+  is contiguous and no OPB links are needed.
+
+  The binner only reads and writes memory. The output can be built in system
+  memory and copied to texture memory (sq_copy, see sq.h), as
+  triangle_core_binned.c does, or written to texture memory directly.
+  binner.h does not depend on the SH4; tools/binner_host.c runs it on the
+  host.
+
+  See DCDBSysArc990907E.pdf page 218-219 (object list) and 221 (ISP/TSP
+  parameter).
+ */
+
+/*
+  DCDBSysArc990907E.pdf page 218-219 describes the OBJECT_LIST__ bit fields:
+ */
+#define OBJECT_LIST__POINTER_TYPE__TRIANGLE_STRIP (0u << 31)
+#define OBJECT_LIST__POINTER_TYPE__TRIANGLE_ARRAY (0b100u << 29)
+#define OBJECT_LIST__POINTER_TYPE__OBJECT_POINTER_BLOCK_LINK (0b111u << 29)
+
+// triangle 0 of the strip is the most significant mask bit
+#define OBJECT_LIST__TRIANGLE_STRIP__MASK(n) (((n) & 0x3f) << 25)
+#define OBJECT_LIST__TRIANGLE_STRIP__SKIP(n) (((n) & 0x7) << 21)
+#define OBJECT_LIST__TRIANGLE_STRIP__START(n) (((n) & 0x1fffff) << 0)
+
+#define OBJECT_LIST__TRIANGLE_ARRAY__NUMBER_OF_TRIANGLES(n) (((n) & 0xf) << 25)
+#define OBJECT_LIST__TRIANGLE_ARRAY__SKIP(n) (((n) & 0x7) << 21)
+#define OBJECT_LIST__TRIANGLE_ARRAY__START(n) (((n) & 0x1fffff) << 0)
+
+#define OBJECT_LIST__OBJECT_POINTER_BLOCK_LINK__END_OF_LIST (1 << 28)
+
+/*
+  A non-textured, packed color, Gouraud shaded vertex, as stored in ISP/TSP
+  parameters; x and y are in pixels, z is 1/w.
+ */
+typedef struct binner_vertex {
+  float x;
+  float y;
+  float z;
+  uint32_t color;
+} binner_vertex;
+static_assert((sizeof (struct binner_vertex)) == 4 * 4);
+
+#define BINNER__VERTEX_WORDS 4
+// the object list skip value of BINNER__VERTEX_WORDS
+#define BINNER__SKIP (BINNER__VERTEX_WORDS - 3)
+// isp_tsp_instruction_word, tsp_instruction_word, texture_control_word
+#define BINNER__HEADER_WORDS 3
+#define BINNER__TRIANGLE_WORDS (BINNER__HEADER_WORDS + 3 * BINNER__VERTEX_WORDS)
+
+#define BINNER__TRIANGLE_ARRAY_MAX 16
+#define BINNER__STRIP_VERTICES 8
+
+// 40 × 30 tiles (1280 × 960); region array tile positions are 6 bits each
+#define BINNER__TILE_MAX 1200
+
+// binner_object types
+#define BINNER__TRIANGLES 0
+#define BINNER__STRIP 1
+
+typedef struct binner_object {
+  int type;
+  uint32_t isp_tsp_instruction_word;
+  uint32_t tsp_instruction_word;
+  uint32_t texture_control_word;
+  // BINNER__TRIANGLES: three vertices per triangle; BINNER__STRIP: at least
+  // three vertices
+  const binner_vertex * vertex;
+  int vertex_count;
+} binner_object;
+
+typedef struct binner {
+  int tile_x_num;
+  int tile_y_num;
+
+  // set by the caller: where the output is written, the addresses that the
+  // output refers to, and the capacity of each buffer
+  uint32_t * isp_tsp_parameter;
+  // the address of isp_tsp_parameter[0] relative to PARAM_BASE
+  uint32_t isp_tsp_parameter_offset;
+  uint32_t isp_tsp_parameter_capacity; // in words
+
+  uint32_t * object_list;
+  // the "32-bit" texture memory address of object_list[0]
+  uint32_t object_list_start;
+  uint32_t object_list_capacity; // in words
+
+  // tile_x_num × tile_y_num entries
+  region_array_entry * region_array;
+
+  // set by binner_build
+  uint32_t isp_tsp_parameter_words;
+  uint32_t object_list_words;
+  uint32_t triangles;     // non-degenerate triangles
+  uint32_t entries;       // object list entries, excluding end of list links
+  uint32_t tiles_covered; // tiles with a non-empty object list
+
+  // per tile: the first word of the object list, and the number of words
+  // counted (first pass) or the next word to write (second pass)
+  uint32_t tile_offset[BINNER__TILE_MAX];
+  uint32_t tile_cursor[BINNER__TILE_MAX];
+
+  // per tile: the triangle array entry that the next triangle is added to,
+  // if the triangle's parameter begins at run_end
+  uint32_t tile_run_end[BINNER__TILE_MAX];
+  uint32_t tile_run_entry[BINNER__TILE_MAX];
+  uint32_t tile_run_length[BINNER__TILE_MAX];
+} binner;
+
+typedef struct binner_tile_range {
+  int x0;
+  int y0;
+  int x1;
+  int y1;
+} binner_tile_range;
+
+static inline uint32_t binner_float_bits(float f)
+{
+  union {
+    float f;
+    uint32_t u;
+  } v = { .f = f };
+  return v.u;
+}
+
+// twice the signed area of (a, b, p)
+static inline float binner_edge(const binner_vertex * a, const binner_vertex * b, float x, float y)
+{
+  return (b->x - a->x) * (y - a->y) - (b->y - a->y) * (x - a->x);
+}
+
+/*
+  False if every corner of the tile (x0, y0)-(x1, y1) is outside of the edge
+  a→b; `sign` makes the inside of the triangle positive.
+ */
+static inline bool binner_edge_overlaps(const binner_vertex * a, const binner_vertex * b, float sign,
+                                        float x0, float y0, float x1, float y1)
+{
+  return sign * binner_edge(a, b, x0, y0) >= 0.0f
+      || sign * binner_edge(a, b, x1, y0) >= 0.0f
+      || sign * binner_edge(a, b, x0, y1) >= 0.0f
+      || sign * binner_edge(a, b, x1, y1) >= 0.0f;
+}
+
+static inline bool binner_triangle_overlaps(const binner_vertex * a, const binner_vertex * b, const binner_vertex * c,
+                                            float sign, int tile_x, int tile_y)
+{
+  const float x0 = (float)(tile_x * 32);
+  const float y0 = (float)(tile_y * 32);
+  const float x1 = x0 + 32.0f;
+  const float y1 = y0 + 32.0f;
+
+  return binner_edge_overlaps(a, b, sign, x0, y0, x1, y1)
+      && binner_edge_overlaps(b, c, sign, x0, y0, x1, y1)
+      && binner_edge_overlaps(c, a, sign, x0, y0, x1, y1);
+}
+
+// 1 or -1, by winding; 0 for a degenerate triangle
+static inline float binner_triangle_sign(const binner_vertex * a, const binner_vertex * b, const binner_vertex * c)
+{
+  float area = binner_edge(a, b, c->x, c->y);
+  return area > 0.0f ? 1.0f : (area < 0.0f ? -1.0f : 0.0f);
+}
+
+/*
+  The tiles overlapped by the bounding box of `length` vertices; false if the
+  bounding box is entirely outside of the tiles.
+ */
+bool binner_tile_range_of(const binner * b, const binner_vertex * v, int length, binner_tile_range * range)
+{
+  float min_x = v[0].x;
+  float min_y = v[0].y;
+  float max_x = v[0].x;
+  float max_y = v[0].y;
+  for (int i = 1; i < length; i++) {
+    if (v[i].x < min_x) min_x = v[i].x;
+    if (v[i].y < min_y) min_y = v[i].y;
+    if (v[i].x > max_x) max_x = v[i].x;
+    if (v[i].y > max_y) max_y = v[i].y;
+  }
+
+  const float width = (float)(b->tile_x_num * 32);
+  const float height = (float)(b->tile_y_num * 32);
+  if (max_x < 0.0f || max_y < 0.0f || min_x >= width || min_y >= height)
+    return false;
+
+  range->x0 = min_x <= 0.0f ? 0 : (int)(min_x * (1.0f / 32.0f));
+  range->y0 = min_y <= 0.0f ? 0 : (int)(min_y * (1.0f / 32.0f));
+  range->x1 = max_x >= width ? b->tile_x_num - 1 : (int)(max_x * (1.0f / 32.0f));
+  range->y1 = max_y >= height ? b->tile_y_num - 1 : (int)(max_y * (1.0f / 32.0f));
+  if (range->x1 > b->tile_x_num - 1) range->x1 = b->tile_x_num - 1;
+  if (range->y1 > b->tile_y_num - 1) range->y1 = b->tile_y_num - 1;
+  return true;
+}
+
+/*
+  Add the triangle whose parameter begins at `parameter_word` to `tile`; it
+  joins the tile's current triangle array entry when it immediately follows
+  that entry's last triangle.
+ */
+static inline void binner_add_triangle(binner * b, bool write, int tile, uint32_t parameter_word)
+{
+  if (b->tile_run_end[tile] == parameter_word && b->tile_run_length[tile] < BINNER__TRIANGLE_ARRAY_MAX) {
+    if (write)
+      b->object_list[b->tile_run_entry[tile]] += OBJECT_LIST__TRIANGLE_ARRAY__NUMBER_OF_TRIANGLES(1);
+    b->tile_run_end[tile] += BINNER__TRIANGLE_WORDS;
+    b->tile_run_length[tile] += 1;
+    return;
+  }
+
+  uint32_t entry = b->tile_cursor[tile]++;
+  if (write) {
+    b->object_list[entry] = OBJECT_LIST__POINTER_TYPE__TRIANGLE_ARRAY
+                          | OBJECT_LIST__TRIANGLE_ARRAY__NUMBER_OF_TRIANGLES(0)
+                          | OBJECT_LIST__TRIANGLE_ARRAY__SKIP(BINNER__SKIP)
+                          | OBJECT_LIST__TRIANGLE_ARRAY__START(b->isp_tsp_parameter_offset / 4 + parameter_word);
+  }
+  b->tile_run_entry[tile] = entry;
+  b->tile_run_end[tile] = parameter_word + BINNER__TRIANGLE_WORDS;
+  b->tile_run_length[tile] = 1;
+}
+
+static inline void binner_add_strip(binner * b, bool write, int tile, uint32_t parameter_word, uint32_t mask)
+{
+  uint32_t entry = b->tile_cursor[tile]++;
+  if (write) {
+    b->object_list[entry] = OBJECT_LIST__POINTER_TYPE__TRIANGLE_STRIP
+                          | OBJECT_LIST__TRIANGLE_STRIP__MASK(mask)
+                          | OBJECT_LIST__TRIANGLE_STRIP__SKIP(BINNER__SKIP)
+                          | OBJECT_LIST__TRIANGLE_STRIP__START(b->isp_tsp_parameter_offset / 4 + parameter_word);
+  }
+  // a strip entry ends the tile's triangle array entry
+  b->tile_run_end[tile] = UINT32_MAX;
+}
+
+static inline uint32_t binner_write_header(binner * b, uint32_t word, const binner_object * object)
+{
+  b->isp_tsp_parameter[word + 0] = object->isp_tsp_instruction_word;
+  b->isp_tsp_parameter[word + 1] = object->tsp_instruction_word;
+  b->isp_tsp_parameter[word + 2] = object->texture_control_word;
+  return word + BINNER__HEADER_WORDS;
+}
+
+static inline uint32_t binner_write_vertex(binner * b, uint32_t word, const binner_vertex * v)
+{
+  b->isp_tsp_parameter[word + 0] = binner_float_bits(v->x);
+  b->isp_tsp_parameter[word + 1] = binner_float_bits(v->y);
+  b->isp_tsp_parameter[word + 2] = binner_float_bits(v->z);
+  b->isp_tsp_parameter[word + 3] = v->color;
+  return word + BINNER__VERTEX_WORDS;
+}
+
+/*
+  One pass over every object: count (write == false) or write (write == true)
+  each tile's object list entries, and, when writing, the ISP/TSP parameters.
+  Returns the number of ISP/TSP parameter words.
+ */
+uint32_t binner_pass(binner * b, bool write, const binner_object * objects, int length)
+{
+  uint32_t parameter_word = 0;
+
+  for (int i = 0; i < length; i++) {
+    const binner_object * object = &objects[i];
+    const binner_vertex * v = object->vertex;
+
+    if (object->type == BINNER__TRIANGLES) {
+      for (int j = 0; j + 3 <= object->vertex_count; j += 3) {
+        if (write) {
+          uint32_t word = binner_write_header(b, parameter_word, object);
+          word = binner_write_vertex(b, word, &v[j + 0]);
+          word = binner_write_vertex(b, word, &v[j + 1]);
+          binner_write_vertex(b, word, &v[j + 2]);
+        }
+
+        float sign = binner_triangle_sign(&v[j + 0], &v[j + 1], &v[j + 2]);
+        binner_tile_range range;
+        if (sign != 0.0f && binner_tile_range_of(b, &v[j], 3, &range)) {
+          if (write)
+            b->triangles += 1;
+          for (int y = range.y0; y <= range.y1; y++) {
+            for (int x = range.x0; x <= range.x1; x++) {
+              if (binner_triangle_overlaps(&v[j + 0], &v[j + 1], &v[j + 2], sign, x, y))
+                binner_add_triangle(b, write, y * b->tile_x_num + x, parameter_word);
+            }
+          }
+        }
+
+        parameter_word += BINNER__TRIANGLE_WORDS;
+      }
+    } else {
+      // each strip shares its first two vertices with the end of the previous
+      // strip
+      for (int first = 0; first + 3 <= object->vertex_count; first += BINNER__STRIP_VERTICES - 2) {
+        int count = object->vertex_count - first;
+        if (count > BINNER__STRIP_VERTICES)
+          count = BINNER__STRIP_VERTICES;
+        const binner_vertex * s = &v[first];
+
+        if (write) {
+          uint32_t word = binner_write_header(b, parameter_word, object);
+          for (int k = 0; k < count; k++)
+            word = binner_write_vertex(b, word, &s[k]);
+        }
+
+        float sign[BINNER__STRIP_VERTICES - 2];
+        for (int k = 0; k < count - 2; k++) {
+          sign[k] = binner_triangle_sign(&s[k], &s[k + 1], &s[k + 2]);
+          if (write && sign[k] != 0.0f)
+            b->triangles += 1;
+        }
+
+        binner_tile_range range;
+        if (binner_tile_range_of(b, s, count, &range)) {
+          for (int y = range.y0; y <= range.y1; y++) {
+            for (int x = range.x0; x <= range.x1; x++) {
+              uint32_t mask = 0;
+              for (int k = 0; k < count - 2; k++) {
+                if (sign[k] != 0.0f && binner_triangle_overlaps(&s[k], &s[k + 1], &s[k + 2], sign[k], x, y))
+                  mask |= 1 << (5 - k);
+              }
+              if (mask != 0)
+                binner_add_strip(b, write, y * b->tile_x_num + x, parameter_word, mask);
+            }
+          }
+        }
+
+        parameter_word += BINNER__HEADER_WORDS + count * BINNER__VERTEX_WORDS;
+      }
+    }
+  }
+
+  return parameter_word;
+}
+
+static inline void binner_reset_runs(binner * b, int tile_count)
+{
+  for (int tile = 0; tile < tile_count; tile++) {
+    b->tile_run_end[tile] = UINT32_MAX;
+    b->tile_run_length[tile] = 0;
+  }
+}
+
+/*
+  Bin `length` objects into b->tile_x_num × b->tile_y_num tiles; false if the
+  tile count exceeds BINNER__TILE_MAX, or the output exceeds either buffer's
+  capacity (in which case nothing is written).
+ */
+bool binner_build(binner * b, const binner_object * objects, int length)
+{
+  const int tile_count = b->tile_x_num * b->tile_y_num;
+  if (tile_count > BINNER__TILE_MAX)
+    return false;
+
+  b->triangles = 0;
+  b->entries = 0;
+  b->tiles_covered = 0;
+
+  // first pass: count the entries of each tile
+  for (int tile = 0; tile < tile_count; tile++)
+    b->tile_cursor[tile] = 0;
+  binner_reset_runs(b, tile_count);
+  uint32_t parameter_words = binner_pass(b, false, objects, length);
+
+  // lay out the object lists; each non-empty list is ended by an end of list
+  // link
+  uint32_t offset = 0;
+  for (int tile = 0; tile < tile_count; tile++) {
+    uint32_t count = b->tile_cursor[tile];
+    b->tile_offset[tile] = offset;
+    b->tile_cursor[tile] = offset;
+    if (count != 0) {
+      b->entries += count;
+      b->tiles_covered += 1;
+      offset += count + 1;
+    }
+  }
+
+  if (parameter_words > b->isp_tsp_parameter_capacity || offset > b->object_list_capacity)
+    return false;
+  b->isp_tsp_parameter_words = parameter_words;
+  b->object_list_words = offset;
+
+  // second pass: write the entries and the ISP/TSP parameters
+  binner_reset_runs(b, tile_count);
+  binner_pass(b, true, objects, length);
+
+  for (int y = 0; y < b->tile_y_num; y++) {
+    for (int x = 0; x < b->tile_x_num; x++) {
+      const int tile = y * b->tile_x_num + x;
+      const bool empty = b->tile_cursor[tile] == b->tile_offset[tile];
+      const bool last_tile = tile == tile_count - 1;
+
+      if (!empty) {
+        b->object_list[b->tile_cursor[tile]] = OBJECT_LIST__POINTER_TYPE__OBJECT_POINTER_BLOCK_LINK
+                                             | OBJECT_LIST__OBJECT_POINTER_BLOCK_LINK__END_OF_LIST;
+      }
+
+      region_array_entry * entry = &b->region_array[tile];
+      entry->tile
+        = (last_tile ? REGION_ARRAY__TILE__LAST_REGION : 0)
+        | REGION_ARRAY__TILE__Y_POSITION(y)
+        | REGION_ARRAY__TILE__X_POSITION(x);
+
+      entry->list_pointer.opaque = empty
+                                 ? REGION_ARRAY__LIST_POINTER__EMPTY
+                                 : REGION_ARRAY__LIST_POINTER__OBJECT_LIST(b->object_list_start + b->tile_offset[tile] * 4);
+      entry->list_pointer.opaque_modifier_volume      = REGION_ARRAY__LIST_POINTER__EMPTY;
+      entry->list_pointer.translucent                 = REGION_ARRAY__LIST_POINTER__EMPTY;
+      entry->list_pointer.translucent_modifier_volume = REGION_ARRAY__LIST_POINTER__EMPTY;
+      entry->list_pointer.punch_through               = REGION_ARRAY__LIST_POINTER__EMPTY;
+    }
+  }
+
+  return true;
+}
@@ -0,0 +1,77 @@
+#pragma once
+
+#include <stdint.h>
+
+/*
+  SH4 operand cache maintenance
+
+  When the program is linked at P1 (CACHED=1, see main.lds and start.s), all
+  system memory accesses made by the CPU go through the operand cache, which is
+  copy-back. Any other bus master (Maple DMA, CH2-DMA, ...) only ever sees
+  system memory, so:
+
+  - before a DMA unit reads a buffer, the CPU's cached writes must be written
+    back (`cache_writeback`, ocbwb)
+
+  - before the CPU reads a buffer that a DMA unit wrote, any stale cache lines
+    must be discarded (`cache_invalidate`, ocbi)
+
+  - `cache_purge` (ocbp) does both.
+
+  Each instruction operates on one 32-byte cache line. All three functions
+  accept arbitrary (unaligned) ranges, and operate on every cache line that
+  overlaps [start, start + size).
+
+  Note that `cache_invalidate` discards the entire first and last cache line,
+  including bytes outside of the range. Buffers that are invalidated should be
+  32-byte aligned and a multiple of 32 bytes in size.
+
+  These instructions are harmless no-ops on addresses that are not cached
+  (e.g: P2 addresses when CACHED=0).
+
+  See sh7091pm_e.pdf printed page 72-73 and page 173.
+ */
+
+#define CACHE_LINE_SIZE 32
+
+#define ocbwb(address) \
+  { asm volatile ("ocbwb @%0" : : "r" (address) : "memory"); }
+
+#define ocbi(address) \
+  { asm volatile ("ocbi @%0" : : "r" (address) : "memory"); }
+
+#define ocbp(address) \
+  { asm volatile ("ocbp @%0" : : "r" (address) : "memory"); }
+
+static inline void cache_writeback(const void * start, uint32_t size)
+{
+  uint32_t address = (uint32_t)start & ~(CACHE_LINE_SIZE - 1);
+  uint32_t end = (uint32_t)start + size;
+
+  while (address < end) {
+    ocbwb(address);
+    address += CACHE_LINE_SIZE;
+  }
+}
+
+static inline void cache_invalidate(const void * start, uint32_t size)
+{
+  uint32_t address = (uint32_t)start & ~(CACHE_LINE_SIZE - 1);
+  uint32_t end = (uint32_t)start + size;
+
+  while (address < end) {
+    ocbi(address);
+    address += CACHE_LINE_SIZE;
+  }
+}
+
+static inline void cache_purge(const void * start, uint32_t size)
+{
+  uint32_t address = (uint32_t)start & ~(CACHE_LINE_SIZE - 1);
+  uint32_t end = (uint32_t)start + size;
+
+  while (address < end) {
+    ocbp(address);
+    address += CACHE_LINE_SIZE;
+  }
+}
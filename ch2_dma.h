@@ -0,0 +1,122 @@
+#pragma once
+
+#include <stdint.h>
+
+#include "cache.h"
+#include "holly.h"
+#include "interrupt.h"
+#include "sh7091.h"
+
+/*
+  SH4 DMAC channel 2 / Holly CH2-DMA
+
+  CH2-DMA transfers 32-byte blocks from system memory to Holly's "area 4",
+  independently of the CPU. The SH4 DMAC is the bus master that reads system
+  memory; it runs in "DDT" single address mode, with Holly requesting each
+  32-byte block. Holly forwards the blocks to the destination written to
+  SB_C2DSTAT:
+
+  - 0x10000000 : TA polygon converter FIFO
+  - 0x10800000 : YUV converter
+  - 0x11000000 : texture memory, via the "direct texture path" (SB_LMMODE0
+                 selects between the 64-bit and 32-bit address views)
+
+  ch2_dma_start only starts the transfer; the CPU is free to do unrelated work
+  until ch2_dma_wait (or until ch2_dma_busy returns false). Completion is
+  signaled by the "End of DMA CH2-DMA" bit in ISTNRM.
+
+  Requirements:
+
+  - the source must be 32-byte aligned, and the size a multiple of 32 bytes
+  - the source must not be modified until the transfer completes
+  - only one transfer may be in progress at a time
+
+  ch2_dma_start writes back the source buffer from the operand cache, so it
+  may be used for cached (P1) buffers as well as __uncached buffers.
+
+  See DCDBSysArc990907E.pdf page 64-66 and sh7091pm_e.pdf printed page 457.
+ */
+
+#define CH2_DMA__TA_POLYGON_CONVERTER_FIFO 0x10000000
+#define CH2_DMA__YUV_CONVERTER             0x10800000
+#define CH2_DMA__TEXTURE_MEMORY            0x11000000
+
+void ch2_dma_start(uint32_t destination, const void * src, uint32_t size)
+{
+  cache_writeback(src, size);
+
+  // stop channel 2, and clear any previous transfer end (TE) status
+  *SH7091__DMAC__CHCR2 = 0;
+
+  // the SH4 DMAC uses physical addresses
+  *SH7091__DMAC__SAR2 = (uint32_t)src & 0x1fffffff;
+  *SH7091__DMAC__DMATCR2 = size / 32;
+  *SH7091__DMAC__CHCR2 = SH7091__DMAC__CHCR__DM__FIXED
+                       | SH7091__DMAC__CHCR__SM__INCREMENTED
+                       | SH7091__DMAC__CHCR__RS__EXTERNAL_SINGLE_ADDRESS
+                       | SH7091__DMAC__CHCR__TM__BURST
+                       | SH7091__DMAC__CHCR__TS__32_BYTE
+                       | SH7091__DMAC__CHCR__DE;
+
+  // DDT mode is also required by Maple DMA (channel 0); the boot rom leaves
+  // DMAOR in this state, but make sure that the DMAC is enabled and that no
+  // address error/NMI flag is halting all channels.
+  *SH7091__DMAC__DMAOR = SH7091__DMAC__DMAOR__DDT
+                       | SH7091__DMAC__DMAOR__PR__ROUND_ROBIN
+                       | SH7091__DMAC__DMAOR__DME;
+
+  // clear CH2-DMA end status
+  interrupt_clear(ISTNRM__END_OF_DMA_CH2_DMA);
+
+  *SB_C2DSTAT = destination;
+  *SB_C2DLEN = size;
+  *SB_C2DST = 1;
+}
+
+static inline bool ch2_dma_busy()
+{
+  return interrupt_status(ISTNRM__END_OF_DMA_CH2_DMA) == 0;
+}
+
+void ch2_dma_wait()
+{
+  interrupt_wait(ISTNRM__END_OF_DMA_CH2_DMA);
+}
+
+/*
+  transfer TA parameters (global, vertex, end of list, ...) to the TA polygon
+  converter FIFO
+ */
+void ch2_dma_ta_fifo(const void * src, uint32_t size)
+{
+  ch2_dma_start(CH2_DMA__TA_POLYGON_CONVERTER_FIFO, src, size);
+}
+
+/*
+  transfer YUV420/YUV422 macroblocks to the YUV converter (TA_YUV_TEX_* must
+  already be configured)
+ */
+void ch2_dma_yuv(const void * src, uint32_t size)
+{
+  ch2_dma_start(CH2_DMA__YUV_CONVERTER, src, size);
+}
+
+/*
+  transfer to texture memory, at `offset` in the "64-bit" address view
+  (textures)
+ */
+void ch2_dma_texture64(uint32_t offset, const void * src, uint32_t size)
+{
+  *SB_LMMODE0 = SB_LMMODE__64BIT;
+  ch2_dma_start(CH2_DMA__TEXTURE_MEMORY + offset, src, size);
+}
+
+/*
+  transfer to texture memory, at `offset` in the "32-bit" address view
+  (framebuffers, region arrays, ...)
+ */
+void ch2_dma_texture32(uint32_t offset, const void * src, uint32_t size)
+{
+  *SB_LMMODE0 = SB_LMMODE__32BIT;
+  ch2_dma_start(CH2_DMA__TEXTURE_MEMORY + offset, src, size);
+}
@@ -0,0 +1,261 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "color.h"
+#include "matrix.h"
+#include "mesh.h"
+#include "vec.h"
+
+/*
+  Near plane clipping
+
+  mesh_transform/mesh_transform_xmtrx only divide positions on or in front of
+  the near plane; positions behind it are stored undivided, with a negative z
+  (see mesh.h). clip_near rewrites a set of strips so that every triangle
+  references only divided vertices:
+
+  - triangles entirely in front of the near plane are copied unchanged, and
+    stay in strips; a strip is only split where a triangle is clipped or
+    removed
+
+  - triangles entirely behind the near plane are removed
+
+  - triangles that cross the near plane are clipped in homogeneous space, to
+    a triangle or a quadrilateral, which is written as a separate 3- or
+    4-vertex strip
+
+  Each vertex created by clipping is appended to `screen`, after the
+  transformed vertices, and is described by a clip_vertex, so that the caller
+  can interpolate any other vertex attribute (clip_float, clip_vec2,
+  clip_color, clip_argb). Interpolating an attribute by `t` in homogeneous space is
+  perspective-correct.
+
+  As in cull_back_faces, a strip that restarts at an odd triangle begins with
+  its first vertex repeated, so that the TA's strip winding is unchanged.
+
+  There is no clipping against the other frustum planes. The TA accepts
+  vertices anywhere in the 32-bit float range, and bins each polygon only to
+  the tiles it overlaps (within TA_GLOB_TILE_CLIP), so everything outside the
+  screen is the TA's "guard band". With MESH__NEAR_Z as the smallest W,
+  screen-space coordinates are at most 1 / MESH__NEAR_Z times the homogeneous
+  coordinates, which is far from the float range.
+
+  clip_near is only needed when the transform reports vertices behind the
+  near plane; when none are, the caller skips it entirely.
+ */
+
+typedef struct clip_vertex {
+  // the vertex is at `t` along the edge from vertex `a` (in front of the near
+  // plane) to vertex `b` (behind the near plane)
+  uint16_t a;
+  uint16_t b;
+  float t;
+} clip_vertex;
+
+typedef struct clip_counters {
+  // triangles that crossed the near plane, and triangles entirely behind it
+  uint32_t triangles_clipped;
+  uint32_t triangles_behind;
+} clip_counters;
+
+clip_counters clip_state;
+
+static inline bool clip_is_behind(vec3 v)
+{
+  return v.z < 0.0f;
+}
+
+static inline float clip_float(const float * attribute, const clip_vertex * v)
+{
+  float a = attribute[v->a];
+  float b = attribute[v->b];
+  return a + (b - a) * v->t;
+}
+
+static inline vec2 clip_vec2(const vec2 * attribute, const clip_vertex * v)
+{
+  vec2 a = attribute[v->a];
+  vec2 b = attribute[v->b];
+  return (vec2){a.u + (b.u - a.u) * v->t, a.v + (b.v - a.v) * v->t};
+}
+
+// packed 8-bit channels (for example ARGB8888) are interpolated separately
+static inline uint32_t clip_color(const uint32_t * attribute, const clip_vertex * v)
+{
+  uint32_t a = attribute[v->a];
+  uint32_t b = attribute[v->b];
+  uint32_t color = 0;
+  for (int shift = 0; shift < 32; shift += 8) {
+    float ca = (float)((a >> shift) & 0xff);
+    float cb = (float)((b >> shift) & 0xff);
+    color |= (uint32_t)(ca + (cb - ca) * v->t) << shift;
+  }
+  return color;
+}
+
+static inline color_argb clip_argb(const color_argb * attribute, const clip_vertex * v)
+{
+  color_argb a = attribute[v->a];
+  color_argb b = attribute[v->b];
+  float t = v->t;
+  return (color_argb){
+    a.a + (b.a - a.a) * t,
+    a.r + (b.r - a.r) * t,
+    a.g + (b.g - a.g) * t,
+    a.b + (b.b - a.b) * t,
+  };
+}
+
+/*
+  Append the intersection of the edge from `a` (in front) to `b` (behind) with
+  the near plane to `screen`; returns its index.
+ */
+static inline uint16_t clip_edge(vec3 * screen, int vertex_count,
+                                 clip_vertex * generated, int * generated_count,
+                                 uint16_t a, uint16_t b)
+{
+  // (X, Y, W) of both vertices; see mesh.h
+  vec3 sa = screen[a];
+  vec3 sb = screen[b];
+  float wa = frcp_positive(sa.z);
+  float xa = sa.x * wa;
+  float ya = sa.y * wa;
+  float wb = sb.z + MESH__NEAR_Z;
+
+  // wa ≥ MESH__NEAR_Z > wb
+  float t = (wa - MESH__NEAR_Z) * frcp_positive(wa - wb);
+  float x = xa + (sb.x - xa) * t;
+  float y = ya + (sb.y - ya) * t;
+
+  // W is MESH__NEAR_Z at the intersection
+  const float rhw = 1.0f / MESH__NEAR_Z;
+
+  int index = vertex_count + *generated_count;
+  screen[index] = (vec3){x * rhw, y * rhw, rhw};
+  generated[*generated_count] = (clip_vertex){a, b, t};
+  *generated_count += 1;
+
+  return index;
+}
+
+/*
+  Clip triangle (p, q, r), wound in its true (not strip) order, to the near
+  plane; writes the result as a strip to `out`, and returns its length.
+ */
+static inline int clip_triangle(vec3 * screen, int vertex_count,
+                                clip_vertex * generated, int * generated_count,
+                                uint16_t p, uint16_t q, uint16_t r,
+                                uint16_t * out)
+{
+  const uint16_t v[3] = {p, q, r};
+  uint16_t polygon[4];
+  int length = 0;
+
+  for (int i = 0; i < 3; i++) {
+    uint16_t a = v[i];
+    uint16_t b = v[i == 2 ? 0 : i + 1];
+    bool a_behind = clip_is_behind(screen[a]);
+    bool b_behind = clip_is_behind(screen[b]);
+
+    if (!a_behind)
+      polygon[length++] = a;
+    if (a_behind != b_behind) {
+      polygon[length++] = a_behind
+        ? clip_edge(screen, vertex_count, generated, generated_count, b, a)
+        : clip_edge(screen, vertex_count, generated, generated_count, a, b);
+    }
+  }
+
+  if (length == 3) {
+    out[0] = polygon[0];
+    out[1] = polygon[1];
+    out[2] = polygon[2];
+  } else {
+    // (p1, p2, p0) has the winding of the polygon, and so does the second,
+    // odd, triangle (p2, p0, p3)
+    out[0] = polygon[1];
+    out[1] = polygon[2];
+    out[2] = polygon[0];
+    out[3] = polygon[3];
+  }
+  return length;
+}
+
+/*
+  Write the strips (`strip`, `strip_length`, as in mesh_format.h) of the
+  `vertex_count` transformed vertices in `screen`, clipped to the near plane,
+  to `out_strip` and `out_strip_length`.
+
+  `screen` and `generated` must have room for 2 additional vertices per
+  triangle that crosses the near plane; `*generated_count` receives the number
+  of vertices appended to `screen`. `out_strip` must have room for 4 indices
+  per input triangle, and `out_strip_length` for 1 entry per input triangle.
+
+  Returns the number of output strips.
+ */
+int clip_near(vec3 * screen, int vertex_count,
+              clip_vertex * generated, int * generated_count,
+              const uint16_t * strip, const uint16_t * strip_length, int strip_count,
+              uint16_t * out_strip, uint16_t * out_strip_length)
+{
+  int out_count = 0;
+  uint16_t * out = out_strip;
+  *generated_count = 0;
+
+  for (int strip_ix = 0; strip_ix < strip_count; strip_ix++) {
+    int length = strip_length[strip_ix];
+    // the length of the unclipped strip currently being written; 0 if none
+    int run = 0;
+
+    for (int t = 0; t < length - 2; t++) {
+      bool odd = (t & 1) != 0;
+      uint16_t p = strip[t];
+      uint16_t q = strip[t + 1];
+      uint16_t r = strip[t + 2];
+
+      int behind = clip_is_behind(screen[p])
+                 + clip_is_behind(screen[q])
+                 + clip_is_behind(screen[r]);
+
+      if (behind == 0) {
+        if (run == 0) {
+          if (odd)
+            out[run++] = p;
+          out[run++] = p;
+          out[run++] = q;
+        }
+        out[run++] = r;
+        continue;
+      }
+
+      if (run != 0) {
+        out_strip_length[out_count++] = run;
+        out += run;
+        run = 0;
+      }
+
+      if (behind == 3) {
+        clip_state.triangles_behind += 1;
+        continue;
+      }
+
+      clip_state.triangles_clipped += 1;
+      int clipped = odd
+        ? clip_triangle(screen, vertex_count, generated, generated_count, q, p, r, out)
+        : clip_triangle(screen, vertex_count, generated, generated_count, p, q, r, out);
+      out_strip_length[out_count++] = clipped;
+      out += clipped;
+    }
+
+    if (run != 0) {
+      out_strip_length[out_count++] = run;
+      out += run;
+    }
+
+    strip += length;
+  }
+
+  return out_count;
+}
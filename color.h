@@ -0,0 +1,72 @@
+#pragma once
+
+#include <stdint.h>
+
+/*
+  Floating point vertex color
+
+  Lighting produces a floating point color (or intensity) per vertex. The TA
+  accepts these directly (see ta_parameter.h):
+
+  - floating color: vertex parameter polygon_type_1 (untextured) or
+    polygon_type_5 (textured; with a floating point offset color), with
+    COL_TYPE__FLOATING_COLOR
+
+  - intensity: vertex parameter polygon_type_2 (untextured) or polygon_type_7
+    (textured; with an offset intensity), with COL_TYPE__INTENSITY_MODE_1; each
+    intensity scales the face color of the global parameter (polygon_type_1,
+    or polygon_type_2 with an offset color)
+
+  and clamps and packs each component to 8 bits as it writes the ISP/TSP
+  parameters, at no cost to the CPU. color_pack is the equivalent CPU
+  conversion, for packed color vertex parameters; color_bench.c measures
+  both.
+
+  Components are in [0, 1]; lighting may produce values greater than 1, which
+  saturate.
+ */
+
+typedef struct color_argb {
+  float a;
+  float r;
+  float g;
+  float b;
+} color_argb;
+
+static inline color_argb color_argb_unpack(uint32_t color)
+{
+  const float s = 1.0f / 255.0f;
+  return (color_argb){
+    (float)((color >> 24) & 0xff) * s,
+    (float)((color >> 16) & 0xff) * s,
+    (float)((color >>  8) & 0xff) * s,
+    (float)((color >>  0) & 0xff) * s,
+  };
+}
+
+// `color` with each of r, g and b multiplied by `intensity`
+static inline color_argb color_argb_scale(color_argb color, float intensity)
+{
+  return (color_argb){color.a, color.r * intensity, color.g * intensity, color.b * intensity};
+}
+
+static inline uint32_t color_component(float c)
+{
+  if (c <= 0.0f)
+    return 0;
+  if (c >= 1.0f)
+    return 255;
+  return (uint32_t)(c * 255.0f);
+}
+
+/*
+  Clamp and pack `color` to 32-bit ARGB8888 on the CPU, as the TA does for
+  floating color vertex parameters.
+ */
+static inline uint32_t color_pack(color_argb color)
+{
+  return (color_component(color.a) << 24)
+       | (color_component(color.r) << 16)
+       | (color_component(color.g) << 8)
+       | (color_component(color.b) << 0);
+}
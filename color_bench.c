@@ -0,0 +1,151 @@
+#include <stdint.h>
+
+#include "color.h"
+#include "scif.h"
+#include "sq.h"
+#include "ta_parameter.h"
+#include "tmu.h"
+#include "vec.h"
+
+/*
+  Vertex color benchmark: packing lit colors on the CPU vs letting the TA pack
+  them
+
+  Each vertex has a floating point lit color (or intensity), as produced by
+  per-vertex lighting. The same vertices are written as:
+
+  - packed color vertex parameters (polygon_type_0), with each color clamped
+    and packed by the CPU (color_pack, see color.h)
+
+  - floating color vertex parameters (polygon_type_1); the TA clamps and packs
+
+  - intensity vertex parameters (polygon_type_2); the TA scales the face color
+    by each intensity, then clamps and packs
+
+  All three are 32-byte parameters, so the store queue and TA FIFO bandwidth
+  is the same: the difference is CPU time only.
+
+  The TA is not initialized: parameters are written to the store queues, and
+  transferred (`pref`, see ta_stream.h) to a system memory buffer instead of
+  the TA polygon converter FIFO.
+
+  This benchmark is intended to be built with CACHED=1:
+
+    CACHED=1 ./build.sh color_bench
+
+  The results are printed over the SCIF.
+ */
+
+#define VERTEX_COUNT 256
+#define ITERATIONS 100
+
+vec3 vertex_position[VERTEX_COUNT] __attribute__((aligned(32)));
+color_argb vertex_color[VERTEX_COUNT] __attribute__((aligned(32)));
+float vertex_intensity[VERTEX_COUNT] __attribute__((aligned(32)));
+
+// the store queue destination; 32 bytes per vertex parameter
+uint8_t destination[VERTEX_COUNT * 32] __attribute__((aligned(32)));
+
+void initialize_vertices()
+{
+  // arbitrary, deterministic lighting results; some components exceed 1 and
+  // saturate
+  for (int i = 0; i < VERTEX_COUNT; i++) {
+    float intensity = (float)((i * 7) % 19) / 12.0f;
+    vertex_position[i] = (vec3){(float)(i % 16) * 40.0f, (float)(i / 16) * 30.0f, 0.5f};
+    vertex_color[i] = (color_argb){1.0f, intensity, intensity * 0.5f, 1.0f - intensity * 0.25f};
+    vertex_intensity[i] = intensity;
+  }
+}
+
+uint32_t benchmark_packed()
+{
+  uint32_t start = tmu_ticks();
+  for (int j = 0; j < ITERATIONS; j++) {
+    uint32_t store_queue_ix = sq_address((uint32_t)destination);
+    for (int i = 0; i < VERTEX_COUNT; i++) {
+      vec3 v = vertex_position[i];
+      store_queue_ix = transfer_ta_vertex_parameter__polygon_type_0(store_queue_ix,
+                                                                    ta_vertex_parameter_control_word((i & 7) == 7),
+                                                                    v.x, v.y, v.z,
+                                                                    color_pack(vertex_color[i]));
+    }
+  }
+  sq_wait();
+  return tmu_ticks() - start;
+}
+
+uint32_t benchmark_floating()
+{
+  uint32_t start = tmu_ticks();
+  for (int j = 0; j < ITERATIONS; j++) {
+    uint32_t store_queue_ix = sq_address((uint32_t)destination);
+    for (int i = 0; i < VERTEX_COUNT; i++) {
+      vec3 v = vertex_position[i];
+      color_argb c = vertex_color[i];
+      store_queue_ix = transfer_ta_vertex_parameter__polygon_type_1(store_queue_ix,
+                                                                    ta_vertex_parameter_control_word((i & 7) == 7),
+                                                                    v.x, v.y, v.z,
+                                                                    c.a, c.r, c.g, c.b);
+    }
+  }
+  sq_wait();
+  return tmu_ticks() - start;
+}
+
+uint32_t benchmark_intensity()
+{
+  uint32_t start = tmu_ticks();
+  for (int j = 0; j < ITERATIONS; j++) {
+    uint32_t store_queue_ix = sq_address((uint32_t)destination);
+    for (int i = 0; i < VERTEX_COUNT; i++) {
+      vec3 v = vertex_position[i];
+      store_queue_ix = transfer_ta_vertex_parameter__polygon_type_2(store_queue_ix,
+                                                                    ta_vertex_parameter_control_word((i & 7) == 7),
+                                                                    v.x, v.y, v.z,
+                                                                    vertex_intensity[i]);
+    }
+  }
+  sq_wait();
+  return tmu_ticks() - start;
+}
+
+float cycles_per_vertex(uint32_t ticks)
+{
+  return tmu_ticks_to_cycles(ticks) * (1.0f / (VERTEX_COUNT * ITERATIONS));
+}
+
+void report(const char * name, uint32_t ticks, uint32_t packed_ticks)
+{
+  float cycles = cycles_per_vertex(ticks);
+  float saved = cycles_per_vertex(packed_ticks) - cycles;
+
+  scif_string(name);
+  scif_character('\n');
+  scif_label_base10("  total time (us)", tmu_ticks_to_us(ticks));
+  scif_label_base10("  CPU cycles per vertex", (uint32_t)cycles);
+  scif_label_base10("  CPU cycles saved per vertex", saved > 0.0f ? (uint32_t)saved : 0);
+}
+
+void main()
+{
+  scif_init();
+  tmu_init();
+
+  initialize_vertices();
+
+  // ta_flush issues `pref` on each completed block
+  ta_stream_state.mode = TA_STREAM__STORE_QUEUE;
+  sq_set_destination((uint32_t)destination);
+
+  uint32_t packed_ticks = benchmark_packed();
+  uint32_t floating_ticks = benchmark_floating();
+  uint32_t intensity_ticks = benchmark_intensity();
+
+  scif_label_base10("cached", CACHED);
+  scif_label_base10("vertices", VERTEX_COUNT * ITERATIONS);
+  report("packed color (CPU color_pack)", packed_ticks, packed_ticks);
+  report("floating color (TA packs)", floating_ticks, packed_ticks);
+  report("intensity (TA packs)", intensity_ticks, packed_ticks);
+  scif_flush();
+}
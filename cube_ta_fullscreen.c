@@ -1,5 +1,22 @@
 #include <stdint.h>
 
+#include "clip.h"
+#include "color.h"
+#include "cull.h"
+#include "display.h"
+#include "holly.h"
+#include "interrupt.h"
+#include "light.h"
+#include "mesh.h"
+#include "region_array.h"
+#include "scif.h"
+#include "sections.h"
+#include "strip.h"
+#include "ta_alloc.h"
+#include "ta_parameter.h"
+#include "ta_stream.h"
+#include "tmu.h"
+
 /*
   This demo does not work in emulators:
 
@@ -28,110 +45,25 @@
  */
 const uint32_t texture_memory32 = 0xa5000000;
 
-/* The "TA Polygon Converter FIFO" is a Holly functional unit. */
-const uint32_t ta_polygon_converter_fifo = 0x10000000;
-
-/* The "Store Queue" is a SH4 functional unit. */
-const uint32_t store_queue = 0xe0000000;
-
 /******************************************************************************
  Region array
  ******************************************************************************/
 
 /*
-  These "region array entries" are briefly illustrated in DCDBSysArc990907E.pdf
-  page 168, 177-180.
-
-  The number of list pointers per region array entry is affected by
-  FPU_PARAM_CFG "Region Header Type" (page 368). This struct models the
-  "6 × 32bit/Tile Type 2" mode.
-*/
-typedef struct region_array_entry {
-  uint32_t tile;
-  struct {
-    uint32_t opaque;
-    uint32_t opaque_modifier_volume;
-    uint32_t translucent;
-    uint32_t translucent_modifier_volume;
-    uint32_t punch_through;
-  } list_pointer;
-} region_array_entry;
-static_assert((sizeof (struct region_array_entry)) == 4 * 6);
-
-/*
-  DCDBSysArc990907E.pdf page 216-217 describes the REGION_ARRAY__ bit fields:
+  The region array (one entry per tile, see region_array.h) and the object
+  pointer blocks of each list type (see ta_alloc.h) are both laid out from a
+  single ta_alloc, in main.
+
+  On odd frames, the translucent list pointer of every tile that the overlay
+  does not touch is set to EMPTY (region_array_update_empty); on even frames,
+  every tile points at its translucent object list. The render time of each
+  is reported.
  */
-#define REGION_ARRAY__TILE__LAST_REGION (1 << 31)
-#define REGION_ARRAY__TILE__Y_POSITION(n) (((n) & 0x3f) << 8)
-#define REGION_ARRAY__TILE__X_POSITION(n) (((n) & 0x3f) << 2)
-
-#define REGION_ARRAY__LIST_POINTER__EMPTY (1 << 31)
-#define REGION_ARRAY__LIST_POINTER__OBJECT_LIST(n) (((n) & 0xfffffc) << 0)
-
-void transfer_region_array(uint32_t region_array_start,
-                           uint32_t opaque_list_pointer)
-{
-  /*
-    Create a minimal region array with a single entry:
-       - one tile at tile coordinate (0, 0) with one opaque list pointer
-  */
-
-  /*
-    Holly reads the region array from "32-bit" texture memory address space,
-    so the region array is correspondingly written from "32-bit" address space.
-   */
-  volatile region_array_entry * region_array = (volatile region_array_entry *)(texture_memory32 + region_array_start);
-
-  const int num_tiles_x = 640 / 32;
-  const int num_tiles_y = 480 / 32;
-  const int num_tiles = num_tiles_x * num_tiles_y;
 
-  for (int i = 0; i < num_tiles; i++) {
-    /* define one region array entry per 32×32 px tile over a 640x480 px area */
-
-    int x = i % num_tiles_x;
-    int y = i / num_tiles_x;
-
-    bool last_tile = (i == (num_tiles - 1));
-
-    region_array[i].tile
-      = (last_tile ? REGION_ARRAY__TILE__LAST_REGION : 0)
-      | REGION_ARRAY__TILE__Y_POSITION(y)
-      | REGION_ARRAY__TILE__X_POSITION(x);
-
-    /*
-      list pointers are offsets relative to the beginning of "32-bit" texture memory.
-
-      Each list type uses different rasterization steps, "opaque" being the fastest and most efficient.
-    */
-
-    /*
-      In all previous demos, a single `opaque_list_pointer` was used for all
-      tiles. This was correct in the cases where:
-
-      - we were generating our own object lists
-      - we were using the TA with a single tile
-
-      However, this is no longer correct for this example, where we are both
-      using the TA and multiple tiles simultaneously. In this case, the TA's
-      "object pointer block" allocation strategy needs to implemented here.
-
-      See DCDBSysArc990907E.pdf page 178,179 and 186 for a relatively weak
-      explanation of the TA's OPB allocation behavior.
-     */
-
-
-    // This example is using TA_ALLOC_CTRL__O_OPB__8X4BYTE, so each OPB is 8×4
-    // bytes. They are (un)coincidentally stored in the same order that the
-    // tile x position and tile y position coordinates are calculated above.
-    int opb_pointer = opaque_list_pointer + i * 8 * 4;
-    region_array[i].list_pointer.opaque                      = REGION_ARRAY__LIST_POINTER__OBJECT_LIST(opb_pointer);
-    region_array[i].list_pointer.opaque_modifier_volume      = REGION_ARRAY__LIST_POINTER__EMPTY;
-    region_array[i].list_pointer.translucent                 = REGION_ARRAY__LIST_POINTER__EMPTY;
-    region_array[i].list_pointer.translucent_modifier_volume = REGION_ARRAY__LIST_POINTER__EMPTY;
-    region_array[i].list_pointer.punch_through               = REGION_ARRAY__LIST_POINTER__EMPTY;
-  }
-}
+// tiles without translucent objects in this frame, and tiles whose translucent
+// list pointer is EMPTY in the region array
+uint32_t translucent_empty_tiles[REGION_ARRAY__TILE_SET_WORDS];
+uint32_t translucent_empty_current[REGION_ARRAY__TILE_SET_WORDS];
 
 /******************************************************************************
  ISP/TSP Parameter
@@ -171,9 +103,11 @@ typedef struct isp_tsp_parameter__polygon {
  */
 #define ISP_TSP_INSTRUCTION_WORD__DEPTH_COMPARE_MODE__ALWAYS (7 << 29)
 #define ISP_TSP_INSTRUCTION_WORD__DEPTH_COMPARE_MODE__GREATER (4 << 29)
+#define ISP_TSP_INSTRUCTION_WORD__DEPTH_COMPARE_MODE__GREATER_OR_EQUAL (6 << 29)
 
 #define ISP_TSP_INSTRUCTION_WORD__CULLING_MODE__NO_CULLING (0 << 27)
 
+#define ISP_TSP_INSTRUCTION_WORD__Z_WRITE_DISABLE (1 << 26)
 #define ISP_TSP_INSTRUCTION_WORD__GOURAUD_SHADING (1 << 23)
 
 /*
@@ -182,8 +116,11 @@ typedef struct isp_tsp_parameter__polygon {
   DCDBSysArc990907E.pdf page 226-232
  */
 #define TSP_INSTRUCTION_WORD__SRC_ALPHA_INSTR__ONE (1 << 29)
+#define TSP_INSTRUCTION_WORD__SRC_ALPHA_INSTR__SRC_ALPHA (4 << 29)
 #define TSP_INSTRUCTION_WORD__DST_ALPHA_INSTR__ZERO (0 << 26)
+#define TSP_INSTRUCTION_WORD__DST_ALPHA_INSTR__INVERSE_SRC_ALPHA (5 << 26)
 #define TSP_INSTRUCTION_WORD__FOG_CONTROL__NO_FOG (0b10 << 22)
+#define TSP_INSTRUCTION_WORD__USE_ALPHA (1 << 20)
 
 void transfer_isp_tsp_background_parameter(uint32_t isp_tsp_parameter_start)
 {
@@ -246,22 +183,14 @@ void transfer_isp_tsp_background_parameter(uint32_t isp_tsp_parameter_start)
 
   - meticulous and clever use of SH4 cache writeback (esoteric forbidden technique)
 
-  Of these, the mechanism that requires the least code is the SH4 store queue,
-  so this demo will also use the SH4 store queue for that reason.
+  This demo can use either the SH4 store queue, or Holly CH2-DMA from a
+  system memory buffer; see ta_stream.h. Each `ta_flush` call below is a `pref`
+  in store queue mode.
 
   The SH4 store queue is described in sh7091pm_e.pdf printed page 61-64 and
   79-81.
 */
 
-// sh7091pm_e.pdf:
-//  > Issuing a PREF instruction for P4 area H'E000 0000 to H'E3FF FFFC starts a
-//  > burst transfer from the SQs to external memory.
-#define pref(address) \
-  { asm volatile ("pref @%0" : : "r" (address) : "memory"); }
-
-volatile uint32_t * SH7091__CCN__QACR0 = (volatile uint32_t *)(0xff000000 + 0x38);
-volatile uint32_t * SH7091__CCN__QACR1 = (volatile uint32_t *)(0xff000000 + 0x3c);
-
 /******************************************************************************
  TA Parameters
  ******************************************************************************/
@@ -277,7 +206,9 @@ volatile uint32_t * SH7091__CCN__QACR1 = (volatile uint32_t *)(0xff000000 + 0x3c
   TA can do the same conversion much more quickly (~1 clock cycle).
 
   Floating point color is typical when performing (colored) lighting/shading
-  calculations.
+  calculations. This demo lights each vertex in floating point (see light.h),
+  and submits the result as floating color vertex parameters (see color.h);
+  color_bench.c measures the CPU time this saves per vertex.
  */
 
 /*
@@ -292,30 +223,6 @@ volatile uint32_t * SH7091__CCN__QACR1 = (volatile uint32_t *)(0xff000000 + 0x3c
     exclusively supports 32-bit packed integer ARGB color.
  */
 
-typedef struct ta_global_parameter__polygon_type_0 {
-  uint32_t parameter_control_word;
-  uint32_t isp_tsp_instruction_word;
-  uint32_t tsp_instruction_word;
-  uint32_t texture_control_word;
-  uint32_t _res0;
-  uint32_t _res1;
-  uint32_t data_size_for_sort_dma;
-  uint32_t next_address_for_sort_dma;
-} ta_global_parameter__polygon_type_0;
-static_assert((sizeof (struct ta_global_parameter__polygon_type_0)) == 32);
-
-typedef struct ta_global_parameter__end_of_list {
-  uint32_t parameter_control_word;
-  uint32_t _res0;
-  uint32_t _res1;
-  uint32_t _res2;
-  uint32_t _res3;
-  uint32_t _res4;
-  uint32_t _res5;
-  uint32_t _res6;
-} ta_global_parameter__end_of_list;
-static_assert((sizeof (struct ta_global_parameter__end_of_list)) == 32);
-
 /*
   The TA only supports polygon/triangle vertex input represented as a triangle
   strip. TA triangle strips can be any length between 1 and infinity (or the end
@@ -325,124 +232,91 @@ static_assert((sizeof (struct ta_global_parameter__end_of_list)) == 32);
 
   See DCDBSysArc990907E.pdf page 181.
  */
-typedef struct ta_vertex_parameter__polygon_type_0 {
-  uint32_t parameter_control_word;
-  float x;
-  float y;
-  float z;
-  uint32_t _res0;
-  uint32_t _res1;
-  uint32_t base_color;
-  uint32_t _res2;
-} ta_vertex_parameter__polygon_type_0;
-static_assert((sizeof (struct ta_vertex_parameter__polygon_type_0)) == 32);
-
-#define PARAMETER_CONTROL_WORD__PARA_CONTROL__PARA_TYPE__END_OF_LIST (0 << 29)
-#define PARAMETER_CONTROL_WORD__PARA_CONTROL__PARA_TYPE__POLYGON_OR_MODIFIER_VOLUME (4 << 29)
-#define PARAMETER_CONTROL_WORD__PARA_CONTROL__PARA_TYPE__VERTEX_PARAMETER (7 << 29)
-#define PARAMETER_CONTROL_WORD__PARA_CONTROL__END_OF_STRIP (1 << 28)
-#define PARAMETER_CONTROL_WORD__PARA_CONTROL__LIST_TYPE__OPAQUE (0 << 24)
-#define PARAMETER_CONTROL_WORD__OBJ_CONTROL__COL_TYPE__PACKED_COLOR (0 << 4)
-#define PARAMETER_CONTROL_WORD__OBJ_CONTROL__GOURAUD (1 << 1)
-
-static inline uint32_t transfer_ta_global_end_of_list(uint32_t store_queue_ix)
+static inline uint32_t transfer_ta_vertex(uint32_t store_queue_ix,
+                                          float x, float y, float z, color_argb color,
+                                          bool end_of_strip)
 {
-  //
-  // TA "end of list" global transfer
-  //
-
-  volatile ta_global_parameter__end_of_list * end_of_list = (volatile ta_global_parameter__end_of_list *)store_queue_ix;
-
-  end_of_list->parameter_control_word = PARAMETER_CONTROL_WORD__PARA_CONTROL__PARA_TYPE__END_OF_LIST;
-
-  // start store queue transfer of `end_of_list` to the TA
-  pref(store_queue_ix);
-
-  store_queue_ix += (sizeof (ta_global_parameter__end_of_list));
-
-  return store_queue_ix;
-}
-
-static inline uint32_t transfer_ta_vertex_triangle(uint32_t store_queue_ix,
-                                                   float ax, float ay, float az, uint32_t ac,
-                                                   float bx, float by, float bz, uint32_t bc,
-                                                   float cx, float cy, float cz, uint32_t cc)
-{
-  //
-  // TA polygon vertex transfer
-  //
-
-  volatile ta_vertex_parameter__polygon_type_0 * vertex = (volatile ta_vertex_parameter__polygon_type_0 *)store_queue_ix;
-
-  // bottom left
-  vertex[0].parameter_control_word = PARAMETER_CONTROL_WORD__PARA_CONTROL__PARA_TYPE__VERTEX_PARAMETER;
-  vertex[0].x = ax;
-  vertex[0].y = ay;
-  vertex[0].z = az;
-  vertex[0].base_color = ac;
-
-  // start store queue transfer of `vertex[0]` to the TA
-  pref(store_queue_ix + 32 * 0);
-
-  // top center
-  vertex[1].parameter_control_word = PARAMETER_CONTROL_WORD__PARA_CONTROL__PARA_TYPE__VERTEX_PARAMETER;
-  vertex[1].x = bx;
-  vertex[1].y = by;
-  vertex[1].z = bz;
-  vertex[1].base_color = bc;
-
-  // start store queue transfer of `vertex[1]` to the TA
-  pref(store_queue_ix + 32 * 1);
-
-  // bottom right
-  vertex[2].parameter_control_word = PARAMETER_CONTROL_WORD__PARA_CONTROL__PARA_TYPE__VERTEX_PARAMETER
-                                   | PARAMETER_CONTROL_WORD__PARA_CONTROL__END_OF_STRIP;
-  vertex[2].x = cx;
-  vertex[2].y = cy;
-  vertex[2].z = cz;
-  vertex[2].base_color = cc;
-
-  // start store queue transfer of `params[2]` to the TA
-  pref(store_queue_ix + 32 * 2);
-
-  store_queue_ix += (sizeof (ta_vertex_parameter__polygon_type_0)) * 3;
-
-  return store_queue_ix;
+  return transfer_ta_vertex_parameter__polygon_type_1(store_queue_ix,
+                                                      ta_vertex_parameter_control_word(end_of_strip),
+                                                      x, y, z,
+                                                      color.a, color.r, color.g, color.b);
 }
 
 static inline uint32_t transfer_ta_global_polygon(uint32_t store_queue_ix)
 {
-  //
-  // TA polygon global transfer
-  //
-
-  volatile ta_global_parameter__polygon_type_0 * polygon = (volatile ta_global_parameter__polygon_type_0 *)store_queue_ix;
-
-  polygon->parameter_control_word = PARAMETER_CONTROL_WORD__PARA_CONTROL__PARA_TYPE__POLYGON_OR_MODIFIER_VOLUME
-                                  | PARAMETER_CONTROL_WORD__PARA_CONTROL__LIST_TYPE__OPAQUE
-                                  | PARAMETER_CONTROL_WORD__OBJ_CONTROL__COL_TYPE__PACKED_COLOR
-                                  | PARAMETER_CONTROL_WORD__OBJ_CONTROL__GOURAUD;
+  const uint32_t parameter_control_word = PARAMETER_CONTROL_WORD__PARA_CONTROL__PARA_TYPE__POLYGON_OR_MODIFIER_VOLUME
+                                        | PARAMETER_CONTROL_WORD__PARA_CONTROL__LIST_TYPE__OPAQUE
+                                        | PARAMETER_CONTROL_WORD__OBJ_CONTROL__COL_TYPE__FLOATING_COLOR
+                                        | PARAMETER_CONTROL_WORD__OBJ_CONTROL__GOURAUD;
 
-  polygon->isp_tsp_instruction_word = ISP_TSP_INSTRUCTION_WORD__DEPTH_COMPARE_MODE__GREATER
-                                    | ISP_TSP_INSTRUCTION_WORD__CULLING_MODE__NO_CULLING;
+  const uint32_t isp_tsp_instruction_word = ISP_TSP_INSTRUCTION_WORD__DEPTH_COMPARE_MODE__GREATER
+                                          | ISP_TSP_INSTRUCTION_WORD__CULLING_MODE__NO_CULLING;
   // Note that it is not possible to use
   // ISP_TSP_INSTRUCTION_WORD__GOURAUD_SHADING in this isp_tsp_instruction_word,
   // because `gouraud` is one of the bits overwritten by the value in
   // parameter_control_word. See DCDBSysArc990907E.pdf page 200.
 
-  polygon->tsp_instruction_word = TSP_INSTRUCTION_WORD__SRC_ALPHA_INSTR__ONE
-                                | TSP_INSTRUCTION_WORD__DST_ALPHA_INSTR__ZERO
-                                | TSP_INSTRUCTION_WORD__FOG_CONTROL__NO_FOG;
+  const uint32_t tsp_instruction_word = TSP_INSTRUCTION_WORD__SRC_ALPHA_INSTR__ONE
+                                      | TSP_INSTRUCTION_WORD__DST_ALPHA_INSTR__ZERO
+                                      | TSP_INSTRUCTION_WORD__FOG_CONTROL__NO_FOG;
 
-  polygon->texture_control_word = 0;
+  const uint32_t texture_control_word = 0;
 
-  polygon->data_size_for_sort_dma = 0;
-  polygon->next_address_for_sort_dma = 0;
+  return transfer_ta_global_parameter__polygon_type_0(store_queue_ix,
+                                                      parameter_control_word,
+                                                      isp_tsp_instruction_word,
+                                                      tsp_instruction_word,
+                                                      texture_control_word,
+                                                      0, // data_size_for_sort_dma
+                                                      0); // next_address_for_sort_dma
+}
+
+/*
+  A translucent band across the bottom of the screen, in front of the cube.
 
-  // start store queue transfer of `polygon` to the TA
-  pref(store_queue_ix);
+  This is a separate list (the translucent list) from the cube (the opaque
+  list); each list is ended by its own end of list parameter, and CORE blends
+  the band over the already-rendered opaque pixels of each tile.
+ */
+static inline uint32_t transfer_ta_overlay(uint32_t store_queue_ix)
+{
+  const uint32_t parameter_control_word = PARAMETER_CONTROL_WORD__PARA_CONTROL__PARA_TYPE__POLYGON_OR_MODIFIER_VOLUME
+                                        | PARAMETER_CONTROL_WORD__PARA_CONTROL__LIST_TYPE__TRANSLUCENT
+                                        | PARAMETER_CONTROL_WORD__OBJ_CONTROL__COL_TYPE__FLOATING_COLOR
+                                        | PARAMETER_CONTROL_WORD__OBJ_CONTROL__GOURAUD;
+
+  // the band is in front of the cube, and does not hide anything drawn later
+  const uint32_t isp_tsp_instruction_word = ISP_TSP_INSTRUCTION_WORD__DEPTH_COMPARE_MODE__GREATER_OR_EQUAL
+                                          | ISP_TSP_INSTRUCTION_WORD__CULLING_MODE__NO_CULLING
+                                          | ISP_TSP_INSTRUCTION_WORD__Z_WRITE_DISABLE;
+
+  const uint32_t tsp_instruction_word = TSP_INSTRUCTION_WORD__SRC_ALPHA_INSTR__SRC_ALPHA
+                                      | TSP_INSTRUCTION_WORD__DST_ALPHA_INSTR__INVERSE_SRC_ALPHA
+                                      | TSP_INSTRUCTION_WORD__FOG_CONTROL__NO_FOG
+                                      | TSP_INSTRUCTION_WORD__USE_ALPHA;
+
+  store_queue_ix = transfer_ta_global_parameter__polygon_type_0(store_queue_ix,
+                                                                parameter_control_word,
+                                                                isp_tsp_instruction_word,
+                                                                tsp_instruction_word,
+                                                                0, // texture_control_word
+                                                                0, // data_size_for_sort_dma
+                                                                0); // next_address_for_sort_dma
+
+  const color_argb color = { 0.5f, 0.0f, 0.0f, 0.25f };
+  const float z = 1.0f;
+  const vec2 corner[4] = {
+    {   0.0f, 480.0f },
+    {   0.0f, 416.0f },
+    { 640.0f, 480.0f },
+    { 640.0f, 416.0f },
+  };
 
-  store_queue_ix += (sizeof (ta_global_parameter__polygon_type_0));
+  for (int i = 0; i < 4; i++) {
+    store_queue_ix = transfer_ta_vertex(store_queue_ix,
+                                        corner[i].u, corner[i].v, z, color,
+                                        i == 3);
+  }
 
   return store_queue_ix;
 }
@@ -451,13 +325,7 @@ static inline uint32_t transfer_ta_global_polygon(uint32_t store_queue_ix)
   These vertex and face definitions are a trivial transformation of the default
   Blender cube, as exported by the .obj exporter (with triangulation enabled).
  */
-typedef struct vec3 {
-  float x;
-  float y;
-  float z;
-} vec3;
-
-static const vec3 cube_vertex_position[] = {
+static const vec3 cube_vertex_position[] __hot_rodata = {
   {  1.0f,  1.0f, -1.0f },
   {  1.0f, -1.0f, -1.0f },
   {  1.0f,  1.0f,  1.0f },
@@ -467,18 +335,47 @@ static const vec3 cube_vertex_position[] = {
   { -1.0f,  1.0f,  1.0f },
   { -1.0f, -1.0f,  1.0f },
 };
+static const int cube_vertex_position_length = (sizeof (cube_vertex_position)) / (sizeof (cube_vertex_position[0]));
+
+// the number of cube_faces
+#define CUBE_TRIANGLE_LENGTH 12
+
+// the screen-space vertex of each cube_vertex_position, transformed once per
+// frame (see mesh.h)
+//
+// there is room for the vertices created by near plane clipping (see clip.h)
+// after the transformed positions
+static vec3 cube_vertex_screen[(sizeof (cube_vertex_position)) / (sizeof (cube_vertex_position[0]))
+                               + CUBE_TRIANGLE_LENGTH * 2] __ocram0;
+
+static const color_argb cube_vertex_color[] __hot_rodata = {
+  { 1.0f, 1.0f, 0.0f, 0.0f }, // red
+  { 1.0f, 0.0f, 1.0f, 0.0f }, // green
+  { 1.0f, 0.0f, 0.0f, 1.0f }, // blue
+  { 1.0f, 1.0f, 1.0f, 0.0f }, // yellow
+  { 1.0f, 0.0f, 1.0f, 1.0f }, // cyan
+  { 1.0f, 1.0f, 0.0f, 1.0f }, // magenta
+  { 1.0f, 1.0f, 0.5f, 0.0f }, // orange
+  { 1.0f, 0.5f, 0.0f, 1.0f }, // violet
+};
 
-static const uint32_t cube_vertex_color[] = {
-  0xff0000, // red
-  0x00ff00, // green
-  0x0000ff, // blue
-  0xffff00, // yellow
-  0x00ffff, // cyan
-  0xff00ff, // magenta
-  0xff7f00, // orange
-  0x7f00ff, // violet
+// each corner is shared by three faces; its normal is the average of theirs,
+// which is the direction from the center of the cube
+static const vec3 cube_vertex_normal[] __hot_rodata = {
+  {  0.57735027f,  0.57735027f, -0.57735027f },
+  {  0.57735027f, -0.57735027f, -0.57735027f },
+  {  0.57735027f,  0.57735027f,  0.57735027f },
+  {  0.57735027f, -0.57735027f,  0.57735027f },
+  { -0.57735027f,  0.57735027f, -0.57735027f },
+  { -0.57735027f, -0.57735027f, -0.57735027f },
+  { -0.57735027f,  0.57735027f,  0.57735027f },
+  { -0.57735027f, -0.57735027f,  0.57735027f },
 };
 
+// the lit color of each cube_vertex_color, once per frame; never packed by
+// the CPU
+static color_argb cube_vertex_lit[(sizeof (cube_vertex_position)) / (sizeof (cube_vertex_position[0]))];
+
 typedef struct face {
   int a;
   int b;
@@ -486,15 +383,12 @@ typedef struct face {
 } face;
 
 /*
-  It is also possible to submit each cube face as a 4-vertex triangle strip, or
-  submit the entire cube as a single triangle strip.
-
-  Separate 3-vertex triangles are chosen to make this example more
-  straightforward, but this is not the best approach if high performance is
-  desired.
+  The faces are not submitted as separate 3-vertex triangles: they are
+  converted to triangle strips once, at initialization (build_cube_strips),
+  and each strip vertex is submitted as a single TA vertex parameter.
  */
 
-static const face cube_faces[] = {
+static const face cube_faces[] __hot_rodata = {
   {4, 2, 0},
   {2, 7, 3},
   {6, 5, 7},
@@ -509,54 +403,88 @@ static const face cube_faces[] = {
   {4, 0, 1},
 };
 static const int cube_faces_length = (sizeof (cube_faces)) / (sizeof (cube_faces[0]));
+static_assert((sizeof (cube_faces)) / (sizeof (cube_faces[0])) == CUBE_TRIANGLE_LENGTH);
 
-#define cos(n) __builtin_cosf(n)
-#define sin(n) __builtin_sinf(n)
+/*
+  The cube faces as triangle strips (see strip.h), built once by
+  build_cube_strips: the vertex indices of every strip, concatenated, and the
+  vertex count of each strip.
+ */
+static uint16_t cube_strip[(sizeof (cube_faces)) / (sizeof (cube_faces[0])) * 3];
+static uint16_t cube_strip_length[(sizeof (cube_faces)) / (sizeof (cube_faces[0]))];
+static int cube_strip_count;
 
-float theta = 0.7853981633974483f; // pi / 4
+// the strips clipped to the near plane, and the vertices created by clipping,
+// of each frame in which the cube crosses the near plane (see clip.h); each
+// triangle becomes at most two
+static clip_vertex cube_clip_vertex[CUBE_TRIANGLE_LENGTH * 2];
+static uint16_t cube_clip_strip[CUBE_TRIANGLE_LENGTH * 4];
+static uint16_t cube_clip_strip_length[CUBE_TRIANGLE_LENGTH];
 
-static inline vec3 vertex_rotate(vec3 v)
-{
-  // to make the cube's appearance more interesting, rotate the vertex on two
-  // axes
+// the strips of the front-facing triangles of each frame (see cull.h)
+static uint16_t cube_visible_strip[CUBE_TRIANGLE_LENGTH * 2 * 4] __ocram0;
+static uint16_t cube_visible_strip_length[CUBE_TRIANGLE_LENGTH * 2] __ocram0;
 
-  float x0 = v.x;
-  float y0 = v.y;
-  float z0 = v.z;
+// the distance from the center of the cube to each corner: √3
+static const float cube_radius = 1.7320508f;
 
-  float x1 = x0 * cos(theta) - z0 * sin(theta);
-  float y1 = y0;
-  float z1 = x0 * sin(theta) + z0 * cos(theta);
+void build_cube_strips()
+{
+  uint16_t triangle[(sizeof (cube_faces)) / (sizeof (cube_faces[0])) * 3];
+  uint8_t used[(sizeof (cube_faces)) / (sizeof (cube_faces[0]))];
 
-  float x2 = x1;
-  float y2 = y1 * cos(theta) - z1 * sin(theta);
-  float z2 = y1 * sin(theta) + z1 * cos(theta);
+  for (int face_ix = 0; face_ix < cube_faces_length; face_ix++) {
+    triangle[face_ix * 3 + 0] = cube_faces[face_ix].a;
+    triangle[face_ix * 3 + 1] = cube_faces[face_ix].b;
+    triangle[face_ix * 3 + 2] = cube_faces[face_ix].c;
+  }
 
-  return (vec3){x2, y2, z2};
+  cube_strip_count = strip_build(triangle, cube_faces_length,
+                                 cube_strip, cube_strip_length,
+                                 used);
 }
 
-static inline vec3 vertex_perspective_divide(vec3 v)
-{
-  float w = 1.0f / (v.z + 3.0f);
-  return (vec3){v.x * w, v.y * w, w};
-}
+/*
+  A white light from the upper left, behind the viewer, and a dimmer orange
+  point light to the lower right of the cube, in view space (see light.h).
+ */
+static const light_scene cube_lights = {
+  .ambient_color = { 1.0f, 1.0f, 1.0f, 1.0f },
+  .ambient_intensity = 0.2f,
+  .directional_length = 1,
+  .directional = {
+    {
+      .direction = { 0.57735027f, 0.57735027f, 0.57735027f },
+      .color = { 1.0f, 1.0f, 1.0f, 1.0f },
+      .intensity = 0.7f,
+    },
+  },
+  .point_length = 1,
+  .point = {
+    {
+      .position = { 2.0f, 2.0f, 2.0f },
+      .range = 4.0f,
+      .color = { 1.0f, 1.0f, 0.5f, 0.0f },
+      .intensity = 0.8f,
+    },
+  },
+};
 
-static inline vec3 vertex_screen_space(vec3 v)
+void light_cube_vertices(const mesh_view * view)
 {
-  return (vec3){
-    v.x * 240.f + 320.f,
-    v.y * 240.f + 240.f,
-    v.z,
-  };
+  light_model model = light_model_init(&cube_lights, view);
+  light_color(&model,
+              cube_vertex_normal, cube_vertex_position, cube_vertex_color,
+              cube_vertex_lit, cube_vertex_position_length);
 }
 
-void transfer_ta_cube()
-{
-  // set the store queue destination address to the TA Polygon Converter FIFO
-  *SH7091__CCN__QACR0 = ((ta_polygon_converter_fifo >> 24) & 0b11100);
-  *SH7091__CCN__QACR1 = ((ta_polygon_converter_fifo >> 24) & 0b11100);
+float theta __hot_data = 0.7853981633974483f; // pi / 4
 
-  uint32_t store_queue_ix = store_queue;
+void transfer_ta_cube(uint32_t ta_stream_mode)
+{
+  // in store queue mode, this also sets the store queue destination address to
+  // the TA Polygon Converter FIFO
+  uint32_t store_queue_ix = ta_stream_begin(ta_stream_mode);
 
   // See sh7091pm_e.pdf, printed page 79:
   //
@@ -571,65 +499,65 @@ void transfer_ta_cube()
 
   store_queue_ix = transfer_ta_global_polygon(store_queue_ix);
 
-  for (int face_ix = 0; face_ix < cube_faces_length; face_ix++) {
-    int ia = cube_faces[face_ix].a;
-    int ib = cube_faces[face_ix].b;
-    int ic = cube_faces[face_ix].c;
-
-    vec3 va = vertex_screen_space(
-                vertex_perspective_divide(
-                  vertex_rotate(cube_vertex_position[ia])));
-
-    vec3 vb = vertex_screen_space(
-                vertex_perspective_divide(
-                  vertex_rotate(cube_vertex_position[ib])));
-
-    vec3 vc = vertex_screen_space(
-                vertex_perspective_divide(
-                  vertex_rotate(cube_vertex_position[ic])));
-
-    uint32_t va_color = cube_vertex_color[ia];
-    uint32_t vb_color = cube_vertex_color[ib];
-    uint32_t vc_color = cube_vertex_color[ic];
-
-    store_queue_ix = transfer_ta_vertex_triangle(store_queue_ix,
-                                                 va.x, va.y, va.z, va_color,
-                                                 vb.x, vb.y, vb.z, vb_color,
-                                                 vc.x, vc.y, vc.z, vc_color);
+  mesh_view view = mesh_view_init(theta, 240.f, 320.f, 240.f);
+
+  // nothing is transformed or submitted if the cube is entirely outside the
+  // view frustum; the (empty) list is still ended
+  cull_frustum frustum = cull_frustum_init(&view, 640.f, 480.f, MESH__NEAR_Z);
+  int strip_count = 0;
+  if (!cull_sphere(&frustum, mesh_vertex_view_space((vec3){0.0f, 0.0f, 0.0f}, &view), cube_radius)) {
+    // transform each unique position once; the strips below only look up the
+    // transformed vertices
+    mat4 mvp = mesh_view_matrix(&view);
+    int behind = mesh_transform_xmtrx(cube_vertex_position, cube_vertex_screen, cube_vertex_position_length, &mvp);
+    light_cube_vertices(&view);
+
+    const uint16_t * strip = cube_strip;
+    const uint16_t * strip_length = cube_strip_length;
+    int clip_strip_count = cube_strip_count;
+    if (behind != 0) {
+      int generated_count;
+      clip_strip_count = clip_near(cube_vertex_screen, cube_vertex_position_length,
+                                   cube_clip_vertex, &generated_count,
+                                   strip, strip_length, clip_strip_count,
+                                   cube_clip_strip, cube_clip_strip_length);
+      strip = cube_clip_strip;
+      strip_length = cube_clip_strip_length;
+    }
+
+    strip_count = cull_back_faces(cube_vertex_screen,
+                                  strip, strip_length, clip_strip_count,
+                                  cube_visible_strip, cube_visible_strip_length);
   }
 
-  store_queue_ix = transfer_ta_global_end_of_list(store_queue_ix);
-}
-
-/******************************************************************************
- Holly register definitions
- ******************************************************************************/
-
-volatile uint32_t * SOFTRESET     = (volatile uint32_t *)(0xa05f8000 + 0x08);
-volatile uint32_t * STARTRENDER   = (volatile uint32_t *)(0xa05f8000 + 0x14);
-volatile uint32_t * PARAM_BASE    = (volatile uint32_t *)(0xa05f8000 + 0x20);
-volatile uint32_t * REGION_BASE   = (volatile uint32_t *)(0xa05f8000 + 0x2c);
-volatile uint32_t * FB_R_SOF1     = (volatile uint32_t *)(0xa05f8000 + 0x50);
-volatile uint32_t * FB_W_SOF1     = (volatile uint32_t *)(0xa05f8000 + 0x60);
-volatile uint32_t * ISP_BACKGND_T = (volatile uint32_t *)(0xa05f8000 + 0x8c);
-
-volatile uint32_t * SPG_STATUS = (volatile uint32_t *)(0xa05f8000 + 0x10c);
+  // each strip vertex is a single TA vertex parameter
+  const uint16_t * strip = cube_visible_strip;
+  for (int strip_ix = 0; strip_ix < strip_count; strip_ix++) {
+    int length = cube_visible_strip_length[strip_ix];
+
+    for (int i = 0; i < length; i++) {
+      int iv = strip[i];
+      vec3 v = cube_vertex_screen[iv];
+      color_argb color = (iv < cube_vertex_position_length)
+        ? cube_vertex_lit[iv]
+        : clip_argb(cube_vertex_lit, &cube_clip_vertex[iv - cube_vertex_position_length]);
+      bool end_of_strip = (i == length - 1);
+
+      store_queue_ix = transfer_ta_vertex(store_queue_ix,
+                                          v.x, v.y, v.z, color,
+                                          end_of_strip);
+    }
+
+    strip += length;
+  }
 
-#define SPG_STATUS__VSYNC (1 << 13)
+  store_queue_ix = transfer_ta_global_end_of_list(store_queue_ix);
 
-volatile uint32_t * TA_OL_BASE        = (volatile uint32_t *)(0xa05f8000 + 0x124);
-volatile uint32_t * TA_ISP_BASE       = (volatile uint32_t *)(0xa05f8000 + 0x128);
-volatile uint32_t * TA_OL_LIMIT       = (volatile uint32_t *)(0xa05f8000 + 0x12c);
-volatile uint32_t * TA_ISP_LIMIT      = (volatile uint32_t *)(0xa05f8000 + 0x130);
-volatile uint32_t * TA_GLOB_TILE_CLIP = (volatile uint32_t *)(0xa05f8000 + 0x13c);
-volatile uint32_t * TA_ALLOC_CTRL     = (volatile uint32_t *)(0xa05f8000 + 0x140);
-volatile uint32_t * TA_LIST_INIT      = (volatile uint32_t *)(0xa05f8000 + 0x144);
+  store_queue_ix = transfer_ta_overlay(store_queue_ix);
+  store_queue_ix = transfer_ta_global_end_of_list(store_queue_ix);
 
-#define TA_GLOB_TILE_CLIP__TILE_Y_NUM(n) (((n) & 0xf) << 16)
-#define TA_GLOB_TILE_CLIP__TILE_X_NUM(n) (((n) & 0x1f) << 0)
-#define TA_ALLOC_CTRL__OPB_MODE__INCREASING_ADDRESSES (0 << 20)
-#define TA_ALLOC_CTRL__O_OPB__8X4BYTE (1 << 0)
-#define TA_LIST_INIT__LIST_INIT (1 << 31)
+  ta_stream_end(store_queue_ix);
+}
 
 void main()
 {
@@ -639,16 +567,29 @@ void main()
     the ordering within texture memory is not significant, and could be
     anything
   */
-  uint32_t framebuffer_start       = 0x200000; // intentionally the same address that the boot rom used to draw the SEGA logo
+  const uint32_t framebuffer_start[2] = {
+    0x600000,
+    0x200000, // intentionally the same address that the boot rom used to draw the SEGA logo
+  };
   uint32_t isp_tsp_parameter_start = 0x400000;
   uint32_t region_array_start      = 0x500000;
   uint32_t object_list_start       = 0x100000;
-  uint32_t opaque_list_pointer     = object_list_start;
 
   // background_offset is relative to the beginning of isp_tsp_parameter_start
   uint32_t background_offset     = (sizeof (isp_tsp_parameter__polygon)) * 0;
 
-  transfer_region_array(region_array_start, opaque_list_pointer);
+  // the opaque list (the cube) and the translucent list (the overlay); see ta_alloc.h
+  const int tile_y_num = 480 / 32;
+  const int tile_x_num = 640 / 32;
+  const uint32_t opb_words[TA_ALLOC__LIST_COUNT] = {
+    [TA_ALLOC__OPAQUE] = TA_ALLOC__OPB_8,
+    [TA_ALLOC__TRANSLUCENT] = TA_ALLOC__OPB_8,
+  };
+  ta_alloc alloc = ta_alloc_init(tile_x_num, tile_y_num, opb_words);
+
+  region_array_transfer(texture_memory32 + region_array_start, object_list_start, &alloc);
+
+  build_cube_strips();
 
   transfer_isp_tsp_background_parameter(isp_tsp_parameter_start);
 
@@ -656,9 +597,6 @@ void main()
   // configure the TA
   //////////////////////////////////////////////////////////////////////////////
 
-  const int tile_y_num = 480 / 32;
-  const int tile_x_num = 640 / 32;
-
   // TA_GLOB_TILE_CLIP restricts which "object pointer blocks" are written
   // to.
   //
@@ -668,15 +606,14 @@ void main()
   // within a single TA initialization to produce an identical effect.
   //
   // See DCDBSysArc990907E.pdf page 183.
-  *TA_GLOB_TILE_CLIP = TA_GLOB_TILE_CLIP__TILE_Y_NUM(tile_y_num - 1)
-                     | TA_GLOB_TILE_CLIP__TILE_X_NUM(tile_x_num - 1);
+  *TA_GLOB_TILE_CLIP = ta_alloc_glob_tile_clip(&alloc);
 
   // While CORE supports arbitrary-length object lists, the TA uses "object
   // pointer blocks" as a memory allocation strategy. These fixed-length blocks
   // can still have infinite length via "object pointer block links". This
-  // mechanism is illustrated in DCDBSysArc990907E.pdf page 188.
-  *TA_ALLOC_CTRL = TA_ALLOC_CTRL__OPB_MODE__INCREASING_ADDRESSES
-                 | TA_ALLOC_CTRL__O_OPB__8X4BYTE;
+  // mechanism is illustrated in DCDBSysArc990907E.pdf page 188. Each list type
+  // has its own object pointer block size.
+  *TA_ALLOC_CTRL = ta_alloc_ctrl(&alloc);
 
   // While building object lists, the TA contains an internal index (exposed as
   // the read-only TA_ITP_CURRENT) for the next address that new ISP/TSP will be
@@ -698,6 +635,9 @@ void main()
   // >   in the TA_ISP_BASE register.
   *TA_OL_LIMIT = object_list_start + 0x100000 - 32;
 
+  // OPB links are allocated after the OPBs of every tile; see ta_alloc.h
+  *TA_NEXT_OPB_INIT = object_list_start + alloc.size;
+
   //////////////////////////////////////////////////////////////////////////////
   // configure CORE
   //////////////////////////////////////////////////////////////////////////////
@@ -717,19 +657,61 @@ void main()
                  | ISP_BACKGND_T__SKIP(1);
 
   // FB_W_SOF1 is the (texture memory-relative) address of the framebuffer that
-  // will be written to when a tile is rendered/flushed.
-  *FB_W_SOF1 = framebuffer_start;
-
-  // without waiting for rendering to actually complete, immediately display the
-  // framebuffer.
-  *FB_R_SOF1 = framebuffer_start;
+  // will be written to when a tile is rendered/flushed. FB_W_SOF1 and FB_R_SOF1
+  // are set for each frame by display.h.
 
   //////////////////////////////////////////////////////////////////////////////
   // animated drawing
   //////////////////////////////////////////////////////////////////////////////
 
+  scif_init();
+  tmu_init();
+
+  // display.h and CH2-DMA (ta_stream.h) wait for these events; with the
+  // interrupts enabled, waiting does not poll ISTNRM
+  interrupt_init(DISPLAY__INTERRUPTS
+               | ta_alloc_list_end_events(&alloc)
+               | ISTNRM__END_OF_DMA_CH2_DMA,
+                 0);
+
+  // discard end of list and end of render status left by the boot rom or the
+  // serial loader; otherwise the first interrupt_wait may return before the TA
+  // or CORE has finished
+  interrupt_clear(ta_alloc_list_end_events(&alloc)
+                  | ISTNRM__END_OF_RENDER_TSP
+                  | ISTNRM__END_OF_RENDER_ISP
+                  | ISTNRM__END_OF_RENDER_VIDEO);
+
+  // double buffering: the boot rom framebuffer (the last in the ring) continues
+  // to be displayed until the first frame is complete
+  display_init(framebuffer_start, 2);
+
+  // CPU time spent submitting each frame (TA_LIST_INIT through the hand-off of
+  // the last TA parameter), in TMU ticks. Comparing a CACHED=0 build with a
+  // CACHED=1 build shows the effect of the SH4 caches on the per-frame CPU
+  // work.
+  //
+  // The first half of the frames are submitted with the store queue, the
+  // second half with CH2-DMA (see ta_stream.h).
+  uint32_t frame_ticks[2] = {0, 0};
+  // TA parameter bytes submitted, summed over every frame
+  uint32_t ta_bytes = 0;
+  const int frame_count = 500;
+
+  // render time (STARTRENDER through the end of render interrupt), in TMU
+  // ticks, of the frames that render every tile's translucent list (0) and of
+  // the frames that skip empty translucent lists (1), and the CPU time spent
+  // updating the region array for the latter
+  uint32_t render_ticks[2] = {0, 0};
+  uint32_t skip_ticks = 0;
+  uint32_t skipped_tiles = 0;
+
   // draw 500 frames of cube rotation
-  for (int i = 0; i < 500; i++) {
+  for (int i = 0; i < frame_count; i++) {
+    uint32_t ta_stream_mode = (i < frame_count / 2) ? TA_STREAM__STORE_QUEUE : TA_STREAM__DMA;
+
+    uint32_t frame_start = tmu_ticks();
+
     //////////////////////////////////////////////////////////////////////////////
     // transfer cube to texture memory via the TA polygon converter FIFO
     //////////////////////////////////////////////////////////////////////////////
@@ -742,24 +724,77 @@ void main()
     // step is required.
     (void)*TA_LIST_INIT;
 
-    transfer_ta_cube();
+    transfer_ta_cube(ta_stream_mode);
+
+    frame_ticks[ta_stream_mode] += tmu_ticks() - frame_start;
+    ta_bytes += ta_stream_state.bytes;
+
+    // wait for the TA to receive every parameter, and to finish building the
+    // opaque and translucent object lists, before starting the render
+    ta_stream_wait();
+    interrupt_wait(ta_alloc_list_end_events(&alloc));
+
+    // the translucent list is the last list built, so TA_OL_POINTERS describes
+    // it. The previous render has completed, so the region array can be
+    // changed.
+    bool skip_empty = i & 1;
+    uint32_t skip_start = tmu_ticks();
+    if (skip_empty) {
+      region_array_empty_tiles(&alloc, translucent_empty_tiles);
+    } else {
+      for (int j = 0; j < REGION_ARRAY__TILE_SET_WORDS; j++)
+        translucent_empty_tiles[j] = 0;
+    }
+    region_array_update_empty(texture_memory32 + region_array_start, object_list_start, &alloc,
+                              TA_ALLOC__TRANSLUCENT, translucent_empty_tiles, translucent_empty_current);
+    if (skip_empty) {
+      skip_ticks += tmu_ticks() - skip_start;
+      // there is no libgcc (-nostdlib), so no __builtin_popcount
+      for (int j = 0; j < REGION_ARRAY__TILE_SET_WORDS; j++) {
+        for (uint32_t tiles = translucent_empty_tiles[j]; tiles != 0; tiles &= tiles - 1)
+          skipped_tiles += 1;
+      }
+    }
 
     //////////////////////////////////////////////////////////////////////////////
     // start the actual rasterization
     //////////////////////////////////////////////////////////////////////////////
 
+    // wait for a framebuffer that is not being displayed; with two
+    // framebuffers, this waits for the previous frame to be displayed from a
+    // vertical blank
+    display_render_begin();
+
     // start the actual render--the rendering process begins by interpreting the
     // region array
     *STARTRENDER = 1;
+    uint32_t render_start = tmu_ticks();
 
-    // wait for vertical synchronization
-    while (!((*SPG_STATUS) & SPG_STATUS__VSYNC));
-    while (((*SPG_STATUS) & SPG_STATUS__VSYNC));
+    // the next frame reuses the same object list and ISP/TSP parameters, so
+    // wait for CORE to finish reading them. The render end callback in
+    // display.h queues this frame for display.
+    interrupt_wait(ISTNRM__END_OF_RENDER_TSP);
+    render_ticks[skip_empty] += tmu_ticks() - render_start;
 
     // increment theta for the cube rotation animation
-    // (used by the `vertex_rotate` function)
+    // (see mesh_view_init)
     theta += 0.01f;
   }
 
+  display_finish();
+
+  scif_label_base10("cached", CACHED);
+  scif_label_base10("store queue frame time (average, us)", tmu_ticks_to_us(frame_ticks[TA_STREAM__STORE_QUEUE] / (frame_count / 2)));
+  scif_label_base10("CH2-DMA frame time (average, us)", tmu_ticks_to_us(frame_ticks[TA_STREAM__DMA] / (frame_count / 2)));
+  scif_label_base10("TA bytes per frame", ta_bytes / frame_count);
+  scif_label_base10("back-facing triangles culled per frame", cull_state.triangles_back_facing / frame_count);
+  scif_label_base10("frames culled by the view frustum", cull_state.objects_outside);
+  scif_label_base10("triangles clipped to the near plane", clip_state.triangles_clipped);
+  scif_label_base10("render time, every tile (average, us)", tmu_ticks_to_us(render_ticks[0] / (frame_count / 2)));
+  scif_label_base10("render time, empty tiles skipped (average, us)", tmu_ticks_to_us(render_ticks[1] / (frame_count / 2)));
+  scif_label_base10("region array update time (average, us)", tmu_ticks_to_us(skip_ticks / (frame_count / 2)));
+  scif_label_base10("empty translucent tiles per frame", skipped_tiles / (frame_count / 2));
+  scif_flush();
+
   // return from main; this will effectively jump back to the serial loader
 }
@@ -1,5 +1,24 @@
 #include <stdint.h>
 
+#include "clip.h"
+#include "cull.h"
+#include "display.h"
+#include "holly.h"
+#include "interrupt.h"
+#include "light.h"
+#include "mesh.h"
+#include "mesh_format.h"
+#include "region_array.h"
+#include "scheduler.h"
+#include "scif.h"
+#include "sections.h"
+#include "sq.h"
+#include "ta_alloc.h"
+#include "ta_parameter.h"
+#include "ta_stream.h"
+#include "tmu.h"
+#include "vram.h"
+
 /*
   This demo does not work in emulators:
 
@@ -29,110 +48,15 @@
 const uint32_t texture_memory64 = 0xa4000000;
 const uint32_t texture_memory32 = 0xa5000000;
 
-/* The "TA Polygon Converter FIFO" is a Holly functional unit. */
-const uint32_t ta_polygon_converter_fifo = 0x10000000;
-
-/* The "Store Queue" is a SH4 functional unit. */
-const uint32_t store_queue = 0xe0000000;
-
 /******************************************************************************
  Region array
  ******************************************************************************/
 
 /*
-  These "region array entries" are briefly illustrated in DCDBSysArc990907E.pdf
-  page 168, 177-180.
-
-  The number of list pointers per region array entry is affected by
-  FPU_PARAM_CFG "Region Header Type" (page 368). This struct models the
-  "6 × 32bit/Tile Type 2" mode.
-*/
-typedef struct region_array_entry {
-  uint32_t tile;
-  struct {
-    uint32_t opaque;
-    uint32_t opaque_modifier_volume;
-    uint32_t translucent;
-    uint32_t translucent_modifier_volume;
-    uint32_t punch_through;
-  } list_pointer;
-} region_array_entry;
-static_assert((sizeof (struct region_array_entry)) == 4 * 6);
-
-/*
-  DCDBSysArc990907E.pdf page 216-217 describes the REGION_ARRAY__ bit fields:
+  The region array (two entries per tile: the retained backdrop, then the
+  frame; see region_array.h) and the object pointer blocks of each list type
+  (see ta_alloc.h) are both laid out from a single ta_alloc, in main.
  */
-#define REGION_ARRAY__TILE__LAST_REGION (1 << 31)
-#define REGION_ARRAY__TILE__Y_POSITION(n) (((n) & 0x3f) << 8)
-#define REGION_ARRAY__TILE__X_POSITION(n) (((n) & 0x3f) << 2)
-
-#define REGION_ARRAY__LIST_POINTER__EMPTY (1 << 31)
-#define REGION_ARRAY__LIST_POINTER__OBJECT_LIST(n) (((n) & 0xfffffc) << 0)
-
-void transfer_region_array(uint32_t region_array_start,
-                           uint32_t opaque_list_pointer)
-{
-  /*
-    Create a minimal region array with a single entry:
-       - one tile at tile coordinate (0, 0) with one opaque list pointer
-  */
-
-  /*
-    Holly reads the region array from "32-bit" texture memory address space,
-    so the region array is correspondingly written from "32-bit" address space.
-   */
-  volatile region_array_entry * region_array = (volatile region_array_entry *)(texture_memory32 + region_array_start);
-
-  const int num_tiles_x = 640 / 32;
-  const int num_tiles_y = 480 / 32;
-  const int num_tiles = num_tiles_x * num_tiles_y;
-
-  for (int i = 0; i < num_tiles; i++) {
-    /* define one region array entry per 32×32 px tile over a 640x480 px area */
-
-    int x = i % num_tiles_x;
-    int y = i / num_tiles_x;
-
-    bool last_tile = (i == (num_tiles - 1));
-
-    region_array[i].tile
-      = (last_tile ? REGION_ARRAY__TILE__LAST_REGION : 0)
-      | REGION_ARRAY__TILE__Y_POSITION(y)
-      | REGION_ARRAY__TILE__X_POSITION(x);
-
-    /*
-      list pointers are offsets relative to the beginning of "32-bit" texture memory.
-
-      Each list type uses different rasterization steps, "opaque" being the fastest and most efficient.
-    */
-
-    /*
-      In all previous demos, a single `opaque_list_pointer` was used for all
-      tiles. This was correct in the cases where:
-
-      - we were generating our own object lists
-      - we were using the TA with a single tile
-
-      However, this is no longer correct for this example, where we are both
-      using the TA and multiple tiles simultaneously. In this case, the TA's
-      "object pointer block" allocation strategy needs to implemented here.
-
-      See DCDBSysArc990907E.pdf page 178,179 and 186 for a relatively weak
-      explanation of the TA's OPB allocation behavior.
-     */
-
-
-    // This example is using TA_ALLOC_CTRL__O_OPB__8X4BYTE, so each OPB is 8×4
-    // bytes. They are (un)coincidentally stored in the same order that the
-    // tile x position and tile y position coordinates are calculated above.
-    int opb_pointer = opaque_list_pointer + i * 8 * 4;
-    region_array[i].list_pointer.opaque                      = REGION_ARRAY__LIST_POINTER__OBJECT_LIST(opb_pointer);
-    region_array[i].list_pointer.opaque_modifier_volume      = REGION_ARRAY__LIST_POINTER__EMPTY;
-    region_array[i].list_pointer.translucent                 = REGION_ARRAY__LIST_POINTER__EMPTY;
-    region_array[i].list_pointer.translucent_modifier_volume = REGION_ARRAY__LIST_POINTER__EMPTY;
-    region_array[i].list_pointer.punch_through               = REGION_ARRAY__LIST_POINTER__EMPTY;
-  }
-}
 
 /******************************************************************************
  ISP/TSP Parameter
@@ -187,6 +111,7 @@ typedef struct isp_tsp_parameter__polygon {
 #define TSP_INSTRUCTION_WORD__FOG_CONTROL__NO_FOG (0b10 << 22)
 #define TSP_INSTRUCTION_WORD__FILTER_MODE__POINT_SAMPLED (0b00 << 13)
 #define TSP_INSTRUCTION_WORD__TEXTURE_SHADING_INSTRUCTION__DECAL (0 << 6)
+#define TSP_INSTRUCTION_WORD__TEXTURE_SHADING_INSTRUCTION__MODULATE (1 << 6)
 #define TSP_INSTRUCTION_WORD__TEXTURE_U_SIZE__256 (5 << 3)
 #define TSP_INSTRUCTION_WORD__TEXTURE_V_SIZE__256 (5 << 0)
 
@@ -251,22 +176,14 @@ void transfer_isp_tsp_background_parameter(uint32_t isp_tsp_parameter_start)
 
   - meticulous and clever use of SH4 cache writeback (esoteric forbidden technique)
 
-  Of these, the mechanism that requires the least code is the SH4 store queue,
-  so this demo will also use the SH4 store queue for that reason.
+  This demo can use either the SH4 store queue, or Holly CH2-DMA from a
+  system memory buffer; see ta_stream.h. Each `ta_flush` call below is a `pref`
+  in store queue mode.
 
   The SH4 store queue is described in sh7091pm_e.pdf printed page 61-64 and
   79-81.
 */
 
-// sh7091pm_e.pdf:
-//  > Issuing a PREF instruction for P4 area H'E000 0000 to H'E3FF FFFC starts a
-//  > burst transfer from the SQs to external memory.
-#define pref(address) \
-  { asm volatile ("pref @%0" : : "r" (address) : "memory"); }
-
-volatile uint32_t * SH7091__CCN__QACR0 = (volatile uint32_t *)(0xff000000 + 0x38);
-volatile uint32_t * SH7091__CCN__QACR1 = (volatile uint32_t *)(0xff000000 + 0x3c);
-
 /******************************************************************************
  TA Parameters
  ******************************************************************************/
@@ -282,7 +199,9 @@ volatile uint32_t * SH7091__CCN__QACR1 = (volatile uint32_t *)(0xff000000 + 0x3c
   TA can do the same conversion much more quickly (~1 clock cycle).
 
   Floating point color is typical when performing (colored) lighting/shading
-  calculations.
+  calculations. This demo lights each vertex as a single floating point
+  intensity (see light.h); the TA multiplies the face color by it, and packs
+  the result.
  */
 
 /*
@@ -297,29 +216,9 @@ volatile uint32_t * SH7091__CCN__QACR1 = (volatile uint32_t *)(0xff000000 + 0x3c
     exclusively supports 32-bit packed integer ARGB color.
  */
 
-typedef struct ta_global_parameter__polygon_type_0 {
-  uint32_t parameter_control_word;
-  uint32_t isp_tsp_instruction_word;
-  uint32_t tsp_instruction_word;
-  uint32_t texture_control_word;
-  uint32_t _res0;
-  uint32_t _res1;
-  uint32_t data_size_for_sort_dma;
-  uint32_t next_address_for_sort_dma;
-} ta_global_parameter__polygon_type_0;
-static_assert((sizeof (struct ta_global_parameter__polygon_type_0)) == 32);
-
-typedef struct ta_global_parameter__end_of_list {
-  uint32_t parameter_control_word;
-  uint32_t _res0;
-  uint32_t _res1;
-  uint32_t _res2;
-  uint32_t _res3;
-  uint32_t _res4;
-  uint32_t _res5;
-  uint32_t _res6;
-} ta_global_parameter__end_of_list;
-static_assert((sizeof (struct ta_global_parameter__end_of_list)) == 32);
+#define TEXTURE_CONTROL_WORD__PIXEL_FORMAT__565 (1 << 27)
+#define TEXTURE_CONTROL_WORD__SCAN_ORDER__NON_TWIDDLED (1 << 26)
+#define TEXTURE_CONTROL_WORD__TEXTURE_ADDRESS(a) (((a) & 0x1fffff) << 0)
 
 /*
   The TA only supports polygon/triangle vertex input represented as a triangle
@@ -330,264 +229,133 @@ static_assert((sizeof (struct ta_global_parameter__end_of_list)) == 32);
 
   See DCDBSysArc990907E.pdf page 181.
  */
-typedef struct ta_vertex_parameter__polygon_type_3 {
-  uint32_t parameter_control_word;
-  float x;
-  float y;
-  float z;
-  float u;
-  float v;
-  uint32_t base_color;
-  uint32_t offset_color;
-} ta_vertex_parameter__polygon_type_3;
-static_assert((sizeof (struct ta_vertex_parameter__polygon_type_3)) == 32);
-
-#define PARAMETER_CONTROL_WORD__PARA_CONTROL__PARA_TYPE__END_OF_LIST (0 << 29)
-#define PARAMETER_CONTROL_WORD__PARA_CONTROL__PARA_TYPE__POLYGON_OR_MODIFIER_VOLUME (4 << 29)
-#define PARAMETER_CONTROL_WORD__PARA_CONTROL__PARA_TYPE__VERTEX_PARAMETER (7 << 29)
-#define PARAMETER_CONTROL_WORD__PARA_CONTROL__END_OF_STRIP (1 << 28)
-#define PARAMETER_CONTROL_WORD__PARA_CONTROL__LIST_TYPE__OPAQUE (0 << 24)
-#define PARAMETER_CONTROL_WORD__OBJ_CONTROL__COL_TYPE__PACKED_COLOR (0 << 4)
-#define PARAMETER_CONTROL_WORD__OBJ_CONTROL__TEXTURE (1 << 3)
-#define PARAMETER_CONTROL_WORD__OBJ_CONTROL__GOURAUD (1 << 1)
-
-#define TEXTURE_CONTROL_WORD__PIXEL_FORMAT__565 (1 << 27)
-#define TEXTURE_CONTROL_WORD__SCAN_ORDER__NON_TWIDDLED (1 << 26)
-#define TEXTURE_CONTROL_WORD__TEXTURE_ADDRESS(a) (((a) & 0x1fffff) << 0)
-
-static inline uint32_t transfer_ta_global_end_of_list(uint32_t store_queue_ix)
+static inline uint32_t transfer_ta_vertex(uint32_t store_queue_ix,
+                                          float x, float y, float z, float u, float v, float intensity,
+                                          bool end_of_strip)
 {
-  //
-  // TA "end of list" global transfer
-  //
-
-  volatile ta_global_parameter__end_of_list * end_of_list = (volatile ta_global_parameter__end_of_list *)store_queue_ix;
-
-  end_of_list->parameter_control_word = PARAMETER_CONTROL_WORD__PARA_CONTROL__PARA_TYPE__END_OF_LIST;
-
-  // start store queue transfer of `end_of_list` to the TA
-  pref(store_queue_ix);
-
-  store_queue_ix += (sizeof (ta_global_parameter__end_of_list));
-
-  return store_queue_ix;
-}
-
-static inline uint32_t transfer_ta_vertex_triangle(uint32_t store_queue_ix,
-                                                   float ax, float ay, float az, float au, float av, uint32_t ac,
-                                                   float bx, float by, float bz, float bu, float bv, uint32_t bc,
-                                                   float cx, float cy, float cz, float cu, float cv, uint32_t cc)
-{
-  //
-  // TA polygon vertex transfer
-  //
-
-  volatile ta_vertex_parameter__polygon_type_3 * vertex = (volatile ta_vertex_parameter__polygon_type_3 *)store_queue_ix;
-
-  // bottom left
-  vertex[0].parameter_control_word = PARAMETER_CONTROL_WORD__PARA_CONTROL__PARA_TYPE__VERTEX_PARAMETER;
-  vertex[0].x = ax;
-  vertex[0].y = ay;
-  vertex[0].z = az;
-  vertex[0].u = au;
-  vertex[0].v = av;
-  vertex[0].base_color = ac;
-  vertex[0].offset_color = 0;
-
-  // start store queue transfer of `vertex[0]` to the TA
-  pref(store_queue_ix + 32 * 0);
-
-  // top center
-  vertex[1].parameter_control_word = PARAMETER_CONTROL_WORD__PARA_CONTROL__PARA_TYPE__VERTEX_PARAMETER;
-  vertex[1].x = bx;
-  vertex[1].y = by;
-  vertex[1].z = bz;
-  vertex[1].u = bu;
-  vertex[1].v = bv;
-  vertex[1].base_color = bc;
-  vertex[1].offset_color = 0;
-
-  // start store queue transfer of `vertex[1]` to the TA
-  pref(store_queue_ix + 32 * 1);
-
-  // bottom right
-  vertex[2].parameter_control_word = PARAMETER_CONTROL_WORD__PARA_CONTROL__PARA_TYPE__VERTEX_PARAMETER
-                                   | PARAMETER_CONTROL_WORD__PARA_CONTROL__END_OF_STRIP;
-  vertex[2].x = cx;
-  vertex[2].y = cy;
-  vertex[2].z = cz;
-  vertex[2].u = cu;
-  vertex[2].v = cv;
-  vertex[2].base_color = cc;
-  vertex[2].offset_color = 0;
-
-  // start store queue transfer of `params[2]` to the TA
-  pref(store_queue_ix + 32 * 2);
-
-  store_queue_ix += (sizeof (ta_vertex_parameter__polygon_type_3)) * 3;
-
-  return store_queue_ix;
+  return transfer_ta_vertex_parameter__polygon_type_7(store_queue_ix,
+                                                      ta_vertex_parameter_control_word(end_of_strip),
+                                                      x, y, z,
+                                                      u, v,
+                                                      intensity,
+                                                      0.0f); // offset_intensity
 }
 
 static inline uint32_t transfer_ta_global_polygon(uint32_t store_queue_ix, uint32_t texture_address)
 {
-  //
-  // TA polygon global transfer
-  //
-
-  volatile ta_global_parameter__polygon_type_0 * polygon = (volatile ta_global_parameter__polygon_type_0 *)store_queue_ix;
-
-  polygon->parameter_control_word = PARAMETER_CONTROL_WORD__PARA_CONTROL__PARA_TYPE__POLYGON_OR_MODIFIER_VOLUME
-                                  | PARAMETER_CONTROL_WORD__PARA_CONTROL__LIST_TYPE__OPAQUE
-                                  | PARAMETER_CONTROL_WORD__OBJ_CONTROL__COL_TYPE__PACKED_COLOR
-                                  | PARAMETER_CONTROL_WORD__OBJ_CONTROL__TEXTURE
-                                  | PARAMETER_CONTROL_WORD__OBJ_CONTROL__GOURAUD;
-
-  polygon->isp_tsp_instruction_word = ISP_TSP_INSTRUCTION_WORD__DEPTH_COMPARE_MODE__GREATER
-                                    | ISP_TSP_INSTRUCTION_WORD__CULLING_MODE__NO_CULLING;
+  const uint32_t parameter_control_word = PARAMETER_CONTROL_WORD__PARA_CONTROL__PARA_TYPE__POLYGON_OR_MODIFIER_VOLUME
+                                        | PARAMETER_CONTROL_WORD__PARA_CONTROL__LIST_TYPE__OPAQUE
+                                        | PARAMETER_CONTROL_WORD__OBJ_CONTROL__COL_TYPE__INTENSITY_MODE_1
+                                        | PARAMETER_CONTROL_WORD__OBJ_CONTROL__TEXTURE
+                                        | PARAMETER_CONTROL_WORD__OBJ_CONTROL__GOURAUD;
+
+  const uint32_t isp_tsp_instruction_word = ISP_TSP_INSTRUCTION_WORD__DEPTH_COMPARE_MODE__GREATER
+                                          | ISP_TSP_INSTRUCTION_WORD__CULLING_MODE__NO_CULLING;
   // Note that it is not possible to use
   // ISP_TSP_INSTRUCTION_WORD__GOURAUD_SHADING in this isp_tsp_instruction_word,
   // because `gouraud` is one of the bits overwritten by the value in
   // parameter_control_word. See DCDBSysArc990907E.pdf page 200.
 
-  polygon->tsp_instruction_word = TSP_INSTRUCTION_WORD__SRC_ALPHA_INSTR__ONE
-                                | TSP_INSTRUCTION_WORD__DST_ALPHA_INSTR__ZERO
-                                | TSP_INSTRUCTION_WORD__FOG_CONTROL__NO_FOG
-                                | TSP_INSTRUCTION_WORD__FILTER_MODE__POINT_SAMPLED
-                                | TSP_INSTRUCTION_WORD__TEXTURE_SHADING_INSTRUCTION__DECAL
-                                | TSP_INSTRUCTION_WORD__TEXTURE_U_SIZE__256
-                                | TSP_INSTRUCTION_WORD__TEXTURE_V_SIZE__256;
-
-  polygon->texture_control_word = TEXTURE_CONTROL_WORD__PIXEL_FORMAT__565
-                                | TEXTURE_CONTROL_WORD__SCAN_ORDER__NON_TWIDDLED
-                                | TEXTURE_CONTROL_WORD__TEXTURE_ADDRESS(texture_address / 8);
-
-  polygon->data_size_for_sort_dma = 0;
-  polygon->next_address_for_sort_dma = 0;
-
-  // start store queue transfer of `polygon` to the TA
-  pref(store_queue_ix);
-
-  store_queue_ix += (sizeof (ta_global_parameter__polygon_type_0));
-
-  return store_queue_ix;
+  const uint32_t tsp_instruction_word = TSP_INSTRUCTION_WORD__SRC_ALPHA_INSTR__ONE
+                                      | TSP_INSTRUCTION_WORD__DST_ALPHA_INSTR__ZERO
+                                      | TSP_INSTRUCTION_WORD__FOG_CONTROL__NO_FOG
+                                      | TSP_INSTRUCTION_WORD__FILTER_MODE__POINT_SAMPLED
+                                      | TSP_INSTRUCTION_WORD__TEXTURE_SHADING_INSTRUCTION__MODULATE
+                                      | TSP_INSTRUCTION_WORD__TEXTURE_U_SIZE__256
+                                      | TSP_INSTRUCTION_WORD__TEXTURE_V_SIZE__256;
+
+  const uint32_t texture_control_word = TEXTURE_CONTROL_WORD__PIXEL_FORMAT__565
+                                      | TEXTURE_CONTROL_WORD__SCAN_ORDER__NON_TWIDDLED
+                                      | TEXTURE_CONTROL_WORD__TEXTURE_ADDRESS(texture_address / 8);
+
+  // each vertex intensity (see light.h) scales this face color, which then
+  // modulates the texture
+  return transfer_ta_global_parameter__polygon_type_1(store_queue_ix,
+                                                      parameter_control_word,
+                                                      isp_tsp_instruction_word,
+                                                      tsp_instruction_word,
+                                                      texture_control_word,
+                                                      1.0f,  // face_color_alpha
+                                                      1.0f,  // face_color_r
+                                                      0.9f,  // face_color_g
+                                                      0.8f); // face_color_b
 }
 
 /*
-  These vertex and face definitions are a trivial transformation of the default
-  Blender cube, as exported by the .obj exporter (with triangulation enabled).
+  The default Blender cube (cube.obj), packed by tools/obj2mesh.c: each
+  vertex is a unique (position, texture, normal) combination, and the faces are already
+  triangle strips (see mesh_format.h).
  */
-typedef struct vec3 {
-  float x;
-  float y;
-  float z;
-} vec3;
-
-typedef struct vec2 {
-  float u;
-  float v;
-} vec2;
-
-static const vec3 cube_vertex_position[] = {
-  {  1.0f,  1.0f, -1.0f },
-  {  1.0f, -1.0f, -1.0f },
-  {  1.0f,  1.0f,  1.0f },
-  {  1.0f, -1.0f,  1.0f },
-  { -1.0f,  1.0f, -1.0f },
-  { -1.0f, -1.0f, -1.0f },
-  { -1.0f,  1.0f,  1.0f },
-  { -1.0f, -1.0f,  1.0f },
+static const uint8_t cube_mesh[] __hot_rodata __attribute__((aligned(4))) = {
+  #embed "cube.mesh"
 };
 
-static const vec2 cube_vertex_texture[] = {
-  {1.0f, 0.0f},
-  {0.0f, 1.0f},
-  {0.0f, 0.0f},
-  {1.0f, 1.0f},
-};
-
-typedef struct position_texture {
-  int position;
-  int texture;
-} position_texture;
-
-typedef struct face {
-  position_texture a;
-  position_texture b;
-  position_texture c;
-} face;
+// the maximum vertex_count and triangle count of cube.mesh; checked by main
+#define CUBE_VERTEX_LENGTH 32
+#define CUBE_TRIANGLE_LENGTH 16
 
 /*
-  It is also possible to submit each cube face as a 4-vertex triangle strip, or
-  submit the entire cube as a single triangle strip.
-
-  Separate 3-vertex triangles are chosen to make this example more
-  straightforward, but this is not the best approach if high performance is
-  desired.
+  cube.mesh has one vertex per unique (position, texture, normal) combination:
+  24 vertices, but only 8 unique positions (see mesh_format.h). Each unique
+  position is transformed once per frame, and copied to every vertex that
+  shares it; lighting still uses the normal of each vertex.
  */
-static const face cube_faces[] = {
-  {{4, 0}, {2, 1}, {0, 2}},
-  {{2, 0}, {7, 1}, {3, 2}},
-  {{6, 0}, {5, 1}, {7, 2}},
-  {{1, 0}, {7, 1}, {5, 2}},
-  {{0, 0}, {3, 1}, {1, 2}},
-  {{4, 0}, {1, 1}, {5, 2}},
-  {{4, 0}, {6, 3}, {2, 1}},
-  {{2, 0}, {6, 3}, {7, 1}},
-  {{6, 0}, {4, 3}, {5, 1}},
-  {{1, 0}, {3, 3}, {7, 1}},
-  {{0, 0}, {2, 3}, {3, 1}},
-  {{4, 0}, {0, 3}, {1, 1}},
-};
-static const int cube_faces_length = (sizeof (cube_faces)) / (sizeof (cube_faces[0]));
-
-#define cos(n) __builtin_cosf(n)
-#define sin(n) __builtin_sinf(n)
+static vec3 cube_position_screen[CUBE_VERTEX_LENGTH];
 
-float theta = 0.7853981633974483f; // pi / 4
+// the screen-space vertex of each mesh vertex, once per frame (see mesh.h)
+//
+// there is room for the vertices created by near plane clipping (see clip.h)
+// after the transformed vertices
+static vec3 cube_vertex_screen[CUBE_VERTEX_LENGTH + CUBE_TRIANGLE_LENGTH * 2] __ocram0;
 
-static inline vec3 vertex_rotate(vec3 v)
-{
-  // to make the cube's appearance more interesting, rotate the vertex on two
-  // axes
-
-  float x0 = v.x;
-  float y0 = v.y;
-  float z0 = v.z;
+// the light intensity of each mesh vertex, once per frame
+static float cube_vertex_intensity[CUBE_VERTEX_LENGTH];
 
-  float x1 = x0 * cos(theta) - z0 * sin(theta);
-  float y1 = y0;
-  float z1 = x0 * sin(theta) + z0 * cos(theta);
+// the strips clipped to the near plane, and the vertices created by clipping,
+// of each frame in which the cube crosses the near plane (see clip.h); each
+// triangle becomes at most two
+static clip_vertex cube_clip_vertex[CUBE_TRIANGLE_LENGTH * 2];
+static uint16_t cube_clip_strip[CUBE_TRIANGLE_LENGTH * 4];
+static uint16_t cube_clip_strip_length[CUBE_TRIANGLE_LENGTH];
 
-  float x2 = x1;
-  float y2 = y1 * cos(theta) - z1 * sin(theta);
-  float z2 = y1 * sin(theta) + z1 * cos(theta);
+// the strips of the front-facing triangles of each frame (see cull.h)
+static uint16_t cube_visible_strip[CUBE_TRIANGLE_LENGTH * 2 * 4] __ocram0;
+static uint16_t cube_visible_strip_length[CUBE_TRIANGLE_LENGTH * 2] __ocram0;
 
-  return (vec3){x2, y2, z2};
-}
+// strip vertices submitted to the TA, summed over every frame
+uint32_t cube_vertex_count = 0;
 
-static inline vec3 vertex_perspective_divide(vec3 v)
-{
-  float w = 1.0f / (v.z + 3.0f);
-  return (vec3){v.x * w, v.y * w, w};
-}
+/*
+  A light from the upper left, behind the viewer, and a point light just in
+  front of the lower right of the cube, in view space (see light.h); only
+  the intensity of each light is used.
+ */
+static const light_scene cube_lights = {
+  .ambient_intensity = 0.25f,
+  .directional_length = 1,
+  .directional = {
+    {
+      .direction = { 0.57735027f, 0.57735027f, 0.57735027f },
+      .intensity = 0.6f,
+    },
+  },
+  .point_length = 1,
+  .point = {
+    {
+      .position = { 2.0f, 2.0f, 2.0f },
+      .range = 4.0f,
+      .intensity = 0.6f,
+    },
+  },
+};
 
-static inline vec3 vertex_screen_space(vec3 v)
-{
-  return (vec3){
-    v.x * 240.f + 320.f,
-    v.y * 240.f + 240.f,
-    v.z,
-  };
-}
+float theta __hot_data = 0.7853981633974483f; // pi / 4
 
-void transfer_ta_cube(uint32_t texture_address)
+void transfer_ta_cube(uint32_t ta_stream_mode, uint32_t texture_address)
 {
-  // set the store queue destination address to the TA Polygon Converter FIFO
-  *SH7091__CCN__QACR0 = ((ta_polygon_converter_fifo >> 24) & 0b11100);
-  *SH7091__CCN__QACR1 = ((ta_polygon_converter_fifo >> 24) & 0b11100);
-
-  uint32_t store_queue_ix = store_queue;
+  // in store queue mode, this also sets the store queue destination address to
+  // the TA Polygon Converter FIFO
+  uint32_t store_queue_ix = ta_stream_begin(ta_stream_mode);
 
   // See sh7091pm_e.pdf, printed page 79:
   //
@@ -602,122 +370,211 @@ void transfer_ta_cube(uint32_t texture_address)
 
   store_queue_ix = transfer_ta_global_polygon(store_queue_ix, texture_address);
 
-  for (int face_ix = 0; face_ix < cube_faces_length; face_ix++) {
-    int ipa = cube_faces[face_ix].a.position;
-    int ipb = cube_faces[face_ix].b.position;
-    int ipc = cube_faces[face_ix].c.position;
+  const mesh_format_header * mesh = mesh_format_header_of(cube_mesh);
+  const vec2 * texture = mesh_format_texture(mesh);
+
+  mesh_view view = mesh_view_init(theta, 240.f, 320.f, 240.f);
+
+  // nothing is transformed or submitted if the cube is entirely outside the
+  // view frustum; the (empty) list is still ended
+  cull_frustum frustum = cull_frustum_init(&view, 640.f, 480.f, MESH__NEAR_Z);
+  int strip_count = 0;
+  if (!cull_sphere(&frustum, mesh_vertex_view_space(mesh->center, &view), mesh->radius)) {
+    // transform each unique position once; the strips below only look up the
+    // transformed vertices
+    mat4 mvp = mesh_view_matrix(&view);
+    int behind = mesh_transform_xmtrx(mesh_format_unique_position(mesh), cube_position_screen,
+                                      mesh->unique_position_count, &mvp);
+    const uint16_t * position_index = mesh_format_position_index(mesh);
+    for (uint32_t i = 0; i < mesh->vertex_count; i++)
+      cube_vertex_screen[i] = cube_position_screen[position_index[i]];
+
+    light_model model = light_model_init(&cube_lights, &view);
+    light_intensity(&model,
+                    mesh_format_normal(mesh), mesh_format_position(mesh),
+                    cube_vertex_intensity, mesh->vertex_count);
+
+    const uint16_t * strip = mesh_format_strip(mesh);
+    const uint16_t * strip_length = mesh_format_strip_length(mesh);
+    int clip_strip_count = mesh->strip_count;
+    if (behind != 0) {
+      int generated_count;
+      clip_strip_count = clip_near(cube_vertex_screen, mesh->vertex_count,
+                                   cube_clip_vertex, &generated_count,
+                                   strip, strip_length, clip_strip_count,
+                                   cube_clip_strip, cube_clip_strip_length);
+      strip = cube_clip_strip;
+      strip_length = cube_clip_strip_length;
+    }
+
+    strip_count = cull_back_faces(cube_vertex_screen,
+                                  strip, strip_length, clip_strip_count,
+                                  cube_visible_strip, cube_visible_strip_length);
+  }
 
-    vec3 vpa = vertex_screen_space(
-                 vertex_perspective_divide(
-                   vertex_rotate(cube_vertex_position[ipa])));
+  // each strip vertex is a single TA vertex parameter
+  const uint16_t * strip = cube_visible_strip;
+  for (int strip_ix = 0; strip_ix < strip_count; strip_ix++) {
+    int length = cube_visible_strip_length[strip_ix];
+
+    for (int i = 0; i < length; i++) {
+      int iv = strip[i];
+      vec3 vp = cube_vertex_screen[iv];
+      vec2 vt = (iv < (int)mesh->vertex_count)
+        ? texture[iv]
+        : clip_vec2(texture, &cube_clip_vertex[iv - mesh->vertex_count]);
+      float intensity = (iv < (int)mesh->vertex_count)
+        ? cube_vertex_intensity[iv]
+        : clip_float(cube_vertex_intensity, &cube_clip_vertex[iv - mesh->vertex_count]);
+      bool end_of_strip = (i == length - 1);
+
+      store_queue_ix = transfer_ta_vertex(store_queue_ix,
+                                          vp.x, vp.y, vp.z, vt.u, vt.v, intensity,
+                                          end_of_strip);
+    }
+
+    strip += length;
+    cube_vertex_count += length;
+  }
 
-    vec3 vpb = vertex_screen_space(
-                 vertex_perspective_divide(
-                   vertex_rotate(cube_vertex_position[ipb])));
+  store_queue_ix = transfer_ta_global_end_of_list(store_queue_ix);
 
-    vec3 vpc = vertex_screen_space(
-                 vertex_perspective_divide(
-                   vertex_rotate(cube_vertex_position[ipc])));
+  ta_stream_end(store_queue_ix);
+}
 
+/*
+  A textured wall behind the cube, as a grid of quads (each a 4-vertex strip).
 
-    int ita = cube_faces[face_ix].a.texture;
-    int itb = cube_faces[face_ix].b.texture;
-    int itc = cube_faces[face_ix].c.texture;
+  The wall does not change from frame to frame: it is submitted once, as the
+  retained lists of the scheduler (see scheduler.h), and rendered under every
+  frame without being submitted again.
+ */
+#define BACKDROP_COLUMNS 4
+#define BACKDROP_ROWS 3
 
-    vec2 vta = cube_vertex_texture[ita];
-    vec2 vtb = cube_vertex_texture[itb];
-    vec2 vtc = cube_vertex_texture[itc];
+void transfer_ta_backdrop(uint32_t texture_address)
+{
+  uint32_t store_queue_ix = ta_stream_begin(TA_STREAM__STORE_QUEUE);
 
-    // vertex color is irrelevant in "decal" mode
-    uint32_t va_color = 0;
-    uint32_t vb_color = 0;
-    uint32_t vc_color = 0;
+  store_queue_ix = transfer_ta_global_polygon(store_queue_ix, texture_address);
 
-    store_queue_ix = transfer_ta_vertex_triangle(store_queue_ix,
-                                                 vpa.x, vpa.y, vpa.z, vta.u, vta.v, va_color,
-                                                 vpb.x, vpb.y, vpb.z, vtb.u, vtb.v, vb_color,
-                                                 vpc.x, vpc.y, vpc.z, vtc.u, vtc.v, vc_color);
+  // behind anything the cube can be drawn at, and dimmer than the cube
+  const float z = 0.001f;
+  const float intensity = 0.5f;
+  const float width = 640.0f / BACKDROP_COLUMNS;
+  const float height = 480.0f / BACKDROP_ROWS;
+
+  for (int row = 0; row < BACKDROP_ROWS; row++) {
+    for (int column = 0; column < BACKDROP_COLUMNS; column++) {
+      const float x0 = width * (float)column;
+      const float y0 = height * (float)row;
+
+      store_queue_ix = transfer_ta_vertex(store_queue_ix, x0,         y0 + height, z, 0.0f, 1.0f, intensity, false);
+      store_queue_ix = transfer_ta_vertex(store_queue_ix, x0,         y0,          z, 0.0f, 0.0f, intensity, false);
+      store_queue_ix = transfer_ta_vertex(store_queue_ix, x0 + width, y0 + height, z, 1.0f, 1.0f, intensity, false);
+      store_queue_ix = transfer_ta_vertex(store_queue_ix, x0 + width, y0,          z, 1.0f, 0.0f, intensity, true);
+    }
   }
 
   store_queue_ix = transfer_ta_global_end_of_list(store_queue_ix);
-}
 
-/******************************************************************************
- Holly register definitions
- ******************************************************************************/
+  ta_stream_end(store_queue_ix);
+}
 
-volatile uint32_t * SOFTRESET     = (volatile uint32_t *)(0xa05f8000 + 0x08);
-volatile uint32_t * STARTRENDER   = (volatile uint32_t *)(0xa05f8000 + 0x14);
-volatile uint32_t * PARAM_BASE    = (volatile uint32_t *)(0xa05f8000 + 0x20);
-volatile uint32_t * REGION_BASE   = (volatile uint32_t *)(0xa05f8000 + 0x2c);
-volatile uint32_t * FB_R_SOF1     = (volatile uint32_t *)(0xa05f8000 + 0x50);
-volatile uint32_t * FB_W_SOF1     = (volatile uint32_t *)(0xa05f8000 + 0x60);
-volatile uint32_t * ISP_BACKGND_T = (volatile uint32_t *)(0xa05f8000 + 0x8c);
-
-volatile uint32_t * SPG_STATUS = (volatile uint32_t *)(0xa05f8000 + 0x10c);
-
-#define SPG_STATUS__VSYNC (1 << 13)
-
-volatile uint32_t * TA_OL_BASE        = (volatile uint32_t *)(0xa05f8000 + 0x124);
-volatile uint32_t * TA_ISP_BASE       = (volatile uint32_t *)(0xa05f8000 + 0x128);
-volatile uint32_t * TA_OL_LIMIT       = (volatile uint32_t *)(0xa05f8000 + 0x12c);
-volatile uint32_t * TA_ISP_LIMIT      = (volatile uint32_t *)(0xa05f8000 + 0x130);
-volatile uint32_t * TA_GLOB_TILE_CLIP = (volatile uint32_t *)(0xa05f8000 + 0x13c);
-volatile uint32_t * TA_ALLOC_CTRL     = (volatile uint32_t *)(0xa05f8000 + 0x140);
-volatile uint32_t * TA_LIST_INIT      = (volatile uint32_t *)(0xa05f8000 + 0x144);
-
-#define TA_GLOB_TILE_CLIP__TILE_Y_NUM(n) (((n) & 0xf) << 16)
-#define TA_GLOB_TILE_CLIP__TILE_X_NUM(n) (((n) & 0x1f) << 0)
-#define TA_ALLOC_CTRL__OPB_MODE__INCREASING_ADDRESSES (0 << 20)
-#define TA_ALLOC_CTRL__O_OPB__8X4BYTE (1 << 0)
-#define TA_LIST_INIT__LIST_INIT (1 << 31)
-
-const uint8_t texture[] __attribute__((aligned(4))) = {
+const uint8_t texture[] __attribute__((aligned(32))) = {
   #embed "pavement_256x256.rgb565"
 };
 
 void transfer_texture(uint32_t texture_start)
 {
-  // use 4-byte transfers to texture memory, for slightly increased transfer
-  // speed
-  //
-  // It would be even faster to use the SH4 store queue for this operation, or
-  // SH4 DMA.
-
-  const uint32_t * texture4 = (const uint32_t *)texture;
+  // use the SH4 store queues for the transfer to texture memory; each 32-byte
+  // block is a single burst, rather than eight separate 4-byte transfers. See
+  // sq.h.
 
-  for (int i = 0; i < (sizeof (texture)) / 4; i++) {
-    // Holly samples texture images from "64-bit" texture memory address space
-    *((volatile uint32_t *)(texture_memory64 + texture_start + i * 4)) = texture4[i];
-  }
+  // Holly samples texture images from "64-bit" texture memory address space
+  sq_copy(texture_memory64 + texture_start, texture, (sizeof (texture)));
 }
 
 void main()
 {
-  /*
-    a very simple memory map:
+  scif_init();
+  tmu_init();
 
-    the ordering within texture memory is not significant, and could be
-    anything
+  /*
+    the memory map: two "frame sets" (see scheduler.h), the retained backdrop,
+    three framebuffers (see display.h) and the texture, placed by vram.h
   */
 
-  // all of the following are addresses in "32-bit" texture memory address
-  // space:
-  uint32_t framebuffer_start       = 0x200000; // intentionally the same address that the boot rom used to draw the SEGA logo
-  uint32_t isp_tsp_parameter_start = 0x400000;
-  uint32_t region_array_start      = 0x500000;
-  uint32_t object_list_start       = 0x100000;
-  uint32_t opaque_list_pointer     = object_list_start;
+  // the region arrays have two entries per tile (see region_array.h)
+  const uint32_t region_array_size = (sizeof (region_array_entry)) * 2 * (640 / 32) * (480 / 32);
+  const uint32_t framebuffer_size = 640 * 480 * 2;
+
+  vram vram;
+  vram_init(&vram);
+
+  // the boot rom framebuffer is displayed until the first frame is complete;
+  // it is reserved before anything else is placed
+  const uint32_t boot_framebuffer_start = 0x200000; // intentionally the same address that the boot rom used to draw the SEGA logo
+  vram_reserve32(&vram, "boot rom framebuffer", boot_framebuffer_start, framebuffer_size);
+
+  const uint32_t framebuffer_start[3] = {
+    vram_alloc32(&vram, "framebuffer", framebuffer_size, 32, VRAM__BANK_ANY),
+    vram_alloc32(&vram, "framebuffer", framebuffer_size, 32, VRAM__BANK_ANY),
+    boot_framebuffer_start,
+  };
+
+  // the backdrop, built once by the TA (see scheduler.h); its ISP/TSP
+  // parameters are in the ISP/TSP parameter area of each frame set
+  scheduler_retained backdrop = {
+    .object_list_start        = vram_alloc32(&vram, "backdrop object list", 0x20000, 32, VRAM__BANK_0),
+    .object_list_size         = 0x20000,
+    // after the background parameter, rounded up to 32 bytes
+    .isp_tsp_parameter_offset = ((sizeof (isp_tsp_parameter__polygon)) + 31) & ~31,
+    .isp_tsp_parameter_size   = 0x8000,
+  };
+
+  scheduler scheduler = {
+    // the TA stores the ISP/TSP parameters of each frame after the background
+    // parameter and the retained (backdrop) ISP/TSP parameters
+    .isp_tsp_parameter_offset = backdrop.isp_tsp_parameter_offset + backdrop.isp_tsp_parameter_size,
+  };
 
-  // these addresses are in "64-bit" texture memory address space:
-  uint32_t texture_start           = 0x700000;
+  // the TA writes the object lists and ISP/TSP parameters of a frame set
+  // together, and CORE reads them together; they are in opposite banks. All of
+  // the following are addresses in "32-bit" texture memory address space.
+  for (int i = 0; i < SCHEDULER__FRAME_SETS; i++) {
+    frame_set * set = &scheduler.set[i];
+    set->object_list_start       = vram_alloc32(&vram, "object list", SCHEDULER__OBJECT_LIST_SIZE, 32, VRAM__BANK_0);
+    set->isp_tsp_parameter_start = vram_alloc32(&vram, "ISP/TSP parameters", SCHEDULER__ISP_TSP_PARAMETER_SIZE, 0x100000, VRAM__BANK_1);
+    set->region_array_start      = vram_alloc32(&vram, "region array", region_array_size, 32, VRAM__BANK_ANY);
+  }
+
+  // this address is in "64-bit" texture memory address space
+  uint32_t texture_start = vram_alloc64(&vram, "texture", (sizeof (texture)), 32);
+
+  if (vram.failed != 0) {
+    scif_label_base10("texture memory allocations failed", vram.failed);
+    scif_flush();
+    return;
+  }
 
   // background_offset is relative to the beginning of isp_tsp_parameter_start
   uint32_t background_offset     = (sizeof (isp_tsp_parameter__polygon)) * 0;
 
-  transfer_region_array(region_array_start, opaque_list_pointer);
+  // only the opaque list is used; see ta_alloc.h. These are the OPB sizes of
+  // the first frame; the scheduler adapts them to the scene.
+  const int tile_y_num = 480 / 32;
+  const int tile_x_num = 640 / 32;
+  const uint32_t opb_words[TA_ALLOC__LIST_COUNT] = {
+    [TA_ALLOC__OPAQUE] = TA_ALLOC__OPB_8,
+  };
+  ta_alloc alloc = ta_alloc_init(tile_x_num, tile_y_num, opb_words);
+  backdrop.alloc = ta_alloc_init(tile_x_num, tile_y_num, opb_words);
 
-  transfer_isp_tsp_background_parameter(isp_tsp_parameter_start);
+  // the region array of each frame set is written by scheduler_init
+  for (int i = 0; i < SCHEDULER__FRAME_SETS; i++) {
+    transfer_isp_tsp_background_parameter(scheduler.set[i].isp_tsp_parameter_start);
+  }
 
   //////////////////////////////////////////////////////////////////////////////
   // transfer the texture image to texture ram
@@ -729,9 +586,6 @@ void main()
   // configure the TA
   //////////////////////////////////////////////////////////////////////////////
 
-  const int tile_y_num = 480 / 32;
-  const int tile_x_num = 640 / 32;
-
   // TA_GLOB_TILE_CLIP restricts which "object pointer blocks" are written
   // to.
   //
@@ -741,47 +595,36 @@ void main()
   // within a single TA initialization to produce an identical effect.
   //
   // See DCDBSysArc990907E.pdf page 183.
-  *TA_GLOB_TILE_CLIP = TA_GLOB_TILE_CLIP__TILE_Y_NUM(tile_y_num - 1)
-                     | TA_GLOB_TILE_CLIP__TILE_X_NUM(tile_x_num - 1);
+  *TA_GLOB_TILE_CLIP = ta_alloc_glob_tile_clip(&alloc);
 
   // While CORE supports arbitrary-length object lists, the TA uses "object
   // pointer blocks" as a memory allocation strategy. These fixed-length blocks
   // can still have infinite length via "object pointer block links". This
-  // mechanism is illustrated in DCDBSysArc990907E.pdf page 188.
-  *TA_ALLOC_CTRL = TA_ALLOC_CTRL__OPB_MODE__INCREASING_ADDRESSES
-                 | TA_ALLOC_CTRL__O_OPB__8X4BYTE;
+  // mechanism is illustrated in DCDBSysArc990907E.pdf page 188. Each list type
+  // has its own object pointer block size, set per frame (TA_ALLOC_CTRL) by
+  // scheduler_ta_begin.
 
   // While building object lists, the TA contains an internal index (exposed as
   // the read-only TA_ITP_CURRENT) for the next address that new ISP/TSP will be
   // stored at. The initial value of this index is TA_ISP_BASE.
-  *TA_ISP_BASE = isp_tsp_parameter_start + (sizeof (isp_tsp_parameter__polygon)) * 1;
-  *TA_ISP_LIMIT = isp_tsp_parameter_start + 0x100000;
-
+  //
   // Similarly, the TA also contains, for up to 600 tiles, an internal index for
   // the next address that an object list entry will be stored for each
   // tile. These internal indicies are partially exposed via the read-only
   // TA_OL_POINTERS.
-  *TA_OL_BASE = object_list_start;
-
-  // TA_OL_LIMIT, DCDBSysArc990907E.pdf page 385:
   //
-  // >   Because the TA may automatically store data in the address that is
-  // >   specified by this register, it must not be used for other data.  For
-  // >   example, the address specified here must not be the same as the address
-  // >   in the TA_ISP_BASE register.
-  *TA_OL_LIMIT = object_list_start + 0x100000 - 32;
+  // TA_ISP_BASE, TA_ISP_LIMIT, TA_OL_BASE, TA_OL_LIMIT and TA_NEXT_OPB_INIT are
+  // set per frame by scheduler_ta_begin.
 
   //////////////////////////////////////////////////////////////////////////////
   // configure CORE
   //////////////////////////////////////////////////////////////////////////////
 
-  // REGION_BASE is the (texture memory-relative) address of the region array.
-  *REGION_BASE = region_array_start;
-
-  // PARAM_BASE is the (texture memory-relative) address of ISP/TSP parameters.
-  // Anything that references an ISP/TSP parameter does so relative to this
-  // address (and not relative to the beginning of texture memory).
-  *PARAM_BASE = isp_tsp_parameter_start;
+  // REGION_BASE is the (texture memory-relative) address of the region array,
+  // PARAM_BASE is the (texture memory-relative) address of ISP/TSP parameters,
+  // and FB_W_SOF1 is the (texture memory-relative) address of the framebuffer
+  // that will be written to when a tile is rendered/flushed. All three are set
+  // per frame by scheduler_ta_end.
 
   // Set the offset of the background ISP/TSP parameter, relative to PARAM_BASE
   // SKIP is related to the size of each vertex
@@ -789,50 +632,124 @@ void main()
                  | ISP_BACKGND_T__TAG_OFFSET(0)
                  | ISP_BACKGND_T__SKIP(1);
 
-  // FB_W_SOF1 is the (texture memory-relative) address of the framebuffer that
-  // will be written to when a tile is rendered/flushed.
-  *FB_W_SOF1 = framebuffer_start;
-
-  // without waiting for rendering to actually complete, immediately display the
-  // framebuffer.
-  *FB_R_SOF1 = framebuffer_start;
-
   //////////////////////////////////////////////////////////////////////////////
   // animated drawing
   //////////////////////////////////////////////////////////////////////////////
 
+  // the scheduler and CH2-DMA (ta_stream.h) wait for these events and TA
+  // errors; with the interrupts enabled, waiting does not poll ISTNRM or
+  // ISTERR
+  interrupt_init(SCHEDULER__INTERRUPTS | ISTNRM__END_OF_DMA_CH2_DMA, SCHEDULER__TA_ERRORS);
+
+  // triple buffering: the boot rom framebuffer (the last in the ring) continues
+  // to be displayed until the first frame is complete
+  display_init(framebuffer_start, 3);
+
+  scheduler_init(&scheduler, &alloc);
+
+  // the backdrop is the only geometry submitted outside of the frame loop
+  scheduler_retain_begin(&scheduler, &backdrop);
+  transfer_ta_backdrop(texture_start);
+  ta_stream_wait();
+  if (!scheduler_retain_end(&scheduler, &backdrop, ta_alloc_list_end_events(&backdrop.alloc))) {
+    scif_string("backdrop: TA error; the backdrop is not rendered\n");
+  }
+
+  const mesh_format_header * mesh = mesh_format_header_of(cube_mesh);
+  if (mesh->magic != MESH_FORMAT__MAGIC
+      || mesh->version != MESH_FORMAT__VERSION
+      || mesh->vertex_count > CUBE_VERTEX_LENGTH
+      || mesh->unique_position_count > CUBE_VERTEX_LENGTH
+      || mesh->strip_vertex_count - 2 * mesh->strip_count > CUBE_TRIANGLE_LENGTH) {
+    scif_label_base10("invalid cube.mesh; vertex count", mesh->vertex_count);
+    scif_flush();
+    return;
+  }
+
+  // CPU time spent submitting each frame (TA_LIST_INIT through the hand-off of
+  // the last TA parameter), in TMU ticks. Comparing a CACHED=0 build with a
+  // CACHED=1 build shows the effect of the SH4 caches on the per-frame CPU
+  // work.
+  //
+  // The first half of the frames are submitted with the store queue, the
+  // second half with CH2-DMA (see ta_stream.h).
+  uint32_t frame_ticks[2] = {0, 0};
+  // TA parameter bytes submitted, summed over every frame
+  uint32_t ta_bytes = 0;
+  const int frame_count = 500;
+
+  uint32_t total_start = tmu_ticks();
+
   // draw 500 frames of cube rotation
-  for (int i = 0; i < 500; i++) {
+  for (int i = 0; i < frame_count; i++) {
+    uint32_t ta_stream_mode = (i < frame_count / 2) ? TA_STREAM__STORE_QUEUE : TA_STREAM__DMA;
+
     //////////////////////////////////////////////////////////////////////////////
     // transfer cube to texture memory via the TA polygon converter FIFO
     //////////////////////////////////////////////////////////////////////////////
 
-    // TA_LIST_INIT needs to be written (every frame) prior to the first FIFO
-    // write.
-    *TA_LIST_INIT = TA_LIST_INIT__LIST_INIT;
+    // the TA builds this frame while CORE is still rendering the previous
+    // frame. If the TA overflows the object list or ISP/TSP parameter budget
+    // of the frame set, the frame is built again.
+    int result;
+    do {
+      uint32_t frame_start = tmu_ticks();
 
-    // dummy TA_LIST_INIT read; DCDBSysArc990907E.pdf in multiple places says this
-    // step is required.
-    (void)*TA_LIST_INIT;
+      scheduler_ta_begin(&scheduler);
 
-    transfer_ta_cube(texture_start);
+      transfer_ta_cube(ta_stream_mode, texture_start);
 
-    //////////////////////////////////////////////////////////////////////////////
-    // start the actual rasterization
-    //////////////////////////////////////////////////////////////////////////////
+      frame_ticks[ta_stream_mode] += tmu_ticks() - frame_start;
+      ta_bytes += ta_stream_state.bytes;
 
-    // start the actual render--the rendering process begins by interpreting the
-    // region array
-    *STARTRENDER = 1;
+      //////////////////////////////////////////////////////////////////////////////
+      // start the actual rasterization
+      //////////////////////////////////////////////////////////////////////////////
 
-    // wait for vertical synchronization
-    while (!((*SPG_STATUS) & SPG_STATUS__VSYNC));
-    while (((*SPG_STATUS) & SPG_STATUS__VSYNC));
+      // wait for the TA to receive every parameter, and to finish building the
+      // opaque object list. scheduler_ta_end then waits for the previous frame
+      // to finish rendering (it is displayed from the next vertical blank), and
+      // starts rendering this frame.
+      ta_stream_wait();
+      result = scheduler_ta_end(&scheduler, ta_alloc_list_end_events(&alloc));
+    } while (result == SCHEDULER__RETRY);
 
     // increment theta for the cube rotation animation
-    // (used by the `vertex_rotate` function)
+    // (see mesh_view_init)
     theta += 0.01f;
   }
 
+  scheduler_finish(&scheduler);
+
+  const float seconds = tmu_ticks_to_seconds(tmu_ticks() - total_start);
+
+  scif_label_base10("cached", CACHED);
+  scif_label_base10("store queue frame time (average, us)", tmu_ticks_to_us(frame_ticks[TA_STREAM__STORE_QUEUE] / (frame_count / 2)));
+  scif_label_base10("CH2-DMA frame time (average, us)", tmu_ticks_to_us(frame_ticks[TA_STREAM__DMA] / (frame_count / 2)));
+  scif_label_base10("frames per second", (uint32_t)((float)frame_count / seconds));
+  scif_label_base10("repeated display refreshes", display_state.repeated);
+  scif_label_base10("transforms per frame", mesh_transform_count / frame_count);
+  scif_label_base10("vertices per second", (uint32_t)((float)cube_vertex_count / seconds));
+  scif_label_base10("TA bytes per frame", ta_bytes / frame_count);
+  scif_label_base10("back-facing triangles culled per frame", cull_state.triangles_back_facing / frame_count);
+  scif_label_base10("frames culled by the view frustum", cull_state.objects_outside);
+  scif_label_base10("triangles clipped to the near plane", clip_state.triangles_clipped);
+  scif_label_base10("frames retried after a TA overflow", scheduler.frames_retried);
+  scif_label_base10("frames dropped", scheduler.frames_dropped);
+  scif_label_base10("object list peak (bytes)", scheduler.object_list_peak);
+  scif_label_base10("ISP/TSP parameter peak (bytes)", scheduler.isp_tsp_parameter_peak);
+  scif_label_base10("opaque OPB size (words)", scheduler.adaptive.opb_words[TA_ALLOC__OPAQUE]);
+  scif_label_base10("retained object list (bytes)", backdrop.object_list_used);
+  scif_label_base10("retained ISP/TSP parameters (bytes)", backdrop.isp_tsp_parameter_used);
+  for (int bank = 0; bank < 2; bank++) {
+    vram_bank_stats stats = vram_stats(&vram, bank);
+    scif_label_base10("texture memory bank", bank);
+    scif_label_base10("  peak use (bytes)", stats.peak);
+    scif_label_base10("  free blocks", stats.free_blocks);
+    scif_label_base10("  largest free block (bytes)", stats.largest_free);
+    scif_label_base10("  fragmentation (per mille)", stats.fragmentation_permille);
+  }
+  scif_flush();
+
   // return from main; this will effectively jump back to the serial loader
 }
@@ -0,0 +1,174 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "matrix.h"
+#include "mesh.h"
+#include "vec.h"
+
+/*
+  CPU-side culling between transform and TA submission
+
+  Every parameter sent to the TA costs FIFO bandwidth and TA binning time,
+  even when ISP culling would later discard the triangle. Two culling stages
+  run on the CPU instead:
+
+  - cull_sphere rejects a whole object whose bounding sphere is entirely
+    outside the view frustum, before any of its vertices are transformed
+
+  - cull_back_faces tests the screen-space winding of every triangle of a set
+    of strips (mesh_transform output, see mesh.h), and writes the strips of
+    the front-facing triangles only
+
+  A triangle is front-facing if it is wound counter-clockwise on screen (x
+  right, y down); the meshes in this repository are counter-clockwise when
+  viewed from outside, and mesh_view does not flip y.
+
+  cull_back_faces splits a strip wherever a triangle is culled. A new strip
+  that starts at an odd triangle of the original strip begins with its first
+  vertex repeated: the resulting degenerate triangle keeps every following
+  triangle at its original position (odd or even) in the strip, so the
+  winding the TA sees is unchanged, at the cost of one vertex parameter.
+
+  Counters are accumulated in `cull_state`; the caller resets them as needed.
+ */
+
+typedef struct cull_counters {
+  // triangles tested by cull_back_faces, and those culled as back-facing
+  // (zero-area triangles are dropped, but not counted)
+  uint32_t triangles_tested;
+  uint32_t triangles_back_facing;
+
+  // objects tested by cull_sphere, and those outside the frustum
+  uint32_t objects_tested;
+  uint32_t objects_outside;
+} cull_counters;
+
+cull_counters cull_state;
+
+/*
+  The view frustum, as planes in view space (see mesh_vertex_view_space); a
+  point p is inside plane (a, b, c, d) if a·x + b·y + c·z + d ≥ 0. Every plane
+  normal has unit length.
+ */
+typedef struct cull_frustum {
+  vec4 plane[5];
+} cull_frustum;
+
+static inline vec4 cull_plane_normalize(float a, float b, float c, float d)
+{
+  float rn = fsrra(a * a + b * b + c * c);
+  return (vec4){a * rn, b * rn, c * rn, d * rn};
+}
+
+/*
+  The frustum of the screen-space mapping of `view`: screen x in [0, width],
+  y in [0, height], and view space z ≥ near.
+ */
+static inline cull_frustum cull_frustum_init(const mesh_view * view, float width, float height, float near)
+{
+  float s = view->scale;
+  float cx = view->center_x;
+  float cy = view->center_y;
+
+  // screen x = s·x/z + cx ≥ 0  ⟺  s·x + cx·z ≥ 0 (for z > 0), and similarly
+  // for the other edges
+  return (cull_frustum){{
+    cull_plane_normalize( s,  0, cx,          0),
+    cull_plane_normalize(-s,  0, width - cx,  0),
+    cull_plane_normalize( 0,  s, cy,          0),
+    cull_plane_normalize( 0, -s, height - cy, 0),
+    cull_plane_normalize( 0,  0, 1,           -near),
+  }};
+}
+
+/*
+  Returns true if the sphere (`center` in view space) is entirely outside
+  the frustum.
+ */
+static inline bool cull_sphere(const cull_frustum * frustum, vec3 center, float radius)
+{
+  cull_state.objects_tested += 1;
+
+  for (int i = 0; i < 5; i++) {
+    const vec4 * p = &frustum->plane[i];
+    float distance = fipr(p->x, p->y, p->z, p->w,
+                          center.x, center.y, center.z, 1.0f);
+    if (distance < -radius) {
+      cull_state.objects_outside += 1;
+      return true;
+    }
+  }
+  return false;
+}
+
+/*
+  Twice the signed screen-space area of (a, b, c); positive if clockwise on
+  screen (y down).
+ */
+static inline float cull_signed_area(vec3 a, vec3 b, vec3 c)
+{
+  return (b.x - a.x) * (c.y - a.y) - (b.y - a.y) * (c.x - a.x);
+}
+
+/*
+  Write the front-facing triangles of `strip_count` strips (`strip`,
+  `strip_length`, as in mesh_format.h) as strips to `out_strip` and
+  `out_strip_length`; `screen` is the transformed vertex of each index.
+
+  `out_strip` must have room for 4 indices per input triangle, and
+  `out_strip_length` for 1 entry per input triangle.
+
+  Returns the number of output strips.
+ */
+int cull_back_faces(const vec3 * screen,
+                    const uint16_t * strip, const uint16_t * strip_length, int strip_count,
+                    uint16_t * out_strip, uint16_t * out_strip_length)
+{
+  int out_count = 0;
+  uint16_t * out = out_strip;
+
+  for (int strip_ix = 0; strip_ix < strip_count; strip_ix++) {
+    int length = strip_length[strip_ix];
+    // the length of the strip currently being written; 0 if none
+    int run = 0;
+
+    for (int t = 0; t < length - 2; t++) {
+      bool odd = (t & 1) != 0;
+      float area = cull_signed_area(screen[strip[t]], screen[strip[t + 1]], screen[strip[t + 2]]);
+      bool front = odd ? (area > 0.0f) : (area < 0.0f);
+
+      if (!front) {
+        if (run != 0) {
+          out_strip_length[out_count++] = run;
+          out += run;
+          run = 0;
+        }
+        // degenerate triangles (strip restarts, and those created by
+        // clipping) are dropped too, but are not back-facing
+        if (area != 0.0f)
+          cull_state.triangles_back_facing += 1;
+        continue;
+      }
+
+      if (run == 0) {
+        if (odd)
+          out[run++] = strip[t];
+        out[run++] = strip[t];
+        out[run++] = strip[t + 1];
+      }
+      out[run++] = strip[t + 2];
+    }
+
+    if (run != 0) {
+      out_strip_length[out_count++] = run;
+      out += run;
+    }
+
+    cull_state.triangles_tested += length - 2;
+    strip += length;
+  }
+
+  return out_count;
+}
@@ -0,0 +1,136 @@
+#pragma once
+
+#include <stdint.h>
+
+#include "holly.h"
+#include "interrupt.h"
+
+/*
+  Double/triple-buffered display
+
+  Two or three framebuffers are used in round-robin order. Each render is
+  started into the next framebuffer in the ring (display_render_begin); when
+  CORE signals the end of the render, that framebuffer is queued, and the next
+  vertical blank interrupt displays it via FB_R_SOF1. At most one queued frame
+  is displayed per vertical blank, so every rendered frame is displayed for at
+  least one field, in order.
+
+  A framebuffer is only rendered to once neither it nor a frame queued
+  before it is displayed:
+
+  - with two framebuffers, a render can not start until the previous frame has
+    been displayed (the CPU and CORE may wait for a vertical blank)
+
+  - with three framebuffers, a render can start as soon as the frame before
+    the previous one has been displayed; CORE need not wait for vertical
+    blank as long as it renders faster than the display refresh rate
+
+  Display state is only modified by the interrupt callbacks, so the
+  interrupts in DISPLAY__INTERRUPTS must be enabled by interrupt_init before
+  display_init is called.
+ */
+
+#define DISPLAY__MAX_FRAMEBUFFERS 3
+
+#define DISPLAY__INTERRUPTS (ISTNRM__END_OF_RENDER_TSP | ISTNRM__V_BLANK_IN)
+
+typedef struct display {
+  // addresses in "32-bit" texture memory address space
+  uint32_t framebuffer_start[DISPLAY__MAX_FRAMEBUFFERS];
+  uint32_t framebuffer_count;
+
+  // the ring index of the framebuffer of the next render, and of the next frame
+  // to be displayed
+  uint32_t render_index;
+  volatile uint32_t display_index;
+
+  // the number of renders started, completed and displayed; these only ever
+  // increase, and `started - displayed` is the number of frames in flight
+  volatile uint32_t started;
+  volatile uint32_t completed;
+  volatile uint32_t displayed;
+
+  // vertical blanks with a frame in flight, but no completed frame to display;
+  // each one is a display refresh that repeated the previous frame
+  volatile uint32_t repeated;
+} display;
+
+display display_state;
+
+static inline uint32_t display_next_index(uint32_t index)
+{
+  index += 1;
+  return (index == display_state.framebuffer_count) ? 0 : index;
+}
+
+void display_render_end_callback()
+{
+  display_state.completed += 1;
+}
+
+void display_v_blank_in_callback()
+{
+  if (display_state.completed != display_state.displayed) {
+    *FB_R_SOF1 = display_state.framebuffer_start[display_state.display_index];
+    display_state.display_index = display_next_index(display_state.display_index);
+    display_state.displayed += 1;
+  } else if (display_state.started != display_state.displayed) {
+    display_state.repeated += 1;
+  }
+}
+
+/*
+  The first render uses framebuffer_start[0]. The current FB_R_SOF1 continues
+  to be displayed until the first frame is complete, so it is safe for
+  framebuffer_start[count - 1] to be the framebuffer that is currently being
+  displayed.
+ */
+void display_init(const uint32_t * framebuffer_start, uint32_t count)
+{
+  for (uint32_t i = 0; i < count; i++)
+    display_state.framebuffer_start[i] = framebuffer_start[i];
+  display_state.framebuffer_count = count;
+
+  display_state.render_index = 0;
+  display_state.display_index = 0;
+  display_state.started = 0;
+  display_state.completed = 0;
+  display_state.displayed = 0;
+  display_state.repeated = 0;
+
+  interrupt_set_callback(ISTNRM__END_OF_RENDER_TSP, display_render_end_callback);
+  interrupt_set_callback(ISTNRM__V_BLANK_IN, display_v_blank_in_callback);
+}
+
+static inline uint32_t display_frames_in_flight()
+{
+  return display_state.started - display_state.displayed;
+}
+
+/*
+  Wait until the next framebuffer in the ring is neither displayed nor queued
+  for display, and set FB_W_SOF1 to it. The caller writes STARTRENDER, and
+  must not start a render while a previous render is still in progress.
+
+  Returns the framebuffer address.
+ */
+uint32_t display_render_begin()
+{
+  while (display_frames_in_flight() > display_state.framebuffer_count - 2);
+
+  uint32_t framebuffer_start = display_state.framebuffer_start[display_state.render_index];
+  display_state.render_index = display_next_index(display_state.render_index);
+  display_state.started += 1;
+
+  *FB_W_SOF1 = framebuffer_start;
+
+  return framebuffer_start;
+}
+
+/*
+  Wait for every started frame to be displayed.
+ */
+void display_finish()
+{
+  while (display_frames_in_flight() != 0);
+}
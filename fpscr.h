@@ -0,0 +1,89 @@
+#pragma once
+
+#include <stdint.h>
+
+/*
+  SH4 FPSCR (floating point status/control register)
+
+  start.s initializes FPSCR to FPSCR__DN | FPSCR__RM__ROUND_TO_NEAREST: single
+  precision, 32-bit fmov transfers, front register bank, denormals flushed to
+  zero, and no FPU exceptions enabled. This is the state that gcc assumes for
+  -m4-single-only code.
+
+  FPSCR.SZ = 1 changes every `fmov` instruction into a 64-bit register pair
+  (DRn/XDn) transfer. A 64-bit fmov moves 8 bytes per instruction, which makes
+  it the fastest way for the SH4 to copy data, particularly into the store
+  queues or to texture memory.
+
+  gcc does not know about FPSCR.SZ, and any compiler-generated floating point
+  code that runs while SZ = 1 will silently transfer the wrong amount of data.
+  For this reason, SZ must only be set and cleared inside the *same* asm
+  statement that uses 64-bit fmov, as in:
+
+    asm volatile (
+      FPSCR_SZ_BEGIN
+      "fmov @%0+,dr0\n"
+      ...
+      FPSCR_SZ_END
+      ...
+    );
+
+  fmov_copy32 below is an example of this.
+
+  See sh7091pm_e.pdf printed page 147-150 and 158.
+ */
+
+#define FPSCR__FR (1 << 21)
+#define FPSCR__SZ (1 << 20)
+#define FPSCR__PR (1 << 19)
+#define FPSCR__DN (1 << 18)
+#define FPSCR__RM__ROUND_TO_NEAREST (0b00 << 0)
+#define FPSCR__RM__ROUND_TO_ZERO (0b01 << 0)
+
+// `fschg` inverts FPSCR.SZ
+#define FPSCR_SZ_BEGIN "fschg\n"
+#define FPSCR_SZ_END "fschg\n"
+
+static inline uint32_t fpscr_get()
+{
+  uint32_t value;
+  asm volatile ("sts fpscr,%0" : "=r" (value) : : "memory");
+  return value;
+}
+
+static inline void fpscr_set(uint32_t value)
+{
+  asm volatile ("lds %0,fpscr" : : "r" (value) : "memory");
+}
+
+/*
+  Copy `blocks` 32-byte blocks from `src` to `dst` with 64-bit fmov.
+
+  `src` and `dst` must both be 8-byte aligned.
+ */
+static inline void fmov_copy32(void * dst, const void * src, uint32_t blocks)
+{
+  if (blocks == 0)
+    return;
+
+  asm volatile (
+    FPSCR_SZ_BEGIN
+    "1:\n"
+    "fmov @%[src]+,dr0\n"
+    "fmov @%[src]+,dr2\n"
+    "fmov @%[src]+,dr4\n"
+    "fmov @%[src]+,dr6\n"
+    "add #32,%[dst]\n"
+    "fmov dr6,@-%[dst]\n"
+    "fmov dr4,@-%[dst]\n"
+    "fmov dr2,@-%[dst]\n"
+    "fmov dr0,@-%[dst]\n"
+    "dt %[blocks]\n"
+    "bf.s 1b\n"
+    "add #32,%[dst]\n"
+    FPSCR_SZ_END
+    : [dst] "+r" (dst), [src] "+r" (src), [blocks] "+r" (blocks)
+    :
+    : "fr0", "fr1", "fr2", "fr3", "fr4", "fr5", "fr6", "fr7", "t", "memory"
+  );
+}
@@ -1,5 +1,7 @@
 #include <stdint.h>
 
+#include "sq.h"
+
 volatile uint32_t * SCFSR2 = (volatile uint32_t *)0xffe80010;
 volatile uint32_t * SCFTDR2 = (volatile uint32_t *)0xffe8000c;
 
@@ -18,12 +20,12 @@ void main()
   character('m');
   character('\n');
 
-  volatile uint32_t * texture_memory32 = (volatile uint32_t *)(0x05000000 | 0xA0000000);
+  uint32_t texture_memory32 = (0x05000000 | 0xA0000000);
 
+  // fill the framebuffer with store queue bursts (32 bytes per bus
+  // transaction); see sq.h
   int blue = 0x0000ff;
-  for (int i = 0; i < 640 * 480; i++) {
-    texture_memory32[i] = blue;
-  }
+  sq_fill(texture_memory32, blue, 640 * 480 * 4);
 
   volatile uint32_t * FB_R_CTRL = (volatile uint32_t*)(0x005F8044 | 0xA0000000);
 
@@ -0,0 +1,123 @@
+#pragma once
+
+#include <stdint.h>
+
+/*
+  Holly register definitions that are shared by more than one module.
+
+  Register addresses are from DCDBSysArc990907E.pdf.
+ */
+
+/******************************************************************************
+ System bus
+ ******************************************************************************/
+
+volatile uint32_t * SB_C2DSTAT = (volatile uint32_t *)(0xa05f6800 + 0x00);
+volatile uint32_t * SB_C2DLEN  = (volatile uint32_t *)(0xa05f6800 + 0x04);
+volatile uint32_t * SB_C2DST   = (volatile uint32_t *)(0xa05f6800 + 0x08);
+volatile uint32_t * SB_LMMODE0 = (volatile uint32_t *)(0xa05f6800 + 0x84);
+volatile uint32_t * SB_LMMODE1 = (volatile uint32_t *)(0xa05f6800 + 0x88);
+
+#define SB_LMMODE__64BIT (0 << 0)
+#define SB_LMMODE__32BIT (1 << 0)
+
+/*
+  Normal and error interrupt status; each bit is cleared by writing 1 to it.
+
+  DCDBSysArc990907E.pdf page 289-292
+ */
+volatile uint32_t * ISTNRM = (volatile uint32_t *)(0xa05f6800 + 0x100);
+volatile uint32_t * ISTEXT = (volatile uint32_t *)(0xa05f6800 + 0x104);
+volatile uint32_t * ISTERR = (volatile uint32_t *)(0xa05f6800 + 0x108);
+
+#define ISTNRM__END_OF_RENDER_TSP (1 << 2)
+#define ISTNRM__END_OF_RENDER_ISP (1 << 1)
+#define ISTNRM__END_OF_RENDER_VIDEO (1 << 0)
+#define ISTNRM__V_BLANK_IN (1 << 3)
+#define ISTNRM__V_BLANK_OUT (1 << 4)
+#define ISTNRM__END_OF_TRANSFERRING_YUV (1 << 6)
+#define ISTNRM__END_OF_TRANSFERRING_OPAQUE_LIST (1 << 7)
+#define ISTNRM__END_OF_TRANSFERRING_OPAQUE_MODIFIER_VOLUME_LIST (1 << 8)
+#define ISTNRM__END_OF_TRANSFERRING_TRANSLUCENT_LIST (1 << 9)
+#define ISTNRM__END_OF_TRANSFERRING_TRANSLUCENT_MODIFIER_VOLUME_LIST (1 << 10)
+#define ISTNRM__END_OF_DMA_MAPLE_DMA (1 << 12)
+#define ISTNRM__END_OF_DMA_CH2_DMA (1 << 19)
+#define ISTNRM__END_OF_TRANSFERRING_PUNCH_THROUGH_LIST (1 << 21)
+// read-only: some ISTEXT, or some ISTERR, bit is set
+#define ISTNRM__EXTERNAL (1 << 30)
+#define ISTNRM__ERROR (1u << 31)
+
+#define ISTERR__TA_ISP_TSP_PARAMETER_OVERFLOW (1 << 2)
+#define ISTERR__TA_OBJECT_LIST_POINTER_OVERFLOW (1 << 3)
+#define ISTERR__TA_ILLEGAL_PARAMETER (1 << 4)
+#define ISTERR__TA_FIFO_OVERFLOW (1 << 5)
+
+/*
+  Interrupt masks: each ISTNRM/ISTEXT/ISTERR bit that is set in one of these
+  registers asserts the corresponding SH4 IRL interrupt level (6, 4 or 2).
+
+  DCDBSysArc990907E.pdf page 293-297
+ */
+volatile uint32_t * SB_IML2NRM = (volatile uint32_t *)(0xa05f6800 + 0x110);
+volatile uint32_t * SB_IML2EXT = (volatile uint32_t *)(0xa05f6800 + 0x114);
+volatile uint32_t * SB_IML2ERR = (volatile uint32_t *)(0xa05f6800 + 0x118);
+volatile uint32_t * SB_IML4NRM = (volatile uint32_t *)(0xa05f6800 + 0x120);
+volatile uint32_t * SB_IML4EXT = (volatile uint32_t *)(0xa05f6800 + 0x124);
+volatile uint32_t * SB_IML4ERR = (volatile uint32_t *)(0xa05f6800 + 0x128);
+volatile uint32_t * SB_IML6NRM = (volatile uint32_t *)(0xa05f6800 + 0x130);
+volatile uint32_t * SB_IML6EXT = (volatile uint32_t *)(0xa05f6800 + 0x134);
+volatile uint32_t * SB_IML6ERR = (volatile uint32_t *)(0xa05f6800 + 0x138);
+
+/******************************************************************************
+ CORE
+ ******************************************************************************/
+
+volatile uint32_t * SOFTRESET     = (volatile uint32_t *)(0xa05f8000 + 0x08);
+volatile uint32_t * STARTRENDER   = (volatile uint32_t *)(0xa05f8000 + 0x14);
+volatile uint32_t * PARAM_BASE    = (volatile uint32_t *)(0xa05f8000 + 0x20);
+volatile uint32_t * REGION_BASE   = (volatile uint32_t *)(0xa05f8000 + 0x2c);
+volatile uint32_t * FB_R_SOF1     = (volatile uint32_t *)(0xa05f8000 + 0x50);
+volatile uint32_t * FB_W_SOF1     = (volatile uint32_t *)(0xa05f8000 + 0x60);
+volatile uint32_t * ISP_BACKGND_T = (volatile uint32_t *)(0xa05f8000 + 0x8c);
+
+#define SOFTRESET__TA_SOFT_RESET (1 << 0)
+
+volatile uint32_t * SPG_STATUS = (volatile uint32_t *)(0xa05f8000 + 0x10c);
+
+#define SPG_STATUS__VSYNC (1 << 13)
+
+/******************************************************************************
+ TA
+ ******************************************************************************/
+
+volatile uint32_t * TA_OL_BASE        = (volatile uint32_t *)(0xa05f8000 + 0x124);
+volatile uint32_t * TA_ISP_BASE       = (volatile uint32_t *)(0xa05f8000 + 0x128);
+volatile uint32_t * TA_OL_LIMIT       = (volatile uint32_t *)(0xa05f8000 + 0x12c);
+volatile uint32_t * TA_ISP_LIMIT      = (volatile uint32_t *)(0xa05f8000 + 0x130);
+volatile uint32_t * TA_NEXT_OPB       = (volatile uint32_t *)(0xa05f8000 + 0x134);
+volatile uint32_t * TA_ITP_CURRENT    = (volatile uint32_t *)(0xa05f8000 + 0x138);
+volatile uint32_t * TA_GLOB_TILE_CLIP = (volatile uint32_t *)(0xa05f8000 + 0x13c);
+volatile uint32_t * TA_ALLOC_CTRL     = (volatile uint32_t *)(0xa05f8000 + 0x140);
+volatile uint32_t * TA_LIST_INIT      = (volatile uint32_t *)(0xa05f8000 + 0x144);
+volatile uint32_t * TA_NEXT_OPB_INIT  = (volatile uint32_t *)(0xa05f8000 + 0x164);
+
+// one per tile, in TA_GLOB_TILE_CLIP order; the object list state of the list
+// that the TA is building (or has last built)
+volatile uint32_t * TA_OL_POINTERS    = (volatile uint32_t *)(0xa05f8000 + 0x600);
+
+#define TA_GLOB_TILE_CLIP__TILE_Y_NUM(n) (((n) & 0xf) << 16)
+#define TA_GLOB_TILE_CLIP__TILE_X_NUM(n) (((n) & 0x1f) << 0)
+#define TA_ALLOC_CTRL__OPB_MODE__INCREASING_ADDRESSES (0 << 20)
+#define TA_ALLOC_CTRL__OPB_MODE__DECREASING_ADDRESSES (1 << 20)
+#define TA_ALLOC_CTRL__O_OPB__8X4BYTE (1 << 0)
+// the object pointer block size of each list: 0 (list not used), 1 (8×4
+// bytes), 2 (16×4 bytes) or 3 (32×4 bytes); see DCDBSysArc990907E.pdf page 386
+#define TA_ALLOC_CTRL__PT_OPB(n) (((n) & 0x3) << 16)
+#define TA_ALLOC_CTRL__TM_OPB(n) (((n) & 0x3) << 12)
+#define TA_ALLOC_CTRL__T_OPB(n) (((n) & 0x3) << 8)
+#define TA_ALLOC_CTRL__OM_OPB(n) (((n) & 0x3) << 4)
+#define TA_ALLOC_CTRL__O_OPB(n) (((n) & 0x3) << 0)
+#define TA_LIST_INIT__LIST_INIT (1u << 31)
+#define TA_OL_POINTERS__ENTRY (1u << 31)
+#define TA_OL_POINTERS__SLEEP (1 << 30)
+#define TA_OL_POINTERS__POINTER_ADDRESS(reg) ((reg) & 0xfffffc)
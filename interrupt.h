@@ -0,0 +1,245 @@
+#pragma once
+
+#include <stdint.h>
+
+#include "holly.h"
+
+/*
+  Holly normal interrupts
+
+  start.s points VBR at an exception vector table. The interrupt entry point
+  (VBR + 0x600) saves every register that a C function may clobber, and calls
+  interrupt_dispatch.
+
+  interrupt_init routes a set of ISTNRM bits to SH4 IRL level 6, and unmasks
+  interrupts in SR. From then on, each enabled ISTNRM bit is cleared by
+  interrupt_dispatch as soon as it is set, and is instead recorded in
+  `interrupt_events`. An optional callback (interrupt_set_callback) is also
+  called for each bit; callbacks run with further interrupts blocked, so they
+  must be short, and must not wait for other events.
+
+  interrupt_init can also route a set of ISTERR bits to IRL level 6. These
+  are handled in the same way: each is cleared in ISTERR by
+  interrupt_dispatch, and recorded in `interrupt_errors` until it is cleared
+  by interrupt_error_clear. Error bits have no callbacks.
+
+  ISTEXT causes, and ISTERR causes that are not enabled, are not dispatched:
+  interrupt_init routes none of them to any IRL level. Should one be routed
+  anyway (by whatever ran before this program) and become pending,
+  interrupt_dispatch masks it rather than returning with the IRL level still
+  asserted, which would re-enter the handler forever. Its status is left in
+  ISTEXT/ISTERR for polling.
+
+  interrupt_status, interrupt_clear and interrupt_wait accept any ISTNRM bit,
+  and interrupt_error_status and interrupt_error_clear any ISTERR bit,
+  whether or not it is enabled--bits that are not enabled are read from and
+  cleared in ISTNRM/ISTERR directly. ch2_dma.h, ta_stream.h and scheduler.h
+  wait for Holly events and errors only through these functions, so they
+  behave identically with and without interrupt_init.
+
+  While waiting for an enabled event, interrupt_wait only reads
+  `interrupt_events` in system memory (a cache hit in CACHED=1 builds) rather
+  than repeatedly reading ISTNRM over the system bus; the same is true of
+  interrupt_error_status and `interrupt_errors`.
+
+  See sh7091pm_e.pdf "Exception Handling" and "Interrupt Controller (INTC)",
+  and DCDBSysArc990907E.pdf page 289-292 (ISTNRM, ISTERR).
+ */
+
+// SR interrupt mask; level 15 masks every interrupt
+#define SR__IMASK(n) (((n) & 0xf) << 4)
+
+typedef void (* interrupt_callback)();
+
+// ISTNRM bits that have been routed to IRL level 6 by interrupt_init
+uint32_t interrupt_istnrm_mask = 0;
+
+// enabled ISTNRM bits that have occurred, and have not yet been cleared by
+// interrupt_clear
+volatile uint32_t interrupt_events = 0;
+
+// ISTERR bits that have been routed to IRL level 6 by interrupt_init
+uint32_t interrupt_isterr_mask = 0;
+
+// enabled ISTERR bits that have occurred, and have not yet been cleared by
+// interrupt_error_clear
+volatile uint32_t interrupt_errors = 0;
+
+interrupt_callback interrupt_callbacks[32];
+
+static inline uint32_t interrupt_disable()
+{
+  uint32_t sr;
+  asm volatile ("stc sr,%0" : "=r" (sr));
+  asm volatile ("ldc %0,sr" : : "r" (sr | SR__IMASK(15)) : "memory");
+  return sr;
+}
+
+static inline void interrupt_restore(uint32_t sr)
+{
+  asm volatile ("ldc %0,sr" : : "r" (sr) : "memory");
+}
+
+/*
+  Called by the interrupt entry point in start.s, with SR.BL set. `intevt` is
+  the INTEVT register value (0x320 for IRL level 6).
+ */
+void interrupt_dispatch(uint32_t intevt)
+{
+  (void)intevt;
+
+  uint32_t pending = *ISTNRM;
+  uint32_t status = pending & interrupt_istnrm_mask;
+
+  // ISTEXT causes can only be cleared at their device, so they are masked,
+  // not acknowledged; so are ISTERR causes that were not enabled, whose
+  // status is left for polling
+  if (pending & ISTNRM__EXTERNAL) {
+    *SB_IML6EXT = 0;
+    *SB_IML4EXT = 0;
+    *SB_IML2EXT = 0;
+  }
+  uint32_t errors = 0;
+  if (pending & ISTNRM__ERROR) {
+    *SB_IML6ERR = interrupt_isterr_mask;
+    *SB_IML4ERR = 0;
+    *SB_IML2ERR = 0;
+
+    errors = *ISTERR & interrupt_isterr_mask;
+    *ISTERR = errors;
+  }
+
+  // clear the status bits before calling any callback, so that an event that
+  // reoccurs during a callback is not lost
+  *ISTNRM = status;
+  // read back, so that the IRL level is deasserted before `rte`
+  (void)*ISTNRM;
+
+  interrupt_events |= status;
+  interrupt_errors |= errors;
+
+  for (int bit = 0; status != 0; bit++, status >>= 1) {
+    if ((status & 1) && interrupt_callbacks[bit])
+      interrupt_callbacks[bit]();
+  }
+}
+
+/*
+  `callback` is called for each occurrence of every ISTNRM bit in `events`;
+  a null callback removes it.
+ */
+void interrupt_set_callback(uint32_t events, interrupt_callback callback)
+{
+  uint32_t sr = interrupt_disable();
+  for (int bit = 0; bit < 32; bit++) {
+    if (events & (1u << bit))
+      interrupt_callbacks[bit] = callback;
+  }
+  interrupt_restore(sr);
+}
+
+/*
+  Enable interrupts for the ISTNRM bits in `istnrm_mask` and the ISTERR bits
+  in `isterr_mask`; any status from before this call is discarded.
+
+  Every enabled bit is routed to the same IRL level: interrupt_dispatch
+  handles every pending bit on each entry, so there is nothing to gain from
+  distinct levels.
+ */
+void interrupt_init(uint32_t istnrm_mask, uint32_t isterr_mask)
+{
+  uint32_t sr = interrupt_disable();
+
+  *SB_IML6NRM = istnrm_mask;
+  *SB_IML4NRM = 0;
+  *SB_IML2NRM = 0;
+
+  // no ISTEXT cause is dispatched; see interrupt_dispatch
+  *SB_IML6EXT = 0;
+  *SB_IML4EXT = 0;
+  *SB_IML2EXT = 0;
+  *SB_IML6ERR = isterr_mask;
+  *SB_IML4ERR = 0;
+  *SB_IML2ERR = 0;
+
+  *ISTERR = isterr_mask;
+  interrupt_isterr_mask = isterr_mask;
+  interrupt_errors = 0;
+
+  *ISTNRM = istnrm_mask;
+  interrupt_istnrm_mask = istnrm_mask;
+  interrupt_events = 0;
+
+  interrupt_restore(sr & ~SR__IMASK(15));
+}
+
+/*
+  Returns the subset of `events` (ISTNRM bits) that have occurred and have not
+  yet been cleared.
+ */
+static inline uint32_t interrupt_status(uint32_t events)
+{
+  uint32_t status = interrupt_events & events;
+  uint32_t polled = events & ~interrupt_istnrm_mask;
+  if (polled)
+    status |= *ISTNRM & polled;
+  return status;
+}
+
+static inline void interrupt_clear(uint32_t events)
+{
+  uint32_t polled = events & ~interrupt_istnrm_mask;
+  if (polled)
+    *ISTNRM = polled;
+
+  uint32_t sr = interrupt_disable();
+  interrupt_events &= ~events;
+  interrupt_restore(sr);
+}
+
+/*
+  Returns the subset of `errors` (ISTERR bits) that have occurred and have not
+  yet been cleared.
+ */
+static inline uint32_t interrupt_error_status(uint32_t errors)
+{
+  uint32_t status = interrupt_errors & errors;
+  uint32_t polled = errors & ~interrupt_isterr_mask;
+  if (polled)
+    status |= *ISTERR & polled;
+  return status;
+}
+
+static inline void interrupt_error_clear(uint32_t errors)
+{
+  uint32_t polled = errors & ~interrupt_isterr_mask;
+  if (polled)
+    *ISTERR = polled;
+
+  uint32_t sr = interrupt_disable();
+  interrupt_errors &= ~errors;
+  interrupt_restore(sr);
+}
+
+/*
+  Wait for every event in `events` to occur, then clear them.
+ */
+static inline void interrupt_wait(uint32_t events)
+{
+  while (interrupt_status(events) != events);
+  interrupt_clear(events);
+}
+
+/*
+  Stop executing instructions until the next interrupt (SH4 sleep mode);
+  peripherals, DMA and Holly continue to run.
+
+  An event may occur between checking for it and `sleep`, in which case the
+  CPU sleeps until the following interrupt. Only use this in loops where
+  that latency does not matter, or where a periodic interrupt (for example
+  ISTNRM__V_BLANK_IN) is enabled.
+ */
+static inline void interrupt_sleep()
+{
+  asm volatile ("sleep" : : : "memory");
+}
@@ -0,0 +1,203 @@
+#pragma once
+
+#include <stdint.h>
+
+#include "color.h"
+#include "matrix.h"
+#include "mesh.h"
+#include "vec.h"
+
+/*
+  Per-vertex diffuse lighting
+
+  A light_scene is a set of directional and point lights, in view space (see
+  mesh_vertex_view_space): the viewer is at the origin, looking along +z.
+  Before a mesh is lit, light_model_init transforms the scene into the mesh's
+  model space, once per mesh per frame, so that the per-vertex work uses the
+  mesh's normals and positions as they are stored (mesh_format.h), without
+  transforming either.
+
+  For each vertex with normal N (unit length) and position P, each light
+  contributes:
+
+    directional:  max(0, N·L)                        L: towards the light
+    point:        max(0, N·L / |L|) · max(0, 1 - |L| / range)
+                                                     L: P to the light
+
+  N·L and L·L are each one `fipr`, and 1 / |L| is one `fsrra` (see matrix.h);
+  |L| is L·L / |L|. There is no division, square root or specular term.
+
+  Two batched kernels write the sum of the ambient term and every light's
+  contribution, over a whole vertex array:
+
+  - light_intensity: one float per vertex, for the TA intensity vertex
+    parameters (polygon_type_2, polygon_type_7, ...); each light's color is
+    ignored, and its `intensity` scales its contribution
+
+  - light_color: each vertex's base color, multiplied by the sum of each
+    light's color scaled by its intensity, for the TA floating color vertex
+    parameters (polygon_type_1, polygon_type_5, ...)
+
+  Both leave the results unclamped; the TA clamps them as it packs them (see
+  color.h). light_bench.c measures the cycles per vertex of each kernel.
+ */
+
+#define LIGHT__DIRECTIONAL_MAX 4
+#define LIGHT__POINT_MAX 4
+
+typedef struct light_directional {
+  // the direction the light travels; unit length
+  vec3 direction;
+  color_argb color;
+  float intensity;
+} light_directional;
+
+typedef struct light_point {
+  vec3 position;
+  // the distance at which the light's contribution reaches zero
+  float range;
+  color_argb color;
+  float intensity;
+} light_point;
+
+typedef struct light_scene {
+  color_argb ambient_color;
+  float ambient_intensity;
+
+  int directional_length;
+  light_directional directional[LIGHT__DIRECTIONAL_MAX];
+
+  int point_length;
+  light_point point[LIGHT__POINT_MAX];
+} light_scene;
+
+/*
+  A light_scene in the model space of one mesh; the color of each light is
+  pre-multiplied by its intensity.
+ */
+typedef struct light_model {
+  color_argb ambient_color;
+  float ambient_intensity;
+
+  int directional_length;
+  vec3 directional_towards[LIGHT__DIRECTIONAL_MAX];
+  color_argb directional_color[LIGHT__DIRECTIONAL_MAX];
+  float directional_intensity[LIGHT__DIRECTIONAL_MAX];
+
+  int point_length;
+  vec3 point_position[LIGHT__POINT_MAX];
+  float point_inverse_range[LIGHT__POINT_MAX];
+  color_argb point_color[LIGHT__POINT_MAX];
+  float point_intensity[LIGHT__POINT_MAX];
+} light_model;
+
+light_model light_model_init(const light_scene * scene, const mesh_view * view)
+{
+  light_model model;
+
+  model.ambient_color = color_argb_scale(scene->ambient_color, scene->ambient_intensity);
+  model.ambient_intensity = scene->ambient_intensity;
+
+  model.directional_length = scene->directional_length;
+  for (int i = 0; i < scene->directional_length; i++) {
+    const light_directional * light = &scene->directional[i];
+    vec3 d = mesh_vertex_rotate_inverse(light->direction, view);
+    model.directional_towards[i] = (vec3){-d.x, -d.y, -d.z};
+    model.directional_color[i] = color_argb_scale(light->color, light->intensity);
+    model.directional_intensity[i] = light->intensity;
+  }
+
+  model.point_length = scene->point_length;
+  for (int i = 0; i < scene->point_length; i++) {
+    const light_point * light = &scene->point[i];
+    model.point_position[i] = mesh_vertex_model_space(light->position, view);
+    model.point_inverse_range[i] = 1.0f / light->range;
+    model.point_color[i] = color_argb_scale(light->color, light->intensity);
+    model.point_intensity[i] = light->intensity;
+  }
+
+  return model;
+}
+
+static inline float light_directional_term(vec3 n, vec3 towards)
+{
+  float k = fipr(n.x, n.y, n.z, 0.0f,
+                 towards.x, towards.y, towards.z, 0.0f);
+  return k > 0.0f ? k : 0.0f;
+}
+
+static inline float light_point_term(vec3 n, vec3 p, vec3 light, float inverse_range)
+{
+  float lx = light.x - p.x;
+  float ly = light.y - p.y;
+  float lz = light.z - p.z;
+
+  float l2 = fipr(lx, ly, lz, 0.0f,
+                  lx, ly, lz, 0.0f);
+  float rl = fsrra(l2);
+  float k = fipr(n.x, n.y, n.z, 0.0f,
+                 lx, ly, lz, 0.0f) * rl;
+  float attenuation = 1.0f - l2 * rl * inverse_range;
+
+  if (k <= 0.0f || attenuation <= 0.0f)
+    return 0.0f;
+  return k * attenuation;
+}
+
+/*
+  intensity[i] is the light intensity at (normal[i], position[i]).
+ */
+void light_intensity(const light_model * model,
+                     const vec3 * normal, const vec3 * position,
+                     float * intensity, int length)
+{
+  for (int i = 0; i < length; i++) {
+    vec3 n = normal[i];
+    vec3 p = position[i];
+    float sum = model->ambient_intensity;
+
+    for (int j = 0; j < model->directional_length; j++)
+      sum += model->directional_intensity[j] * light_directional_term(n, model->directional_towards[j]);
+
+    for (int j = 0; j < model->point_length; j++)
+      sum += model->point_intensity[j] * light_point_term(n, p, model->point_position[j], model->point_inverse_range[j]);
+
+    intensity[i] = sum;
+  }
+}
+
+/*
+  color[i] is base[i] lit at (normal[i], position[i]); the alpha of base[i] is
+  unchanged.
+ */
+void light_color(const light_model * model,
+                 const vec3 * normal, const vec3 * position, const color_argb * base,
+                 color_argb * color, int length)
+{
+  for (int i = 0; i < length; i++) {
+    vec3 n = normal[i];
+    vec3 p = position[i];
+    float r = model->ambient_color.r;
+    float g = model->ambient_color.g;
+    float b = model->ambient_color.b;
+
+    for (int j = 0; j < model->directional_length; j++) {
+      float k = light_directional_term(n, model->directional_towards[j]);
+      const color_argb * c = &model->directional_color[j];
+      r += c->r * k;
+      g += c->g * k;
+      b += c->b * k;
+    }
+
+    for (int j = 0; j < model->point_length; j++) {
+      float k = light_point_term(n, p, model->point_position[j], model->point_inverse_range[j]);
+      const color_argb * c = &model->point_color[j];
+      r += c->r * k;
+      g += c->g * k;
+      b += c->b * k;
+    }
+
+    color_argb v = base[i];
+    color[i] = (color_argb){v.a, v.r * r, v.g * g, v.b * b};
+  }
+}
@@ -0,0 +1,139 @@
+#include <stdint.h>
+
+#include "color.h"
+#include "light.h"
+#include "scif.h"
+#include "sections.h"
+#include "tmu.h"
+#include "vec.h"
+
+/*
+  Per-vertex lighting benchmark (see light.h)
+
+  This benchmark is intended to be built with CACHED=1:
+
+    CACHED=1 ./build.sh light_bench
+
+  Each kernel (light_intensity, light_color) lights the same VERTEX_COUNT
+  vertices with each of:
+
+  - one directional light
+  - one point light
+  - two directional lights and two point lights
+
+  The inputs and outputs are in operand cache RAM (see sections.h), as the
+  transformed vertices of the demos are, so that the results are the cost of
+  the lighting arithmetic alone.
+
+  The results are printed over the SCIF, in CPU cycles per vertex, for
+  budgeting: a mesh of N vertices lit by the same lights costs N times as
+  much, plus one light_model_init.
+ */
+
+// 12 + 12 + 4 bytes per vertex in OCRAM area 0; 16 + 16 bytes per vertex in
+// OCRAM area 1
+#define VERTEX_COUNT 128
+#define ITERATIONS 100
+
+vec3 vertex_normal[VERTEX_COUNT] __ocram0;
+vec3 vertex_position[VERTEX_COUNT] __ocram0;
+float vertex_intensity[VERTEX_COUNT] __ocram0;
+color_argb vertex_base[VERTEX_COUNT] __ocram1;
+color_argb vertex_color[VERTEX_COUNT] __ocram1;
+
+static const light_directional directional[2] = {
+  { .direction = { 0.57735027f, 0.57735027f, 0.57735027f }, .color = { 1.0f, 1.0f, 1.0f, 1.0f }, .intensity = 0.6f },
+  { .direction = { -0.70710678f, 0.0f, 0.70710678f },       .color = { 1.0f, 0.5f, 0.5f, 1.0f }, .intensity = 0.3f },
+};
+
+static const light_point point[2] = {
+  { .position = { 2.0f, 2.0f, 2.0f },  .range = 4.0f, .color = { 1.0f, 1.0f, 0.5f, 0.0f }, .intensity = 0.8f },
+  { .position = { -2.0f, 0.0f, 1.0f }, .range = 6.0f, .color = { 1.0f, 0.0f, 0.5f, 1.0f }, .intensity = 0.5f },
+};
+
+void initialize_vertices()
+{
+  // an arbitrary, deterministic set of points on the unit sphere
+  for (int i = 0; i < VERTEX_COUNT; i++) {
+    float s;
+    float c;
+    fsca((float)i * 0.7f, &s, &c);
+    float y = (float)((i * 5) % 13) / 6.0f - 1.0f;
+    float r = fsrra(1.0f + y * y);
+    vec3 n = {c * r, y * r, s * r};
+    vertex_normal[i] = n;
+    vertex_position[i] = n;
+    vertex_base[i] = (color_argb){1.0f, 1.0f, 0.8f, 0.6f};
+  }
+}
+
+uint32_t benchmark(const light_scene * scene, bool color)
+{
+  mesh_view view = mesh_view_init(0.5f, 240.f, 320.f, 240.f);
+
+  uint32_t start = tmu_ticks();
+  for (int i = 0; i < ITERATIONS; i++) {
+    light_model model = light_model_init(scene, &view);
+    if (color)
+      light_color(&model, vertex_normal, vertex_position, vertex_base, vertex_color, VERTEX_COUNT);
+    else
+      light_intensity(&model, vertex_normal, vertex_position, vertex_intensity, VERTEX_COUNT);
+  }
+  return tmu_ticks() - start;
+}
+
+void report(const char * name, uint32_t ticks)
+{
+  const float cycles = tmu_ticks_to_cycles(ticks) * (1.0f / (VERTEX_COUNT * ITERATIONS));
+
+  scif_string(name);
+  scif_character('\n');
+  scif_label_base10("  total time (us)", tmu_ticks_to_us(ticks));
+  scif_label_base10("  CPU cycles per vertex", (uint32_t)cycles);
+}
+
+void main()
+{
+  scif_init();
+  tmu_init();
+
+  initialize_vertices();
+
+  light_scene one_directional = {
+    .ambient_color = { 1.0f, 1.0f, 1.0f, 1.0f },
+    .ambient_intensity = 0.2f,
+    .directional_length = 1,
+    .directional = { directional[0] },
+  };
+  light_scene one_point = {
+    .ambient_color = { 1.0f, 1.0f, 1.0f, 1.0f },
+    .ambient_intensity = 0.2f,
+    .point_length = 1,
+    .point = { point[0] },
+  };
+  light_scene four = {
+    .ambient_color = { 1.0f, 1.0f, 1.0f, 1.0f },
+    .ambient_intensity = 0.2f,
+    .directional_length = 2,
+    .directional = { directional[0], directional[1] },
+    .point_length = 2,
+    .point = { point[0], point[1] },
+  };
+
+  uint32_t intensity_directional_ticks = benchmark(&one_directional, false);
+  uint32_t intensity_point_ticks = benchmark(&one_point, false);
+  uint32_t intensity_four_ticks = benchmark(&four, false);
+  uint32_t color_directional_ticks = benchmark(&one_directional, true);
+  uint32_t color_point_ticks = benchmark(&one_point, true);
+  uint32_t color_four_ticks = benchmark(&four, true);
+
+  scif_label_base10("cached", CACHED);
+  scif_label_base10("vertices", VERTEX_COUNT * ITERATIONS);
+  report("light_intensity, 1 directional", intensity_directional_ticks);
+  report("light_intensity, 1 point", intensity_point_ticks);
+  report("light_intensity, 2 directional + 2 point", intensity_four_ticks);
+  report("light_color, 1 directional", color_directional_ticks);
+  report("light_color, 1 point", color_point_ticks);
+  report("light_color, 2 directional + 2 point", color_four_ticks);
+  scif_flush();
+}
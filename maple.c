@@ -1,5 +1,9 @@
 #include <stdint.h>
 
+#include "cache.h"
+#include "holly.h"
+#include "interrupt.h"
+
 //
 // SH4 SCIF definitions
 //
@@ -194,11 +198,6 @@ typedef struct maple_device_status {
 // Maple interface definitions
 //
 
-// system bus interface
-volatile uint32_t * ISTNRM = (volatile uint32_t *)(0xa05f6800 + 0x100);
-
-#define ISTNRM__END_OF_DMA_MAPLE_DMA (1 << 12)
-
 // Maple interface
 volatile uint32_t * MDSTAR = (volatile uint32_t *)(0xa05f6c00 + 0x04);
 volatile uint32_t * MDTSEL = (volatile uint32_t *)(0xa05f6c00 + 0x10);
@@ -235,22 +234,27 @@ volatile uint32_t * MDAPRO = (volatile uint32_t *)(0xa05f6c00 + 0x8c);
   Note that this `maple_dma_start` function does not configure SH4 DMA channel
   0, and presumes it is already in the correct state.
  */
-void maple_dma_start(void * command_buf)
+void maple_dma_start(void * command_buf, uint32_t command_size,
+                     void * receive_buf, uint32_t receive_size)
 {
-  // if SH4 cache were enabled, it would be necessary to use the `ocbwb` sh4
-  // instruction to write back the cache to system memory, prior to continuing.
-
-  // if SH4 cache were enabled, it would be necessary to use the `ocbi` sh4
-  // instruction to invalidate any possibly-cached areas of the recieve buffer,
-  // as these are imminently going to be rewritten by the DMA unit independently
-  // of cache access.
+  // When the SH4 cache is enabled (CACHED=1), the command buffer may still
+  // partially exist only in the operand cache. Write it back to system memory
+  // so that the DMA unit reads what the CPU wrote.
+  cache_writeback(command_buf, command_size);
+
+  // Similarly, invalidate any possibly-cached areas of the recieve buffer, as
+  // these are imminently going to be rewritten by the DMA unit independently of
+  // cache access. If this were not done, a later copy-back of a dirty line
+  // could overwrite the reply, or a stale line could be read instead of the
+  // reply.
+  cache_invalidate(receive_buf, receive_size);
 
   // disable Maple DMA and abort any possibly-in-progress transfers
   *MDEN = MDEN__DMA_ENABLE__ABORT;
   while ((*MDST & MDST__START_STATUS) != 0);
 
   // clear Maple DMA end status
-  *ISTNRM = ISTNRM__END_OF_DMA_MAPLE_DMA;
+  interrupt_clear(ISTNRM__END_OF_DMA_MAPLE_DMA);
 
   // 20nsec * 0xc350 = 1ms
   uint32_t one_msec = 0xc350;
@@ -277,6 +281,9 @@ void maple_dma_start(void * command_buf)
   *MDTSEL = MDTSEL__TRIGGER_SELECT__SOFTWARE_INITIATION;
 
   // the Maple DMA start address must be 32-byte aligned
+  //
+  // MDSTAR__TABLE_ADDRESS discards the P1/P2 area bits, so either alias of the
+  // same buffer may be used here.
   *MDSTAR = MDSTAR__TABLE_ADDRESS((uint32_t)command_buf);
 
   // re-enable Maple DMA
@@ -288,10 +295,8 @@ void maple_dma_start(void * command_buf)
 
 void maple_dma_wait_complete()
 {
-  // wait for Maple DMA completion
-  while ((*ISTNRM & ISTNRM__END_OF_DMA_MAPLE_DMA) == 0);
-  // clear Maple DMA end status
-  *ISTNRM = ISTNRM__END_OF_DMA_MAPLE_DMA;
+  // wait for Maple DMA completion, and clear the Maple DMA end status
+  interrupt_wait(ISTNRM__END_OF_DMA_MAPLE_DMA);
 }
 
 //
@@ -307,7 +312,8 @@ void maple_device_request(uint8_t * send_buf, uint8_t * recv_buf)
                                  | MAPLE__HOST_INSTRUCTION__PATTERN__NORMAL
                                  | MAPLE__HOST_INSTRUCTION__TRANSFER_LENGTH(0);
 
-  host_command->receive_data_address = (uint32_t)recv_buf;
+  // the Maple DMA unit expects a physical address; discard the P1/P2 area bits
+  host_command->receive_data_address = (uint32_t)recv_buf & 0x1fffffff;
 
   host_command->protocol_header.command_code = MAPLE__COMMAND_CODE__DEVICE_REQUEST;
 
@@ -333,7 +339,9 @@ void main()
   // recv_buf is reply destination address
   maple_device_request(send_buf, recv_buf);
 
-  maple_dma_start(send_buf);
+  interrupt_init(ISTNRM__END_OF_DMA_MAPLE_DMA, 0);
+
+  maple_dma_start(send_buf, (sizeof (send_buf)), recv_buf, (sizeof (recv_buf)));
 
   maple_dma_wait_complete();
 
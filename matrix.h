@@ -0,0 +1,263 @@
+#pragma once
+
+#include <stdint.h>
+
+#include "fpscr.h"
+#include "vec.h"
+
+/*
+  4×4 matrices and the SH4 vector instructions
+
+  The SH4 FPU has a second ("back") bank of 16 single precision registers,
+  XF0-XF15, which `ftrv` treats as a 4×4 matrix, XMTRX:
+
+    | XF0 XF4 XF8  XF12 |
+    | XF1 XF5 XF9  XF13 |
+    | XF2 XF6 XF10 XF14 |
+    | XF3 XF7 XF11 XF15 |
+
+  `ftrv xmtrx,fvn` multiplies XMTRX by the 4-element vector FVn (FRn-FRn+3)
+  in a single instruction. gcc never uses the back bank in -m4-single-only
+  code, so a matrix that is loaded into XMTRX once (mat4_load) stays resident
+  for any number of mat4_ftrv calls.
+
+  mat4 is stored in column-major order, which is the XF register order above;
+  mat4_load is eight 64-bit fmov instructions. With FPSCR.SZ = 1, fmov
+  addresses the back bank directly as XD0-XD14, so `frchg` (swapping the
+  front and back banks) is not needed to load XMTRX.
+
+  XMTRX is not saved by the interrupt entry point in start.s, but
+  interrupt_dispatch (and all other gcc-generated code) also never modifies
+  it.
+
+  See sh7091pm_e.pdf printed page 147-150 (FPU registers) and the FTRV, FIPR,
+  FSCA and FSRRA instruction descriptions.
+
+  Host programs (see tools/) that include this header get portable C
+  equivalents of each instruction: XMTRX is then an ordinary variable, and
+  fsca and fsrra are exact rather than approximate.
+ */
+
+typedef struct vec4 {
+  float x;
+  float y;
+  float z;
+  float w;
+} vec4;
+
+typedef struct mat4 {
+  // column-major: m[column * 4 + row]
+  float m[16];
+} __attribute__((aligned(8))) mat4;
+
+/*
+  Construct a matrix from its elements in row-major (reading) order.
+ */
+static inline mat4 mat4_init(float m00, float m01, float m02, float m03,
+                             float m10, float m11, float m12, float m13,
+                             float m20, float m21, float m22, float m23,
+                             float m30, float m31, float m32, float m33)
+{
+  return (mat4){{
+    m00, m10, m20, m30,
+    m01, m11, m21, m31,
+    m02, m12, m22, m32,
+    m03, m13, m23, m33,
+  }};
+}
+
+static inline mat4 mat4_identity()
+{
+  return mat4_init(1, 0, 0, 0,
+                   0, 1, 0, 0,
+                   0, 0, 1, 0,
+                   0, 0, 0, 1);
+}
+
+static inline mat4 mat4_translate(float x, float y, float z)
+{
+  return mat4_init(1, 0, 0, x,
+                   0, 1, 0, y,
+                   0, 0, 1, z,
+                   0, 0, 0, 1);
+}
+
+static inline mat4 mat4_rotate_x(float s, float c)
+{
+  return mat4_init(1, 0,  0, 0,
+                   0, c, -s, 0,
+                   0, s,  c, 0,
+                   0, 0,  0, 1);
+}
+
+static inline mat4 mat4_rotate_y(float s, float c)
+{
+  return mat4_init(c, 0, -s, 0,
+                   0, 1,  0, 0,
+                   s, 0,  c, 0,
+                   0, 0,  0, 1);
+}
+
+/*
+  Load `m` into XMTRX.
+ */
+#if !defined(__sh__)
+// XMTRX, on the host
+static mat4 mat4_xmtrx;
+#endif
+
+static inline void mat4_load(const mat4 * m)
+{
+#if defined(__sh__)
+  const float * p = m->m;
+  asm volatile (
+    FPSCR_SZ_BEGIN
+    "fmov @%0+,xd0\n"
+    "fmov @%0+,xd2\n"
+    "fmov @%0+,xd4\n"
+    "fmov @%0+,xd6\n"
+    "fmov @%0+,xd8\n"
+    "fmov @%0+,xd10\n"
+    "fmov @%0+,xd12\n"
+    "fmov @%0+,xd14\n"
+    FPSCR_SZ_END
+    : "+r" (p)
+    :
+    : "memory"
+  );
+#else
+  mat4_xmtrx = *m;
+#endif
+}
+
+/*
+  XMTRX × (x, y, z, w)
+
+  This is `asm volatile` so that it is never moved before the mat4_load it
+  depends on.
+ */
+static inline vec4 mat4_ftrv(float x, float y, float z, float w)
+{
+#if defined(__sh__)
+  register float fr8 asm("fr8") = x;
+  register float fr9 asm("fr9") = y;
+  register float fr10 asm("fr10") = z;
+  register float fr11 asm("fr11") = w;
+
+  asm volatile ("ftrv xmtrx,fv8"
+                : "+f" (fr8), "+f" (fr9), "+f" (fr10), "+f" (fr11));
+
+  return (vec4){fr8, fr9, fr10, fr11};
+#else
+  const float * m = mat4_xmtrx.m;
+  return (vec4){
+    m[0] * x + m[4] * y + m[8]  * z + m[12] * w,
+    m[1] * x + m[5] * y + m[9]  * z + m[13] * w,
+    m[2] * x + m[6] * y + m[10] * z + m[14] * w,
+    m[3] * x + m[7] * y + m[11] * z + m[15] * w,
+  };
+#endif
+}
+
+/*
+  a × b, via XMTRX: each column of `b` is transformed by `a` with `ftrv`.
+
+  This replaces the contents of XMTRX.
+ */
+static inline mat4 mat4_mul(const mat4 * a, const mat4 * b)
+{
+  mat4_load(a);
+
+  mat4 r;
+  for (int col = 0; col < 4; col++) {
+    const float * c = &b->m[col * 4];
+    vec4 v = mat4_ftrv(c[0], c[1], c[2], c[3]);
+    r.m[col * 4 + 0] = v.x;
+    r.m[col * 4 + 1] = v.y;
+    r.m[col * 4 + 2] = v.z;
+    r.m[col * 4 + 3] = v.w;
+  }
+  return r;
+}
+
+/*
+  Dot product of two 4-element vectors with `fipr`.
+ */
+static inline float fipr(float a0, float a1, float a2, float a3,
+                         float b0, float b1, float b2, float b3)
+{
+#if defined(__sh__)
+  register float fr0 asm("fr0") = a0;
+  register float fr1 asm("fr1") = a1;
+  register float fr2 asm("fr2") = a2;
+  register float fr3 asm("fr3") = a3;
+  register float fr4 asm("fr4") = b0;
+  register float fr5 asm("fr5") = b1;
+  register float fr6 asm("fr6") = b2;
+  register float fr7 asm("fr7") = b3;
+
+  // the result replaces FR7
+  asm ("fipr fv0,fv4"
+       : "+f" (fr7)
+       : "f" (fr0), "f" (fr1), "f" (fr2), "f" (fr3),
+         "f" (fr4), "f" (fr5), "f" (fr6));
+
+  return fr7;
+#else
+  return a0 * b0 + a1 * b1 + a2 * b2 + a3 * b3;
+#endif
+}
+
+static inline float vec3_dot(vec3 a, vec3 b)
+{
+  return fipr(a.x, a.y, a.z, 0.0f,
+              b.x, b.y, b.z, 0.0f);
+}
+
+/*
+  Approximate sine and cosine of `theta` (radians) with `fsca`, which takes
+  the angle as a fixed-point fraction of a full turn (0x10000 = 2π).
+ */
+static inline void fsca(float theta, float * s, float * c)
+{
+#if defined(__sh__)
+  int32_t angle = (int32_t)(theta * (65536.0f / (2.0f * 3.14159265358979f)));
+
+  register float fr0 asm("fr0");
+  register float fr1 asm("fr1");
+
+  asm ("lds %2,fpul\n"
+       "fsca fpul,dr0\n"
+       : "=f" (fr0), "=f" (fr1)
+       : "r" (angle)
+       : "fpul");
+
+  *s = fr0;
+  *c = fr1;
+#else
+  *s = __builtin_sinf(theta);
+  *c = __builtin_cosf(theta);
+#endif
+}
+
+/*
+  Approximate 1 / sqrt(x) with `fsrra`.
+ */
+static inline float fsrra(float x)
+{
+#if defined(__sh__)
+  asm ("fsrra %0" : "+f" (x));
+  return x;
+#else
+  return 1.0f / __builtin_sqrtf(x);
+#endif
+}
+
+/*
+  Approximate 1 / x for x > 0, as fsrra(x × x); this avoids `fdiv`, which is
+  not pipelined.
+ */
+static inline float frcp_positive(float x)
+{
+  return fsrra(x * x);
+}
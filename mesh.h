@@ -0,0 +1,241 @@
+#pragma once
+
+#include <stdint.h>
+
+#include "matrix.h"
+#include "vec.h"
+
+/*
+  Transform-once indexed mesh pipeline
+
+  An indexed mesh references each unique position from several faces (each
+  cube corner is shared by 4-6 triangles). Rather than transforming each
+  position once per face reference, mesh_transform transforms each unique
+  position exactly once per frame into a caller-provided screen-space cache,
+  and faces are then streamed to the TA by looking up their (already
+  transformed) vertices in that cache.
+
+  The screen-space cache must have one entry per position. For small meshes,
+  placing it in operand cache RAM (`__ocram0`/`__ocram1`, see sections.h)
+  means the face loop never misses on the cache lookups; larger meshes can
+  use a system memory array of any size.
+
+  The per-frame transform parameters (the sine and cosine of the rotation
+  angle, and the screen-space scale and center) are computed once per frame
+  by mesh_view_init, rather than once per vertex.
+
+  There are two equivalent transform paths:
+
+  - mesh_transform: scalar rotation, perspective divide and screen-space
+    mapping
+
+  - mesh_transform_xmtrx: the same transform composed into a single matrix
+    (mesh_view_matrix), loaded into XMTRX once per mesh; each position is then
+    one `ftrv`, and the perspective divide uses `fsrra` rather than `fdiv`
+    (see matrix.h)
+
+  Both paths only divide positions that are on or in front of the near plane
+  (view space z ≥ MESH__NEAR_Z); any other position is stored undivided, with
+  a negative z, and must be clipped (see clip.h) before it is submitted:
+
+    in front:  screen = (X / W, Y / W, 1 / W)
+    behind:    screen = (X, Y, W - MESH__NEAR_Z)
+
+  where (X, Y, W) is the homogeneous screen-space position, and W is the view
+  space z. Both transforms return the number of positions behind the near
+  plane; when this is zero, no clipping is needed.
+ */
+
+typedef struct mesh_view {
+  float sin_theta;
+  float cos_theta;
+
+  // screen-space x = x * scale + center_x (and similarly for y)
+  float scale;
+  float center_x;
+  float center_y;
+} mesh_view;
+
+// the view-space z of the near plane (see mesh_vertex_view_space); geometry
+// closer to the viewer is clipped (see clip.h)
+#define MESH__NEAR_Z 0.1f
+
+// the number of positions transformed by mesh_transform since the last
+// reset; the caller resets this as needed
+uint32_t mesh_transform_count = 0;
+
+static inline mesh_view mesh_view_init(float theta, float scale, float center_x, float center_y)
+{
+  float s;
+  float c;
+  fsca(theta, &s, &c);
+
+  return (mesh_view){
+    .sin_theta = s,
+    .cos_theta = c,
+    .scale = scale,
+    .center_x = center_x,
+    .center_y = center_y,
+  };
+}
+
+static inline vec3 mesh_vertex_rotate(vec3 v, const mesh_view * view)
+{
+  // to make the mesh's appearance more interesting, rotate the vertex on two
+  // axes
+
+  float s = view->sin_theta;
+  float c = view->cos_theta;
+
+  float x0 = v.x;
+  float y0 = v.y;
+  float z0 = v.z;
+
+  float x1 = x0 * c - z0 * s;
+  float y1 = y0;
+  float z1 = x0 * s + z0 * c;
+
+  float x2 = x1;
+  float y2 = y1 * c - z1 * s;
+  float z2 = y1 * s + z1 * c;
+
+  return (vec3){x2, y2, z2};
+}
+
+// the inverse of mesh_vertex_rotate
+static inline vec3 mesh_vertex_rotate_inverse(vec3 v, const mesh_view * view)
+{
+  float s = view->sin_theta;
+  float c = view->cos_theta;
+
+  float x2 = v.x;
+  float y2 = v.y;
+  float z2 = v.z;
+
+  float x1 = x2;
+  float y1 = y2 * c + z2 * s;
+  float z1 = z2 * c - y2 * s;
+
+  float x0 = x1 * c + z1 * s;
+  float y0 = y1;
+  float z0 = z1 * c - x1 * s;
+
+  return (vec3){x0, y0, z0};
+}
+
+/*
+  The view-space position of `v`: rotated, then translated to z + 3. The
+  viewer is at the origin, looking along +z; this is the space that
+  mesh_vertex_perspective_divide projects from.
+ */
+static inline vec3 mesh_vertex_view_space(vec3 v, const mesh_view * view)
+{
+  vec3 r = mesh_vertex_rotate(v, view);
+  return (vec3){r.x, r.y, r.z + 3.0f};
+}
+
+// the inverse of mesh_vertex_view_space: the model space position of the
+// view space position `v`
+static inline vec3 mesh_vertex_model_space(vec3 v, const mesh_view * view)
+{
+  return mesh_vertex_rotate_inverse((vec3){v.x, v.y, v.z - 3.0f}, view);
+}
+
+// `v` is a view space position with v.z ≥ MESH__NEAR_Z
+static inline vec3 mesh_vertex_perspective_divide(vec3 v)
+{
+  float w = 1.0f / v.z;
+  return (vec3){v.x * w, v.y * w, w};
+}
+
+static inline vec3 mesh_vertex_screen_space(vec3 v, const mesh_view * view)
+{
+  return (vec3){
+    v.x * view->scale + view->center_x,
+    v.y * view->scale + view->center_y,
+    v.z,
+  };
+}
+
+// the undivided screen-space position of a view space position behind the
+// near plane
+static inline vec3 mesh_vertex_behind(vec3 v, const mesh_view * view)
+{
+  return (vec3){
+    v.x * view->scale + v.z * view->center_x,
+    v.y * view->scale + v.z * view->center_y,
+    v.z - MESH__NEAR_Z,
+  };
+}
+
+/*
+  Transform `length` positions into `screen`; screen[i] is the screen-space
+  vertex of position[i].
+
+  Returns the number of positions behind the near plane.
+ */
+int mesh_transform(const vec3 * position, vec3 * screen, int length, const mesh_view * view)
+{
+  int behind = 0;
+
+  for (int i = 0; i < length; i++) {
+    vec3 v = mesh_vertex_view_space(position[i], view);
+    if (v.z >= MESH__NEAR_Z) {
+      screen[i] = mesh_vertex_screen_space(mesh_vertex_perspective_divide(v), view);
+    } else {
+      screen[i] = mesh_vertex_behind(v, view);
+      behind += 1;
+    }
+  }
+
+  mesh_transform_count += length;
+
+  return behind;
+}
+
+/*
+  The transform of mesh_transform as a single matrix: the rotation, the
+  translation to z + 3, and a projection whose W is the translated z, such
+  that (X / W, Y / W) is the screen-space position.
+ */
+static inline mat4 mesh_view_matrix(const mesh_view * view)
+{
+  mat4 rotate_y = mat4_rotate_y(view->sin_theta, view->cos_theta);
+  mat4 rotate_x = mat4_rotate_x(view->sin_theta, view->cos_theta);
+  mat4 translate = mat4_translate(0.0f, 0.0f, 3.0f);
+  mat4 screen = mat4_init(view->scale, 0.0f,        view->center_x, 0.0f,
+                          0.0f,        view->scale, view->center_y, 0.0f,
+                          0.0f,        0.0f,        0.0f,           1.0f,
+                          0.0f,        0.0f,        1.0f,           0.0f);
+
+  mat4 m = mat4_mul(&rotate_x, &rotate_y);
+  m = mat4_mul(&translate, &m);
+  return mat4_mul(&screen, &m);
+}
+
+/*
+  Equivalent to mesh_transform, with `m` from mesh_view_matrix.
+
+  This replaces the contents of XMTRX.
+ */
+int mesh_transform_xmtrx(const vec3 * position, vec3 * screen, int length, const mat4 * m)
+{
+  int behind = 0;
+
+  mat4_load(m);
+
+  for (int i = 0; i < length; i++) {
+    vec4 v = mat4_ftrv(position[i].x, position[i].y, position[i].z, 1.0f);
+    if (v.w >= MESH__NEAR_Z) {
+      float rhw = frcp_positive(v.w);
+      screen[i] = (vec3){v.x * rhw, v.y * rhw, rhw};
+    } else {
+      screen[i] = (vec3){v.x, v.y, v.w - MESH__NEAR_Z};
+      behind += 1;
+    }
+  }
+
+  mesh_transform_count += length;
+
+  return behind;
+}
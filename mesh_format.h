@@ -0,0 +1,122 @@
+#pragma once
+
+#include <stdint.h>
+
+#include "vec.h"
+
+/*
+  Packed mesh format
+
+  A packed mesh is written by the host tool tools/obj2mesh.c, and is intended
+  to be included in a program with #embed:
+
+    static const uint8_t cube_mesh[] __attribute__((aligned(4))) = {
+      #embed "cube.mesh"
+    };
+
+  Everything that can be done ahead of time is done by obj2mesh:
+
+  - each unique (position, normal, texture) combination is a single vertex;
+    faces never reference separate position and texture indices
+
+  - vertices are numbered in the order in which the strips first use them, so
+    that a transformed vertex cache (see mesh.h) is filled, and then read, in
+    close to sequential order
+
+  - faces are converted to triangle strips (see strip.h)
+
+  - positions shared by several vertices (a cube corner is a vertex of each
+    of its three faces) are stored once, with a per-vertex index into them,
+    so that each unique position is transformed once
+
+  - a bounding sphere is computed from the positions
+
+  The file is a mesh_format_header followed by these arrays, each at a 4-byte
+  aligned byte offset (relative to the start of the header) given in the
+  header:
+
+    vec3     position[vertex_count]
+    vec3     normal[vertex_count]
+    vec2     texture[vertex_count]
+    vec3     unique_position[unique_position_count]
+    uint16_t strip_length[strip_count]
+    uint16_t strip[strip_vertex_count]     // vertex indices
+    uint16_t position_index[vertex_count]  // unique_position indices
+
+  The arrays are separate (rather than interleaved per vertex) so that
+  `position` and `unique_position` can be passed directly to
+  mesh_transform/mesh_transform_xmtrx. `unique_position` is numbered in the
+  order in which the vertices first use it, and `position[i]` is
+  `unique_position[position_index[i]]`.
+
+  All values are little-endian, which is the byte order of both the SH4 (as
+  built by build.sh) and the host.
+ */
+
+#define MESH_FORMAT__MAGIC 0x4853454d // "MESH"
+#define MESH_FORMAT__VERSION 2
+
+typedef struct mesh_format_header {
+  uint32_t magic;
+  uint32_t version;
+
+  uint32_t vertex_count;
+  uint32_t strip_count;
+  uint32_t strip_vertex_count;
+  uint32_t unique_position_count;
+
+  // byte offsets, relative to the start of the header
+  uint32_t position_offset;
+  uint32_t normal_offset;
+  uint32_t texture_offset;
+  uint32_t strip_length_offset;
+  uint32_t strip_offset;
+  uint32_t unique_position_offset;
+  uint32_t position_index_offset;
+
+  // bounding sphere, in the same coordinate space as `position`
+  vec3 center;
+  float radius;
+} mesh_format_header;
+
+static_assert((sizeof (mesh_format_header)) == 4 * 17);
+
+static inline const mesh_format_header * mesh_format_header_of(const void * data)
+{
+  return (const mesh_format_header *)data;
+}
+
+static inline const vec3 * mesh_format_position(const mesh_format_header * header)
+{
+  return (const vec3 *)((const uint8_t *)header + header->position_offset);
+}
+
+static inline const vec3 * mesh_format_normal(const mesh_format_header * header)
+{
+  return (const vec3 *)((const uint8_t *)header + header->normal_offset);
+}
+
+static inline const vec2 * mesh_format_texture(const mesh_format_header * header)
+{
+  return (const vec2 *)((const uint8_t *)header + header->texture_offset);
+}
+
+static inline const uint16_t * mesh_format_strip_length(const mesh_format_header * header)
+{
+  return (const uint16_t *)((const uint8_t *)header + header->strip_length_offset);
+}
+
+static inline const uint16_t * mesh_format_strip(const mesh_format_header * header)
+{
+  return (const uint16_t *)((const uint8_t *)header + header->strip_offset);
+}
+
+static inline const vec3 * mesh_format_unique_position(const mesh_format_header * header)
+{
+  return (const vec3 *)((const uint8_t *)header + header->unique_position_offset);
+}
+
+static inline const uint16_t * mesh_format_position_index(const mesh_format_header * header)
+{
+  return (const uint16_t *)((const uint8_t *)header + header->position_index_offset);
+}
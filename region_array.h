@@ -0,0 +1,227 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "ta_alloc.h"
+
+/*
+  Region array
+
+  CORE renders tile by tile, in region array order. Each "region array entry"
+  is a tile position and one object list pointer per list type; these are
+  briefly illustrated in DCDBSysArc990907E.pdf page 168, 177-180.
+
+  The number of list pointers per region array entry is affected by
+  FPU_PARAM_CFG "Region Header Type" (page 368). region_array_entry models the
+  "6 × 32bit/Tile Type 2" mode.
+
+  List pointers are offsets relative to the beginning of "32-bit" texture
+  memory. Each list type uses different rasterization steps, "opaque" being
+  the fastest and most efficient. A list that is not used in a tile is
+  REGION_ARRAY__LIST_POINTER__EMPTY.
+
+  When the TA builds the object lists, each list pointer is the first object
+  pointer block of that tile and list (see ta_alloc.h). The region array only
+  depends on the tile count and the OPB size of each list, so it is written
+  once per ta_alloc, and reused by every frame.
+
+  A tile that received no geometry in a list still has an (empty) object
+  list, which CORE reads. region_array_empty_tiles finds these tiles, from
+  TA_OL_POINTERS, for the list that the TA built last (TA_OL_POINTERS only
+  describes that list); region_array_update_empty then marks the tiles'
+  pointers for that list EMPTY, rewriting only the entries that changed since
+  the previous frame. Tiles themselves are never removed from the region
+  array: every tile must still be rendered, to draw the background and write
+  the framebuffer.
+ */
+
+typedef struct region_array_entry {
+  uint32_t tile;
+  struct {
+    uint32_t opaque;
+    uint32_t opaque_modifier_volume;
+    uint32_t translucent;
+    uint32_t translucent_modifier_volume;
+    uint32_t punch_through;
+  } list_pointer;
+} region_array_entry;
+static_assert((sizeof (struct region_array_entry)) == 4 * 6);
+
+/*
+  DCDBSysArc990907E.pdf page 216-217 describes the REGION_ARRAY__ bit fields:
+ */
+#define REGION_ARRAY__TILE__LAST_REGION (1u << 31)
+#define REGION_ARRAY__TILE__Z_CLEAR_DISABLE (1 << 30)
+#define REGION_ARRAY__TILE__FLUSH_DISABLE (1 << 28)
+#define REGION_ARRAY__TILE__Y_POSITION(n) (((n) & 0x3f) << 8)
+#define REGION_ARRAY__TILE__X_POSITION(n) (((n) & 0x3f) << 2)
+
+#define REGION_ARRAY__LIST_POINTER__EMPTY (1u << 31)
+#define REGION_ARRAY__LIST_POINTER__OBJECT_LIST(n) (((n) & 0xfffffc) << 0)
+
+// list_pointer, indexed by TA_ALLOC__* list type
+static_assert(offsetof(struct region_array_entry, list_pointer.punch_through)
+              - offsetof(struct region_array_entry, list_pointer.opaque) == 4 * TA_ALLOC__PUNCH_THROUGH);
+
+// one bit per tile, for the first 600 tiles (640×480); larger tile counts
+// (the binner allows 1200) are never in a set
+#define REGION_ARRAY__TILE_SET_TILES 600
+#define REGION_ARRAY__TILE_SET_WORDS ((REGION_ARRAY__TILE_SET_TILES + 31) / 32)
+
+static inline uint32_t region_array_list_pointer(const ta_alloc * alloc, uint32_t object_list_start,
+                                                 int list, int x, int y)
+{
+  if (!ta_alloc_list_used(alloc, list))
+    return REGION_ARRAY__LIST_POINTER__EMPTY;
+
+  return REGION_ARRAY__LIST_POINTER__OBJECT_LIST(object_list_start + ta_alloc_opb_offset(alloc, list, x, y));
+}
+
+static inline void region_array_entry_write(volatile region_array_entry * entry, uint32_t tile,
+                                            uint32_t object_list_start, const ta_alloc * alloc,
+                                            int x, int y)
+{
+  entry->tile = tile
+              | REGION_ARRAY__TILE__Y_POSITION(y)
+              | REGION_ARRAY__TILE__X_POSITION(x);
+
+  entry->list_pointer.opaque                      = region_array_list_pointer(alloc, object_list_start, TA_ALLOC__OPAQUE, x, y);
+  entry->list_pointer.opaque_modifier_volume      = region_array_list_pointer(alloc, object_list_start, TA_ALLOC__OPAQUE_MODIFIER_VOLUME, x, y);
+  entry->list_pointer.translucent                 = region_array_list_pointer(alloc, object_list_start, TA_ALLOC__TRANSLUCENT, x, y);
+  entry->list_pointer.translucent_modifier_volume = region_array_list_pointer(alloc, object_list_start, TA_ALLOC__TRANSLUCENT_MODIFIER_VOLUME, x, y);
+  entry->list_pointer.punch_through               = region_array_list_pointer(alloc, object_list_start, TA_ALLOC__PUNCH_THROUGH, x, y);
+}
+
+/*
+  Write one region array entry per tile of `alloc`, at `region_array` (an
+  address in the "32-bit" texture memory view; Holly reads the region array
+  from "32-bit" texture memory address space), for object lists built by the
+  TA at `object_list_start`.
+ */
+void region_array_transfer(uint32_t region_array, uint32_t object_list_start, const ta_alloc * alloc)
+{
+  volatile region_array_entry * entry = (volatile region_array_entry *)(uintptr_t)region_array;
+
+  for (int y = 0; y < alloc->tile_y_num; y++) {
+    for (int x = 0; x < alloc->tile_x_num; x++) {
+      bool last_tile = (y == alloc->tile_y_num - 1) && (x == alloc->tile_x_num - 1);
+
+      region_array_entry_write(entry, last_tile ? REGION_ARRAY__TILE__LAST_REGION : 0,
+                               object_list_start, alloc, x, y);
+      entry += 1;
+    }
+  }
+}
+
+/*
+  As region_array_transfer, but with two entries per tile: the object lists of
+  `retained` (built by the TA at `retained_object_list_start`), then the
+  object lists of `alloc`, rendered over them. `retained` must have the same
+  tile counts as `alloc`. The region array is twice as large.
+
+  The `retained_empty_list` pointer of each tile in `retained_empty` (a tile
+  set, see region_array_empty_tiles) is EMPTY, so that CORE does not read
+  that list's empty object list; `retained_empty` may be NULL.
+ */
+void region_array_transfer_retained(uint32_t region_array, uint32_t object_list_start, const ta_alloc * alloc,
+                                    uint32_t retained_object_list_start, const ta_alloc * retained,
+                                    const uint32_t * retained_empty, int retained_empty_list)
+{
+  volatile region_array_entry * entry = (volatile region_array_entry *)(uintptr_t)region_array;
+
+  int tile = 0;
+  for (int y = 0; y < alloc->tile_y_num; y++) {
+    for (int x = 0; x < alloc->tile_x_num; x++, tile++) {
+      bool last_tile = (y == alloc->tile_y_num - 1) && (x == alloc->tile_x_num - 1);
+
+      // the retained lists are rendered first, and kept in the tile buffer
+      region_array_entry_write(&entry[0], REGION_ARRAY__TILE__FLUSH_DISABLE,
+                               retained_object_list_start, retained, x, y);
+      if (retained_empty && tile < REGION_ARRAY__TILE_SET_TILES
+          && (retained_empty[tile >> 5] & (1u << (tile & 31)))) {
+        volatile uint32_t * list_pointer = &entry[0].list_pointer.opaque;
+        list_pointer[retained_empty_list] = REGION_ARRAY__LIST_POINTER__EMPTY;
+      }
+
+      // the background was drawn by the first entry; the depth buffer is kept
+      region_array_entry_write(&entry[1], (last_tile ? REGION_ARRAY__TILE__LAST_REGION : 0)
+                                        | REGION_ARRAY__TILE__Z_CLEAR_DISABLE,
+                               object_list_start, alloc, x, y);
+      entry += 2;
+    }
+  }
+}
+
+/*
+  Set bit `tile` of `empty` (REGION_ARRAY__TILE_SET_WORDS words) for every
+  tile in which the list that the TA built last has no objects. The TA must
+  have finished that list. Tiles past REGION_ARRAY__TILE_SET_TILES are not
+  included, as if they had objects.
+ */
+void region_array_empty_tiles(const ta_alloc * alloc, uint32_t * empty)
+{
+  int tile_count = alloc->tile_x_num * alloc->tile_y_num;
+  if (tile_count > REGION_ARRAY__TILE_SET_TILES)
+    tile_count = REGION_ARRAY__TILE_SET_TILES;
+
+  for (int i = 0; i < REGION_ARRAY__TILE_SET_WORDS; i++)
+    empty[i] = 0;
+
+  for (int tile = 0; tile < tile_count; tile++) {
+    if (!(TA_OL_POINTERS[tile] & TA_OL_POINTERS__ENTRY))
+      empty[tile >> 5] |= 1u << (tile & 31);
+  }
+}
+
+static inline void region_array_update_empty_entries(volatile region_array_entry * entry, int stride,
+                                                     uint32_t object_list_start, const ta_alloc * alloc,
+                                                     int list, const uint32_t * empty, uint32_t * current)
+{
+  int tile = 0;
+  for (int y = 0; y < alloc->tile_y_num; y++) {
+    for (int x = 0; x < alloc->tile_x_num && tile < REGION_ARRAY__TILE_SET_TILES; x++, tile++) {
+      uint32_t bit = 1u << (tile & 31);
+      uint32_t changed = (empty[tile >> 5] ^ current[tile >> 5]) & bit;
+      if (!changed)
+        continue;
+
+      volatile uint32_t * list_pointer = &entry[tile * stride].list_pointer.opaque;
+      list_pointer[list] = (empty[tile >> 5] & bit)
+                         ? REGION_ARRAY__LIST_POINTER__EMPTY
+                         : region_array_list_pointer(alloc, object_list_start, list, x, y);
+      current[tile >> 5] ^= bit;
+    }
+  }
+}
+
+/*
+  Point `list` of each tile at the tile's object list, or, for each tile in
+  `empty`, at REGION_ARRAY__LIST_POINTER__EMPTY. `current` is the set of
+  tiles whose `list` pointer is already EMPTY; it is updated. Only entries
+  that change are written.
+
+  `region_array` is a single-entry region array of region_array_transfer;
+  all of `current` is clear after region_array_transfer.
+ */
+void region_array_update_empty(uint32_t region_array, uint32_t object_list_start, const ta_alloc * alloc,
+                               int list, const uint32_t * empty, uint32_t * current)
+{
+  volatile region_array_entry * entry = (volatile region_array_entry *)(uintptr_t)region_array;
+
+  region_array_update_empty_entries(entry, 1, object_list_start, alloc, list, empty, current);
+}
+
+/*
+  As region_array_update_empty, for a two-entry region array of
+  region_array_transfer_retained: the second entry of each tile (the object
+  lists of `alloc`) is updated; the retained entries are not.
+ */
+void region_array_update_empty_retained(uint32_t region_array, uint32_t object_list_start, const ta_alloc * alloc,
+                                        int list, const uint32_t * empty, uint32_t * current)
+{
+  volatile region_array_entry * entry = (volatile region_array_entry *)(uintptr_t)region_array;
+
+  region_array_update_empty_entries(&entry[1], 2, object_list_start, alloc, list, empty, current);
+}
@@ -0,0 +1,617 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#include "display.h"
+#include "holly.h"
+#include "interrupt.h"
+#include "region_array.h"
+#include "ta_alloc.h"
+
+/*
+  Pipelined TA/CORE frame scheduler
+
+  Without pipelining, the CPU, TA and CORE take turns: the TA can not begin
+  building frame N + 1 until CORE has finished reading the object lists and
+  ISP/TSP parameters of frame N, because both frames would use the same
+  texture memory.
+
+  The scheduler instead alternates between two "frame sets", each with its own
+  object list, ISP/TSP parameter area and region array. While CORE renders
+  frame N from one set, the CPU and TA build frame N + 1 in the other:
+
+    CPU/TA:  | frame N   | frame N+1 | frame N+2 |
+    CORE:                | frame N   | frame N+1 |
+    display:                         | frame N   | frame N+1 |
+
+  A frame set is only reused by the TA after the render that read from it has
+  completed. Framebuffers, and the display of each completed frame, are
+  managed by display.h.
+
+  Every wait is done through interrupt.h; with SCHEDULER__INTERRUPTS and
+  SCHEDULER__TA_ERRORS enabled by interrupt_init, the CPU does not read ISTNRM
+  or ISTERR while waiting. display_init must be called before the first
+  frame.
+
+  Each frame is submitted as:
+
+    do {
+      scheduler_ta_begin(&scheduler);
+      // ... write TA parameters ...
+      ta_stream_wait();
+    } while (scheduler_ta_end(&scheduler, ISTNRM__END_OF_TRANSFERRING_OPAQUE_LIST) == SCHEDULER__RETRY);
+
+  followed, after the last frame, by scheduler_finish.
+
+  The object list and ISP/TSP parameter areas of each frame set have a fixed
+  capacity (SCHEDULER__OBJECT_LIST_SIZE, SCHEDULER__ISP_TSP_PARAMETER_SIZE),
+  but the TA is only given a budget of each (TA_OL_LIMIT, TA_ISP_LIMIT): twice
+  what the previous frame used, plus SCHEDULER__BUDGET_HEADROOM. The OPB size
+  of each list also follows the previous frame (ta_alloc_adapt, see
+  ta_alloc.h); scheduler_ta_begin rewrites the region array of a frame set
+  whenever the OPB sizes have changed since it was last written.
+
+  The OPB links used by each list are measured by sampling TA_NEXT_OPB at
+  each end of list interrupt (scheduler_list_end); lists whose end of list
+  event is not enabled by interrupt_init are measured together.
+
+  While waiting for the TA, scheduler_ta_end also waits for TA errors, and
+  checks for them again just before the render is started: the TA may report
+  an overflow after the end of list event of the last list. When the TA
+  overflows its budget, the TA is reset, the budget is raised to the full
+  capacity, and the frame must be submitted again (SCHEDULER__RETRY). A frame
+  that overflows the full capacity, or that the TA rejects, is not rendered
+  (SCHEDULER__DROPPED); the previous frame continues to be displayed.
+
+  The background ISP/TSP parameter of each frame set is written once by the
+  caller; it does not change from frame to frame.
+
+  Geometry that does not change from frame to frame (a static background, UI,
+  or a scene seen from a camera that has not moved) can instead be "retained":
+  submitted to the TA once, between scheduler_retain_begin and
+  scheduler_retain_end, into its own object list area (scheduler_retained).
+  Every following frame renders the retained lists first, then its own lists
+  over them (see region_array_transfer_retained), without the CPU or the TA
+  touching the retained geometry again. The retained lists are replaced by
+  building them again, or removed by scheduler_release.
+
+  Only opaque, opaque modifier volume and punch through lists can be retained.
+  A translucent list must be rendered after every opaque object of the tile,
+  and the retained lists are rendered before the frame's; scheduler_retain_end
+  rejects a retained alloc with translucent lists.
+
+  CORE walks each tile twice, once per region array entry. When a single list
+  is retained, the retained pointer of every tile in which the retained build
+  has no objects is EMPTY (from TA_OL_POINTERS, which only describes the last
+  list the TA built), so that the first walk of those tiles reads no object
+  list. With several retained lists, every tile's retained object lists are
+  read, empty or not.
+
+  Object lists address ISP/TSP parameters relative to PARAM_BASE, so the
+  retained ISP/TSP parameters are copied, once, to the same offset in the
+  ISP/TSP parameter area of every frame set. Each area is then laid out as:
+
+    background | retained ISP/TSP parameters | ISP/TSP parameters of the frame
+               ^ scheduler_retained          ^ isp_tsp_parameter_offset
+                 isp_tsp_parameter_offset
+ */
+
+#define SCHEDULER__FRAME_SETS 2
+
+#define SCHEDULER__LIST_END_EVENTS (ISTNRM__END_OF_TRANSFERRING_OPAQUE_LIST \
+                                  | ISTNRM__END_OF_TRANSFERRING_OPAQUE_MODIFIER_VOLUME_LIST \
+                                  | ISTNRM__END_OF_TRANSFERRING_TRANSLUCENT_LIST \
+                                  | ISTNRM__END_OF_TRANSFERRING_TRANSLUCENT_MODIFIER_VOLUME_LIST \
+                                  | ISTNRM__END_OF_TRANSFERRING_PUNCH_THROUGH_LIST)
+
+// the ISTNRM events waited for by the scheduler, for interrupt_init
+#define SCHEDULER__INTERRUPTS (DISPLAY__INTERRUPTS | SCHEDULER__LIST_END_EVENTS)
+
+// the TA errors that scheduler_ta_end recovers from (ISTERR bits), for
+// interrupt_init
+#define SCHEDULER__TA_OVERFLOW (ISTERR__TA_ISP_TSP_PARAMETER_OVERFLOW \
+                              | ISTERR__TA_OBJECT_LIST_POINTER_OVERFLOW)
+#define SCHEDULER__TA_ERRORS (SCHEDULER__TA_OVERFLOW \
+                            | ISTERR__TA_ILLEGAL_PARAMETER \
+                            | ISTERR__TA_FIFO_OVERFLOW)
+
+// the object list and ISP/TSP parameter area sizes (capacities) of each frame
+// set
+#define SCHEDULER__OBJECT_LIST_SIZE 0x40000
+#define SCHEDULER__ISP_TSP_PARAMETER_SIZE 0x80000
+
+// the budget of each area, beyond twice the previous frame's usage
+#define SCHEDULER__BUDGET_HEADROOM 0x4000
+
+// the "32-bit" texture memory address space, as texture_memory32 in each
+// program
+#define SCHEDULER__TEXTURE_MEMORY32 0xa5000000
+
+// scheduler_ta_end results
+#define SCHEDULER__RENDERED 0
+#define SCHEDULER__RETRY 1
+#define SCHEDULER__DROPPED 2
+
+typedef struct frame_set {
+  // all of the following are addresses in "32-bit" texture memory address
+  // space
+  uint32_t object_list_start;
+  uint32_t isp_tsp_parameter_start; // PARAM_BASE; must be 1 MiB aligned
+  uint32_t region_array_start;
+
+  // the OPB layout described by the region array
+  ta_alloc alloc;
+} frame_set;
+
+/*
+  Lists built once by the TA, and rendered under every frame.
+ */
+typedef struct scheduler_retained {
+  // the object list area, in "32-bit" texture memory address space; separate
+  // from the object lists of every frame set
+  uint32_t object_list_start;
+  uint32_t object_list_size;
+
+  // the ISP/TSP parameter area, relative to the isp_tsp_parameter_start of
+  // every frame set; it must end before the scheduler's
+  // isp_tsp_parameter_offset
+  uint32_t isp_tsp_parameter_offset;
+  uint32_t isp_tsp_parameter_size;
+
+  // the OPB layout of the retained lists; the same tile counts as the frames
+  ta_alloc alloc;
+
+  // the area used by the last build, set by scheduler_retain_end
+  uint32_t object_list_used;
+  uint32_t isp_tsp_parameter_used;
+
+  // the tiles in which the last build has no objects, in list `empty_list`;
+  // -1 if there is more than one retained list (see above)
+  uint32_t empty[REGION_ARRAY__TILE_SET_WORDS];
+  int empty_list;
+} scheduler_retained;
+
+typedef struct scheduler {
+  frame_set set[SCHEDULER__FRAME_SETS];
+
+  // rendered under every frame, or NULL; see scheduler_retain_end
+  const scheduler_retained * retained;
+
+  // the offset, relative to isp_tsp_parameter_start, of the first ISP/TSP
+  // parameter written by the TA; parameters before this offset (for example
+  // the background) are written by the CPU
+  uint32_t isp_tsp_parameter_offset;
+
+  // the frame currently being built by the TA; the set used by each frame is
+  // `frame % SCHEDULER__FRAME_SETS`
+  uint32_t frame;
+
+  // CORE is rendering `frame - 1`
+  bool render_in_flight;
+
+  // the OPB sizes of the next frame
+  ta_alloc_adaptive adaptive;
+
+  // the object list and ISP/TSP parameter area sizes given to the TA for the
+  // next frame; at most SCHEDULER__OBJECT_LIST_SIZE and
+  // SCHEDULER__ISP_TSP_PARAMETER_SIZE
+  uint32_t object_list_budget;
+  uint32_t isp_tsp_parameter_budget;
+
+  // the largest object list and ISP/TSP parameter area used by any frame
+  uint32_t object_list_peak;
+  uint32_t isp_tsp_parameter_peak;
+
+  uint32_t frames_retried;
+  uint32_t frames_dropped;
+} scheduler;
+
+/*
+  TA_NEXT_OPB at the end of each list of the frame being built, sampled by
+  scheduler_list_end.
+ */
+typedef struct scheduler_list_end_sample {
+  // the ISTNRM__END_OF_TRANSFERRING_* events that have been sampled
+  uint32_t ended;
+  uint32_t next_opb[TA_ALLOC__LIST_COUNT];
+} scheduler_list_end_sample;
+
+volatile scheduler_list_end_sample scheduler_list_end_state;
+
+static inline frame_set * scheduler_set(scheduler * s, uint32_t frame)
+{
+  return &s->set[frame % SCHEDULER__FRAME_SETS];
+}
+
+/*
+  The interrupt callback of every end of list event. interrupt_dispatch has
+  already added the event to `interrupt_events`; the TA may have started the
+  next list in the meantime, so the sample is approximate.
+ */
+void scheduler_list_end()
+{
+  uint32_t next_opb = *TA_NEXT_OPB;
+  uint32_t ended = interrupt_events & SCHEDULER__LIST_END_EVENTS & ~scheduler_list_end_state.ended;
+
+  for (int list = 0; list < TA_ALLOC__LIST_COUNT; list++) {
+    if (ended & ta_alloc_list_end_event(list))
+      scheduler_list_end_state.next_opb[list] = next_opb;
+  }
+  scheduler_list_end_state.ended |= ended;
+}
+
+static inline uint32_t scheduler_round_up(uint32_t size)
+{
+  return (size + 31) & ~31;
+}
+
+/*
+  Write the region array of `set`, for its OPB layout and the retained lists
+  (if any).
+ */
+void scheduler_region_array_transfer(const scheduler * s, const frame_set * set)
+{
+  uint32_t region_array = SCHEDULER__TEXTURE_MEMORY32 + set->region_array_start;
+
+  if (s->retained)
+    region_array_transfer_retained(region_array, set->object_list_start, &set->alloc,
+                                   s->retained->object_list_start, &s->retained->alloc,
+                                   s->retained->empty_list >= 0 ? s->retained->empty : NULL,
+                                   s->retained->empty_list);
+  else
+    region_array_transfer(region_array, set->object_list_start, &set->alloc);
+}
+
+/*
+  `alloc` is the OPB layout of the first frame, and of every frame set; its
+  region array is written for each frame set.
+ */
+void scheduler_init(scheduler * s, const ta_alloc * alloc)
+{
+  s->frame = 0;
+  s->render_in_flight = false;
+  s->retained = NULL;
+
+  for (int list = 0; list < TA_ALLOC__LIST_COUNT; list++) {
+    s->adaptive.opb_words[list] = alloc->opb_words[list];
+    s->adaptive.quiet_frames[list] = 0;
+  }
+
+  for (int i = 0; i < SCHEDULER__FRAME_SETS; i++) {
+    frame_set * set = &s->set[i];
+    set->alloc = *alloc;
+    scheduler_region_array_transfer(s, set);
+  }
+
+  // there is no measurement before the first frame
+  s->object_list_budget = SCHEDULER__OBJECT_LIST_SIZE;
+  s->isp_tsp_parameter_budget = SCHEDULER__ISP_TSP_PARAMETER_SIZE;
+  s->object_list_peak = 0;
+  s->isp_tsp_parameter_peak = 0;
+  s->frames_retried = 0;
+  s->frames_dropped = 0;
+
+  interrupt_set_callback(SCHEDULER__LIST_END_EVENTS, scheduler_list_end);
+
+  // discard stale status from before the scheduler was started
+  interrupt_error_clear(SCHEDULER__TA_ERRORS);
+  interrupt_clear(ISTNRM__END_OF_RENDER_TSP
+                  | ISTNRM__END_OF_RENDER_ISP
+                  | ISTNRM__END_OF_RENDER_VIDEO
+                  | SCHEDULER__LIST_END_EVENTS);
+}
+
+/*
+  Point the TA at the frame set of the next frame, and initialize it.
+
+  The set was last read by the render of `frame - 2`, which scheduler_ta_end
+  waited for before starting the render of `frame - 1`; its region array can
+  be rewritten.
+ */
+void scheduler_ta_begin(scheduler * s)
+{
+  frame_set * set = scheduler_set(s, s->frame);
+
+  if (!ta_alloc_equal(&set->alloc, s->adaptive.opb_words)) {
+    set->alloc = ta_alloc_init(set->alloc.tile_x_num, set->alloc.tile_y_num, s->adaptive.opb_words);
+    scheduler_region_array_transfer(s, set);
+  }
+
+  *TA_ALLOC_CTRL = ta_alloc_ctrl(&set->alloc);
+
+  *TA_ISP_BASE = set->isp_tsp_parameter_start + s->isp_tsp_parameter_offset;
+  *TA_ISP_LIMIT = set->isp_tsp_parameter_start + s->isp_tsp_parameter_budget;
+
+  *TA_OL_BASE = set->object_list_start;
+  // TA_OL_LIMIT must not be used for other data; see DCDBSysArc990907E.pdf
+  // page 385.
+  *TA_OL_LIMIT = set->object_list_start + s->object_list_budget - 32;
+  // OPB links are allocated after the OPBs of every tile (see ta_alloc.h)
+  *TA_NEXT_OPB_INIT = set->object_list_start + set->alloc.size;
+
+  scheduler_list_end_state.ended = 0;
+
+  // TA_LIST_INIT needs to be written (every frame) prior to the first FIFO
+  // write.
+  *TA_LIST_INIT = TA_LIST_INIT__LIST_INIT;
+
+  // dummy TA_LIST_INIT read; DCDBSysArc990907E.pdf in multiple places says this
+  // step is required.
+  (void)*TA_LIST_INIT;
+}
+
+static inline void scheduler_render_wait()
+{
+  interrupt_wait(ISTNRM__END_OF_RENDER_TSP);
+}
+
+/*
+  The OPB links used by each list of `alloc`, from the samples of
+  scheduler_list_end; `next_opb` is TA_NEXT_OPB after the last list. A list
+  that was not sampled is charged every link since the previous sample.
+ */
+ta_alloc_usage scheduler_usage(const ta_alloc * alloc, uint32_t next_opb_init, uint32_t next_opb)
+{
+  ta_alloc_usage usage;
+
+  for (int list = 0; list < TA_ALLOC__LIST_COUNT; list++) {
+    usage.link_bytes[list] = 0;
+    if (!ta_alloc_list_used(alloc, list))
+      continue;
+
+    bool sampled = scheduler_list_end_state.ended & ta_alloc_list_end_event(list);
+    uint32_t end = sampled ? scheduler_list_end_state.next_opb[list] : next_opb;
+
+    // the list began at the latest earlier sample of another list
+    uint32_t start = next_opb_init;
+    for (int other = 0; other < TA_ALLOC__LIST_COUNT; other++) {
+      if (other == list || !(scheduler_list_end_state.ended & ta_alloc_list_end_event(other)))
+        continue;
+      uint32_t sample = scheduler_list_end_state.next_opb[other];
+      if (sample > start && sample < end)
+        start = sample;
+    }
+
+    usage.link_bytes[list] = end - start;
+  }
+
+  return usage;
+}
+
+static inline void scheduler_ta_reset(uint32_t list_end_mask, uint32_t error)
+{
+  *SOFTRESET = SOFTRESET__TA_SOFT_RESET;
+  *SOFTRESET = 0;
+
+  interrupt_error_clear(error);
+  interrupt_clear(list_end_mask);
+}
+
+/*
+  Wait until the TA has finished every list in `list_end_mask`, or has raised
+  a TA error; returns the error (ISTERR__TA_*), if any.
+ */
+static inline uint32_t scheduler_ta_wait(uint32_t list_end_mask)
+{
+  while (interrupt_status(list_end_mask) != list_end_mask) {
+    uint32_t error = interrupt_error_status(SCHEDULER__TA_ERRORS);
+    if (error)
+      return error;
+  }
+  // an error may have been raised along with the last end of list event
+  return interrupt_error_status(SCHEDULER__TA_ERRORS);
+}
+
+/*
+  Reset the TA after `error` (ISTERR__TA_*), and decide whether the frame is
+  submitted again.
+ */
+int scheduler_ta_error(scheduler * s, uint32_t list_end_mask, uint32_t error)
+{
+  scheduler_ta_reset(list_end_mask, error);
+
+  bool at_capacity = s->object_list_budget == SCHEDULER__OBJECT_LIST_SIZE
+                  && s->isp_tsp_parameter_budget == SCHEDULER__ISP_TSP_PARAMETER_SIZE;
+
+  if ((error & ~SCHEDULER__TA_OVERFLOW) == 0 && !at_capacity) {
+    s->object_list_budget = SCHEDULER__OBJECT_LIST_SIZE;
+    s->isp_tsp_parameter_budget = SCHEDULER__ISP_TSP_PARAMETER_SIZE;
+    s->frames_retried += 1;
+    return SCHEDULER__RETRY;
+  }
+
+  s->frames_dropped += 1;
+  return SCHEDULER__DROPPED;
+}
+
+/*
+  The budgets of the next frame, from this frame's usage (including the OPBs
+  allocated up front for the next frame's OPB sizes).
+ */
+void scheduler_budget(scheduler * s, const frame_set * set, uint32_t link_bytes, uint32_t isp_tsp_parameter_end)
+{
+  uint32_t object_list_used = set->alloc.size + link_bytes;
+  uint32_t isp_tsp_parameter_used = isp_tsp_parameter_end - set->isp_tsp_parameter_start;
+
+  if (object_list_used > s->object_list_peak)
+    s->object_list_peak = object_list_used;
+  if (isp_tsp_parameter_used > s->isp_tsp_parameter_peak)
+    s->isp_tsp_parameter_peak = isp_tsp_parameter_used;
+
+  const ta_alloc next = ta_alloc_init(set->alloc.tile_x_num, set->alloc.tile_y_num, s->adaptive.opb_words);
+  uint32_t object_list_budget = scheduler_round_up(next.size + link_bytes * 2 + SCHEDULER__BUDGET_HEADROOM);
+  uint32_t isp_tsp_parameter_budget = scheduler_round_up(isp_tsp_parameter_used * 2 + SCHEDULER__BUDGET_HEADROOM);
+
+  s->object_list_budget = object_list_budget < SCHEDULER__OBJECT_LIST_SIZE
+                        ? object_list_budget : SCHEDULER__OBJECT_LIST_SIZE;
+  s->isp_tsp_parameter_budget = isp_tsp_parameter_budget < SCHEDULER__ISP_TSP_PARAMETER_SIZE
+                              ? isp_tsp_parameter_budget : SCHEDULER__ISP_TSP_PARAMETER_SIZE;
+}
+
+/*
+  Wait for the TA to finish building every list in `list_end_mask` (a
+  combination of ISTNRM__END_OF_TRANSFERRING_*), then, once CORE has finished
+  the previous frame and a framebuffer is available (display_render_begin),
+  start rendering this frame. Every parameter of the frame must have been
+  handed to the TA (ta_stream_wait) first.
+
+  Returns SCHEDULER__RENDERED with the TA free to build the next frame, or
+  SCHEDULER__RETRY or SCHEDULER__DROPPED after a TA error (see above).
+ */
+int scheduler_ta_end(scheduler * s, uint32_t list_end_mask)
+{
+  uint32_t error = scheduler_ta_wait(list_end_mask);
+  if (error)
+    return scheduler_ta_error(s, list_end_mask, error);
+  interrupt_clear(list_end_mask);
+
+  frame_set * set = scheduler_set(s, s->frame);
+
+  uint32_t next_opb_init = set->object_list_start + set->alloc.size;
+  uint32_t next_opb = *TA_NEXT_OPB;
+  ta_alloc_usage usage = scheduler_usage(&set->alloc, next_opb_init, next_opb);
+  ta_alloc_adapt(&s->adaptive, &set->alloc, &usage);
+  scheduler_budget(s, set, next_opb - next_opb_init, *TA_ITP_CURRENT);
+
+  // the render end callback in display.h queues the previous frame for
+  // display
+  if (s->render_in_flight) {
+    scheduler_render_wait();
+    s->render_in_flight = false;
+  }
+
+  // an error raised after the last end of list event; the object lists are
+  // incomplete, and must not be rendered
+  error = interrupt_error_status(SCHEDULER__TA_ERRORS);
+  if (error)
+    return scheduler_ta_error(s, list_end_mask, error);
+
+  *REGION_BASE = set->region_array_start;
+  *PARAM_BASE = set->isp_tsp_parameter_start;
+  display_render_begin();
+  *STARTRENDER = 1;
+
+  s->render_in_flight = true;
+  s->frame += 1;
+
+  return SCHEDULER__RENDERED;
+}
+
+/*
+  Wait for the render in flight, which may read the retained lists.
+ */
+static inline void scheduler_render_idle(scheduler * s)
+{
+  if (s->render_in_flight) {
+    scheduler_render_wait();
+    s->render_in_flight = false;
+  }
+}
+
+/*
+  Point the TA at the retained area `r`, in place of the next frame. The
+  retained lists are then submitted as the lists of a frame are, and ended by
+  scheduler_retain_end; they are only rendered under the frames that follow.
+ */
+void scheduler_retain_begin(scheduler * s, scheduler_retained * r)
+{
+  scheduler_render_idle(s);
+
+  // the previous retained lists, if any, are overwritten; the region arrays
+  // are rewritten by scheduler_retain_end
+  s->retained = NULL;
+
+  uint32_t isp_tsp_parameter_start = s->set[0].isp_tsp_parameter_start + r->isp_tsp_parameter_offset;
+
+  *TA_ALLOC_CTRL = ta_alloc_ctrl(&r->alloc);
+
+  *TA_ISP_BASE = isp_tsp_parameter_start;
+  *TA_ISP_LIMIT = isp_tsp_parameter_start + r->isp_tsp_parameter_size;
+
+  *TA_OL_BASE = r->object_list_start;
+  *TA_OL_LIMIT = r->object_list_start + r->object_list_size - 32;
+  *TA_NEXT_OPB_INIT = r->object_list_start + r->alloc.size;
+
+  *TA_LIST_INIT = TA_LIST_INIT__LIST_INIT;
+  (void)*TA_LIST_INIT;
+}
+
+/*
+  Wait for the TA to finish building every retained list in `list_end_mask`,
+  copy the retained ISP/TSP parameters to every other frame set, and render
+  the retained lists under every following frame.
+
+  Returns false after a TA error (the retained areas are too small, or the TA
+  rejected a parameter), or if `r` uses a translucent list (see above); no
+  retained lists are rendered.
+ */
+bool scheduler_retain_end(scheduler * s, scheduler_retained * r, uint32_t list_end_mask)
+{
+  uint32_t error = scheduler_ta_wait(list_end_mask);
+  if (error)
+    scheduler_ta_reset(list_end_mask, error);
+  else
+    interrupt_clear(list_end_mask);
+
+  bool translucent = ta_alloc_list_used(&r->alloc, TA_ALLOC__TRANSLUCENT)
+                  || ta_alloc_list_used(&r->alloc, TA_ALLOC__TRANSLUCENT_MODIFIER_VOLUME);
+  if (error || translucent) {
+    for (int i = 0; i < SCHEDULER__FRAME_SETS; i++)
+      scheduler_region_array_transfer(s, &s->set[i]);
+    return false;
+  }
+
+  // TA_OL_POINTERS describes the list that the TA built last, which is only
+  // known when there is one
+  int lists = 0;
+  for (int list = 0; list < TA_ALLOC__LIST_COUNT; list++) {
+    if (ta_alloc_list_used(&r->alloc, list)) {
+      r->empty_list = list;
+      lists += 1;
+    }
+  }
+  if (lists == 1)
+    region_array_empty_tiles(&r->alloc, r->empty);
+  else
+    r->empty_list = -1;
+
+  uint32_t isp_tsp_parameter_start = s->set[0].isp_tsp_parameter_start + r->isp_tsp_parameter_offset;
+  r->isp_tsp_parameter_used = *TA_ITP_CURRENT - isp_tsp_parameter_start;
+  r->object_list_used = *TA_NEXT_OPB - r->object_list_start;
+
+  const volatile uint32_t * src = (const volatile uint32_t *)(SCHEDULER__TEXTURE_MEMORY32 + isp_tsp_parameter_start);
+  for (int i = 1; i < SCHEDULER__FRAME_SETS; i++) {
+    volatile uint32_t * dst = (volatile uint32_t *)(SCHEDULER__TEXTURE_MEMORY32 + s->set[i].isp_tsp_parameter_start + r->isp_tsp_parameter_offset);
+    for (uint32_t word = 0; word < r->isp_tsp_parameter_used / 4; word++)
+      dst[word] = src[word];
+  }
+
+  s->retained = r;
+  for (int i = 0; i < SCHEDULER__FRAME_SETS; i++)
+    scheduler_region_array_transfer(s, &s->set[i]);
+
+  return true;
+}
+
+/*
+  Stop rendering the retained lists under the following frames.
+ */
+void scheduler_release(scheduler * s)
+{
+  scheduler_render_idle(s);
+
+  s->retained = NULL;
+  for (int i = 0; i < SCHEDULER__FRAME_SETS; i++)
+    scheduler_region_array_transfer(s, &s->set[i]);
+}
+
+/*
+  Wait for the last render to complete, and to be displayed.
+ */
+void scheduler_finish(scheduler * s)
+{
+  scheduler_render_idle(s);
+  display_finish();
+}
@@ -0,0 +1,93 @@
+#pragma once
+
+#include <stdint.h>
+
+#include "sh7091.h"
+
+/*
+  Minimal SCIF output, for printing measurements.
+
+  Like serial.c, this does not configure the SCIF baud rate, and presumes it is
+  already configured for UART transmission by the serial loader.
+ */
+
+void scif_init()
+{
+  // set the transmit trigger to `1 byte`--this changes the behavior of TDFE
+  *SH7091__SCIF__SCFCR2 = SH7091__SCIF__SCFCR2__TTRG(0b11);
+}
+
+static inline void scif_character(const char c)
+{
+  // wait for transmit fifo to become partially empty
+  while ((*SH7091__SCIF__SCFSR2 & SH7091__SCIF__SCFSR2__TDFE) == 0);
+
+  // unset TDFE bit
+  *SH7091__SCIF__SCFSR2 &= ~SH7091__SCIF__SCFSR2__TDFE;
+
+  *SH7091__SCIF__SCFTDR2 = c;
+}
+
+void scif_string(const char * s)
+{
+  while (*s != 0) {
+    scif_character(*s++);
+  }
+}
+
+void scif_base16(uint32_t n, int len)
+{
+  char buf[len];
+  char * bufi = &buf[len - 1];
+
+  while (bufi >= buf) {
+    uint32_t nib = n & 0xf;
+    n = n >> 4;
+    if (nib > 9) {
+      nib += (97 - 10);
+    } else {
+      nib += (48 - 0);
+    }
+
+    *bufi = nib;
+    bufi -= 1;
+  }
+
+  for (int i = 0; i < len; i++) {
+    scif_character(buf[i]);
+  }
+}
+
+void scif_base10(uint32_t n)
+{
+  char buf[10];
+  int len = 0;
+
+  do {
+    buf[len++] = '0' + (n % 10);
+    n = n / 10;
+  } while (n != 0);
+
+  while (len > 0) {
+    scif_character(buf[--len]);
+  }
+}
+
+// print "label: value\n"
+void scif_label_base10(const char * label, uint32_t n)
+{
+  scif_string(label);
+  scif_string(": ");
+  scif_base10(n);
+  scif_character('\n');
+}
+
+void scif_flush()
+{
+  // hack: "flush" the previous characters before the serial loader resets the
+  // serial interface
+  //
+  // Other methods to detect "transmit fifo is empty" appear to be
+  // non-functional (including polling SCFDR2 or SCFSR2); see serial.c.
+  scif_string("  ");
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+/*
+  Data placement controls; see main.lds.
+
+  __hot_rodata / __hot_data / __hot_bss:
+
+    Groups frequently-accessed read-only tables and variables at the beginning
+    of their output section, so that (when CACHED=1) the working set of a
+    per-frame loop occupies a small number of contiguous cache lines.
+
+  __uncached:
+
+    Places a (zero-initialized) buffer in the .uncached section, which is
+    always linked at a P2 address. This is intended for buffers that are
+    written or read by DMA units, so that no ocbwb/ocbi cache maintenance is
+    needed. CPU accesses to these buffers are never cached, so this should not
+    be used for data the CPU accesses frequently.
+
+    .uncached is NOLOAD: initializers are not supported (the contents are
+    zero-filled by start.s instead).
+
+  __ocram0 / __ocram1:
+
+    Places a (zero-initialized) array in one of the two 4 KiB operand cache
+    RAM areas (see main.lds). Loads and stores to OCRAM never miss, and never
+    generate system memory traffic, which makes it suitable for small,
+    per-frame working sets: transformed vertices, matrices, or staging buffers.
+
+    OCRAM is only available when CACHED=1; otherwise these are equivalent to
+    __hot_bss. Like .uncached, initializers are not supported.
+ */
+
+#define __hot_rodata __attribute__((section(".rodata.hot")))
+#define __hot_data __attribute__((section(".data.hot")))
+#define __hot_bss __attribute__((section(".bss.hot")))
+
+#define __uncached __attribute__((section(".uncached"), aligned(32)))
+
+#if CACHED
+#define __ocram0 __attribute__((section(".ocram0"), aligned(32)))
+#define __ocram1 __attribute__((section(".ocram1"), aligned(32)))
+#else
+#define __ocram0 __hot_bss __attribute__((aligned(32)))
+#define __ocram1 __hot_bss __attribute__((aligned(32)))
+#endif
@@ -0,0 +1,95 @@
+#pragma once
+
+#include <stdint.h>
+
+/*
+  SH7091 (SH4) on-chip peripheral module registers
+
+  Register addresses and bit definitions are from sh7091pm_e.pdf (the SH7750
+  hardware manual).
+ */
+
+/******************************************************************************
+ CCN: cache and store queue control
+ ******************************************************************************/
+
+// sh7091pm_e.pdf printed page 50
+volatile uint32_t * SH7091__CCN__CCR = (volatile uint32_t *)(0xff000000 + 0x1c);
+
+#define SH7091__CCN__CCR__IIX (1 << 15)
+#define SH7091__CCN__CCR__ICI (1 << 11)
+#define SH7091__CCN__CCR__ICE (1 << 8)
+#define SH7091__CCN__CCR__OIX (1 << 7)
+#define SH7091__CCN__CCR__ORA (1 << 5)
+#define SH7091__CCN__CCR__OCI (1 << 3)
+#define SH7091__CCN__CCR__CB (1 << 2)
+#define SH7091__CCN__CCR__WT (1 << 1)
+#define SH7091__CCN__CCR__OCE (1 << 0)
+
+// sh7091pm_e.pdf printed page 63
+volatile uint32_t * SH7091__CCN__QACR0 = (volatile uint32_t *)(0xff000000 + 0x38);
+volatile uint32_t * SH7091__CCN__QACR1 = (volatile uint32_t *)(0xff000000 + 0x3c);
+
+// QACR0/QACR1 supply external address bits [28:26] for store queue transfers
+#define SH7091__CCN__QACR__AREA(address) (((address) >> 24) & 0b11100)
+
+// sh7091pm_e.pdf:
+//  > Issuing a PREF instruction for P4 area H'E000 0000 to H'E3FF FFFC starts a
+//  > burst transfer from the SQs to external memory.
+#define pref(address) \
+  { asm volatile ("pref @%0" : : "r" (address) : "memory"); }
+
+/******************************************************************************
+ DMAC: direct memory access controller
+ ******************************************************************************/
+
+// sh7091pm_e.pdf printed page 459
+volatile uint32_t * SH7091__DMAC__SAR2    = (volatile uint32_t *)(0xffa00000 + 0x20);
+volatile uint32_t * SH7091__DMAC__DAR2    = (volatile uint32_t *)(0xffa00000 + 0x24);
+volatile uint32_t * SH7091__DMAC__DMATCR2 = (volatile uint32_t *)(0xffa00000 + 0x28);
+volatile uint32_t * SH7091__DMAC__CHCR2   = (volatile uint32_t *)(0xffa00000 + 0x2c);
+volatile uint32_t * SH7091__DMAC__DMAOR   = (volatile uint32_t *)(0xffa00000 + 0x40);
+
+#define SH7091__DMAC__CHCR__DM__FIXED (0b00 << 14)
+#define SH7091__DMAC__CHCR__SM__INCREMENTED (0b01 << 12)
+#define SH7091__DMAC__CHCR__RS__EXTERNAL_SINGLE_ADDRESS (0b0010 << 8)
+#define SH7091__DMAC__CHCR__TM__BURST (1 << 7)
+#define SH7091__DMAC__CHCR__TS__32_BYTE (0b100 << 4)
+#define SH7091__DMAC__CHCR__IE (1 << 2)
+#define SH7091__DMAC__CHCR__TE (1 << 1)
+#define SH7091__DMAC__CHCR__DE (1 << 0)
+
+#define SH7091__DMAC__DMAOR__DDT (1 << 15)
+#define SH7091__DMAC__DMAOR__PR__ROUND_ROBIN (0b10 << 8)
+#define SH7091__DMAC__DMAOR__AE (1 << 2)
+#define SH7091__DMAC__DMAOR__NMIF (1 << 1)
+#define SH7091__DMAC__DMAOR__DME (1 << 0)
+
+/******************************************************************************
+ TMU: timer unit
+ ******************************************************************************/
+
+// sh7091pm_e.pdf printed page 313
+volatile uint8_t  * SH7091__TMU__TOCR  = (volatile uint8_t  *)(0xffd80000 + 0x00);
+volatile uint8_t  * SH7091__TMU__TSTR  = (volatile uint8_t  *)(0xffd80000 + 0x04);
+volatile uint32_t * SH7091__TMU__TCOR0 = (volatile uint32_t *)(0xffd80000 + 0x08);
+volatile uint32_t * SH7091__TMU__TCNT0 = (volatile uint32_t *)(0xffd80000 + 0x0c);
+volatile uint16_t * SH7091__TMU__TCR0  = (volatile uint16_t *)(0xffd80000 + 0x10);
+
+#define SH7091__TMU__TSTR__STR0 (1 << 0)
+
+#define SH7091__TMU__TCR__UNF (1 << 8)
+#define SH7091__TMU__TCR__TPSC__PCK_DIV_4 (0b000 << 0)
+
+/******************************************************************************
+ SCIF: serial communication interface with FIFO
+ ******************************************************************************/
+
+volatile uint8_t  * SH7091__SCIF__SCFTDR2 = (volatile uint8_t  *)(0xffe80000 + 0x0c);
+volatile uint16_t * SH7091__SCIF__SCFSR2  = (volatile uint16_t *)(0xffe80000 + 0x10);
+volatile uint16_t * SH7091__SCIF__SCFCR2  = (volatile uint16_t *)(0xffe80000 + 0x18);
+
+#define SH7091__SCIF__SCFSR2__TDFE (1 << 5)
+#define SH7091__SCIF__SCFSR2__TEND (1 << 6)
+
+#define SH7091__SCIF__SCFCR2__TTRG(n) (((n) & 0b11) << 4)
@@ -0,0 +1,209 @@
+#pragma once
+
+#include <stdint.h>
+
+#include "fpscr.h"
+#include "sh7091.h"
+
+/*
+  Store queue bulk copy and fill
+
+  The SH4 has two 32-byte store queues (SQ0 and SQ1), mapped at P4 addresses
+  0xe0000000-0xe3ffffff. Writes to the store queue area only fill the queue;
+  a `pref` instruction on a store queue address then starts a 32-byte burst
+  transfer to external memory. Address bit 5 selects the store queue, so
+  writing consecutive 32-byte blocks naturally alternates between SQ0 and
+  SQ1: one queue can be filled while the other is being transferred.
+
+  Store queue address bits [25:5] become bits [25:5] of the external address;
+  bits [28:26] come from QACR0 (for SQ0) and QACR1 (for SQ1).
+
+  Compared to an ordinary 32-bit store loop to P2 texture memory, each 32-byte
+  block costs one bus transaction instead of eight.
+
+  sq_copy and sq_fill work with either texture memory address view:
+
+  - "64-bit" texture memory (0xa4000000, textures)
+  - "32-bit" texture memory (0xa5000000, framebuffers, region arrays, ...)
+
+  as well as with system memory. Both views are in external area 1, but QACR
+  is still derived from each destination address.
+
+  The destination, source and size must all be 4-byte aligned; any head or
+  tail that is not part of a complete, 32-byte aligned destination block is
+  written with ordinary 32-bit stores. When the source is also 8-byte
+  aligned, 32-byte blocks are moved with 64-bit fmov (see fpscr.h); otherwise
+  32-bit mov.l is used.
+
+  See sh7091pm_e.pdf printed page 61-64 and 79-81.
+ */
+
+#define SQ_BASE 0xe0000000
+
+static inline void sq_set_destination(uint32_t dst)
+{
+  *SH7091__CCN__QACR0 = SH7091__CCN__QACR__AREA(dst & 0x1fffffff);
+  *SH7091__CCN__QACR1 = SH7091__CCN__QACR__AREA(dst & 0x1fffffff);
+}
+
+static inline uint32_t sq_address(uint32_t dst)
+{
+  return SQ_BASE | (dst & 0x03ffffe0);
+}
+
+/*
+  A store queue write is deferred until a previous transfer from the same
+  store queue has completed. Writing to both queues therefore waits for all
+  outstanding store queue transfers.
+ */
+static inline void sq_wait()
+{
+  volatile uint32_t * sq = (volatile uint32_t *)SQ_BASE;
+  sq[0] = 0;
+  sq[8] = 0;
+}
+
+/*
+  Copy `blocks` 32-byte blocks from the 8-byte aligned `src` to the store
+  queue address `sq`, with 64-bit fmov.
+ */
+static inline void sq_copy64_blocks(uint32_t sq, const void * src, uint32_t blocks)
+{
+  asm volatile (
+    FPSCR_SZ_BEGIN
+    "1:\n"
+    "fmov @%[src]+,dr0\n"
+    "fmov @%[src]+,dr2\n"
+    "fmov @%[src]+,dr4\n"
+    "fmov @%[src]+,dr6\n"
+    "add #32,%[sq]\n"
+    "fmov dr6,@-%[sq]\n"
+    "fmov dr4,@-%[sq]\n"
+    "fmov dr2,@-%[sq]\n"
+    "fmov dr0,@-%[sq]\n"
+    "pref @%[sq]\n"
+    "dt %[blocks]\n"
+    "bf.s 1b\n"
+    "add #32,%[sq]\n"
+    FPSCR_SZ_END
+    : [sq] "+r" (sq), [src] "+r" (src), [blocks] "+r" (blocks)
+    :
+    : "fr0", "fr1", "fr2", "fr3", "fr4", "fr5", "fr6", "fr7", "t", "memory"
+  );
+}
+
+/*
+  Copy `blocks` 32-byte blocks from the 4-byte aligned `src` to the store
+  queue address `sq`, with 32-bit mov.l.
+ */
+static inline void sq_copy32_blocks(uint32_t sq, const uint32_t * src, uint32_t blocks)
+{
+  while (blocks > 0) {
+    volatile uint32_t * q = (volatile uint32_t *)sq;
+    q[0] = src[0];
+    q[1] = src[1];
+    q[2] = src[2];
+    q[3] = src[3];
+    q[4] = src[4];
+    q[5] = src[5];
+    q[6] = src[6];
+    q[7] = src[7];
+    pref(sq);
+
+    src += 8;
+    sq += 32;
+    blocks -= 1;
+  }
+}
+
+/*
+  Fill `blocks` 32-byte blocks at the store queue address `sq` with `value`,
+  with 64-bit fmov.
+ */
+static inline void sq_fill_blocks(uint32_t sq, uint32_t value, uint32_t blocks)
+{
+  asm volatile (
+    "lds %[value],fpul\n"
+    "fsts fpul,fr0\n"
+    "fsts fpul,fr1\n"
+    FPSCR_SZ_BEGIN
+    "1:\n"
+    "add #32,%[sq]\n"
+    "fmov dr0,@-%[sq]\n"
+    "fmov dr0,@-%[sq]\n"
+    "fmov dr0,@-%[sq]\n"
+    "fmov dr0,@-%[sq]\n"
+    "pref @%[sq]\n"
+    "dt %[blocks]\n"
+    "bf.s 1b\n"
+    "add #32,%[sq]\n"
+    FPSCR_SZ_END
+    : [sq] "+r" (sq), [blocks] "+r" (blocks)
+    : [value] "r" (value)
+    : "fr0", "fr1", "fpul", "t", "memory"
+  );
+}
+
+/*
+  Copy `size` bytes from `src` to `dst`. `dst` is a P2 or physical address
+  (e.g: texture_memory64 + texture_start).
+ */
+void sq_copy(uint32_t dst, const void * src, uint32_t size)
+{
+  const uint32_t * src4 = (const uint32_t *)src;
+  uint32_t end = dst + size;
+
+  // head: 32-bit stores until dst is 32-byte aligned
+  while ((dst & 31) != 0 && dst < end) {
+    *((volatile uint32_t *)(dst | 0xa0000000)) = *src4++;
+    dst += 4;
+  }
+
+  uint32_t blocks = (end - dst) / 32;
+  if (blocks > 0) {
+    sq_set_destination(dst);
+
+    if (((uint32_t)src4 & 7) == 0)
+      sq_copy64_blocks(sq_address(dst), src4, blocks);
+    else
+      sq_copy32_blocks(sq_address(dst), src4, blocks);
+
+    src4 += blocks * 8;
+    dst += blocks * 32;
+  }
+
+  // tail: 32-bit stores for the remaining (less than 32) bytes
+  while (dst < end) {
+    *((volatile uint32_t *)(dst | 0xa0000000)) = *src4++;
+    dst += 4;
+  }
+
+  sq_wait();
+}
+
+/*
+  Fill `size` bytes at `dst` with the 32-bit `value`.
+ */
+void sq_fill(uint32_t dst, uint32_t value, uint32_t size)
+{
+  uint32_t end = dst + size;
+
+  while ((dst & 31) != 0 && dst < end) {
+    *((volatile uint32_t *)(dst | 0xa0000000)) = value;
+    dst += 4;
+  }
+
+  uint32_t blocks = (end - dst) / 32;
+  if (blocks > 0) {
+    sq_set_destination(dst);
+    sq_fill_blocks(sq_address(dst), value, blocks);
+    dst += blocks * 32;
+  }
+
+  while (dst < end) {
+    *((volatile uint32_t *)(dst | 0xa0000000)) = value;
+    dst += 4;
+  }
+
+  sq_wait();
+}
@@ -0,0 +1,131 @@
+#include <stdint.h>
+
+#include "ch2_dma.h"
+#include "scif.h"
+#include "sq.h"
+#include "tmu.h"
+
+/*
+  Texture memory transfer throughput benchmark
+
+  Compares, for a 128 KiB system memory buffer (the size of a 256×256 RGB565
+  texture):
+
+  - a 32-bit store loop (as previously used by transfer_texture in
+    cube_ta_fullscreen_textured.c)
+  - sq_copy with a 4-byte aligned source (32-bit mov.l into the store queues)
+  - sq_copy with an 8-byte aligned source (64-bit fmov into the store queues)
+  - CH2-DMA via the direct texture path (see ch2_dma.h); the CPU is idle
+    during this transfer
+
+  to both texture memory address views, and for a 640×480×4 framebuffer clear:
+
+  - a 32-bit store loop (as previously used by framebuffer.c)
+  - sq_fill
+
+  Results are printed over the SCIF in MB/s (10^6 bytes per second).
+ */
+
+const uint32_t texture_memory64 = 0xa4000000;
+const uint32_t texture_memory32 = 0xa5000000;
+
+#define COPY_SIZE (128 * 1024)
+#define FILL_SIZE (640 * 480 * 4)
+
+// one extra word, so that `source + 1` is a 4-byte (but not 8-byte) aligned
+// source of the same size
+uint32_t source[COPY_SIZE / 4 + 1] __attribute__((aligned(32)));
+
+void copy_loop(uint32_t dst, const uint32_t * src, uint32_t size)
+{
+  for (uint32_t i = 0; i < size / 4; i++) {
+    *((volatile uint32_t *)(dst + i * 4)) = src[i];
+  }
+}
+
+void fill_loop(uint32_t dst, uint32_t value, uint32_t size)
+{
+  for (uint32_t i = 0; i < size / 4; i++) {
+    *((volatile uint32_t *)(dst + i * 4)) = value;
+  }
+}
+
+void report(const char * name, uint32_t size, uint32_t ticks)
+{
+  const float seconds = tmu_ticks_to_seconds(ticks);
+  const float megabytes = (float)size * (1.0f / 1000000.0f);
+
+  scif_string(name);
+  scif_string(": ");
+  scif_base10(tmu_ticks_to_us(ticks));
+  scif_string(" us, ");
+  scif_base10((uint32_t)(megabytes / seconds));
+  scif_string(" MB/s\n");
+}
+
+void main()
+{
+  scif_init();
+  tmu_init();
+
+  for (uint32_t i = 0; i < (sizeof (source)) / 4; i++) {
+    source[i] = i * 0x01010101;
+  }
+
+  // both destinations are in an otherwise-unused area of texture memory
+  const uint32_t copy_start = 0x600000;
+  const uint32_t fill_start = 0x200000;
+
+  struct {
+    const char * name;
+    uint32_t base;
+  } views[] = {
+    {"64-bit", texture_memory64},
+    {"32-bit", texture_memory32},
+  };
+
+  for (int i = 0; i < 2; i++) {
+    uint32_t dst = views[i].base + copy_start;
+    uint32_t start;
+
+    scif_string(views[i].name);
+    scif_string(" texture memory copy\n");
+
+    start = tmu_ticks();
+    copy_loop(dst, source, COPY_SIZE);
+    report("  32-bit store loop ", COPY_SIZE, tmu_ticks() - start);
+
+    start = tmu_ticks();
+    sq_copy(dst, source + 1, COPY_SIZE);
+    report("  sq_copy (mov.l)   ", COPY_SIZE, tmu_ticks() - start);
+
+    start = tmu_ticks();
+    sq_copy(dst, source, COPY_SIZE);
+    report("  sq_copy (fmov)    ", COPY_SIZE, tmu_ticks() - start);
+
+    start = tmu_ticks();
+    if (views[i].base == texture_memory64)
+      ch2_dma_texture64(copy_start, source, COPY_SIZE);
+    else
+      ch2_dma_texture32(copy_start, source, COPY_SIZE);
+    ch2_dma_wait();
+    report("  CH2-DMA           ", COPY_SIZE, tmu_ticks() - start);
+  }
+
+  {
+    uint32_t dst = texture_memory32 + fill_start;
+    uint32_t start;
+
+    scif_string("32-bit texture memory fill\n");
+
+    start = tmu_ticks();
+    fill_loop(dst, 0x0000ff, FILL_SIZE);
+    report("  32-bit store loop ", FILL_SIZE, tmu_ticks() - start);
+
+    start = tmu_ticks();
+    sq_fill(dst, 0x0000ff, FILL_SIZE);
+    report("  sq_fill           ", FILL_SIZE, tmu_ticks() - start);
+  }
+
+  scif_flush();
+}
@@ -1,6 +1,48 @@
+        /*
+          zero-fill [r1, r2) in 32-byte blocks; r1 and r2 must both be 32-byte
+          aligned (main.lds aligns the start and end of each section).
+
+          movca.l allocates the operand cache line without first reading it
+          from system memory; the remaining 7 stores then complete the line.
+          On uncached addresses movca.l behaves as an ordinary mov.l.
+
+          `store` overrides the first store instruction; OCRAM is filled with
+          mov.l, as it is not backed by system memory.
+
+          clobbers r0, r1
+         */
+        .macro zero_fill store=movca.l
+        mov     #0,r0
+        bra     2f
+        nop
+1:
+        \store r0,@r1
+        mov.l   r0,@(4,r1)
+        mov.l   r0,@(8,r1)
+        mov.l   r0,@(12,r1)
+        mov.l   r0,@(16,r1)
+        mov.l   r0,@(20,r1)
+        mov.l   r0,@(24,r1)
+        mov.l   r0,@(28,r1)
+        add     #32,r1
+2:
+        cmp/hi  r1,r2
+        bt      1b
+        .endm
+
 	.section .text.start
 	.global _start
 _start:
+        /*
+          save the serial loader's stack pointer, return address, VBR and SR
+          in callee-saved registers (preserved by main), so that they can be
+          restored after main returns
+         */
+        mov     r15,r8
+        sts     pr,r9
+        stc     vbr,r10
+        stc     sr,r11
+
 	mov.l stack_end_ptr,r15
 
         /* mask all interrupts */
@@ -11,10 +53,108 @@ _start:
         and     r0,r2
         ldc     r2,sr
 
+        /* install the exception vector table (see interrupt.h) */
+        mov.l   vbr_value,r0
+        ldc     r0,vbr
+
+        /*
+          set a well-defined FPSCR: single precision (PR = 0), 32-bit fmov
+          (SZ = 0), front register bank (FR = 0), denormals flushed to zero
+          (DN = 1), round to nearest, all exceptions disabled
+
+          gcc assumes PR = 0 and SZ = 0 for -m4-single-only; see fpscr.h for
+          temporarily switching SZ.
+         */
+        mov.l   fpscr_value,r0
+        lds     r0,fpscr
+
+.if CACHED
+        /*
+          CCR may only be modified by a program executing from P2 (uncached)
+          memory. The serial loader jumps to the P2 alias of this code, but
+          _start is linked at a P1 address--jump to the P2 alias of
+          cache_enable explicitly so that this does not depend on how the
+          loader entered _start.
+
+          See sh7091pm_e.pdf printed page 50-52.
+         */
+        mov.l   cache_enable_p2_ptr,r0
+        jmp     @r0
+        nop
+.endif
+
+start_main:
+        /* zero-fill .bss and .uncached */
+        mov.l   bss_start_ptr,r1
+        mov.l   bss_end_ptr,r2
+        zero_fill
+        mov.l   uncached_start_ptr,r1
+        mov.l   uncached_end_ptr,r2
+        zero_fill
+
 	mov.l main_ptr,r0
-	jmp @r0
+	jsr @r0
 	nop
 
+        /*
+          main returned: mask all interrupts, disable the Holly interrupts
+          (SB_IML*NRM and SB_IML*ERR) that interrupt.h may have enabled, then
+          restore the serial loader's state and return to it
+         */
+        mov.l   imask_all,r0
+        stc     sr,r1
+        or      r1,r0
+        ldc     r0,sr
+        mov     #0,r0
+        mov.l   sb_iml2nrm_ptr,r1
+        mov.l   r0,@r1
+        mov.l   r0,@(16,r1)
+        mov.l   r0,@(32,r1)
+        mov.l   r0,@(8,r1)
+        mov.l   r0,@(24,r1)
+        mov.l   r0,@(40,r1)
+
+        ldc     r10,vbr
+        ldc     r11,sr
+        mov     r8,r15
+        lds     r9,pr
+        rts
+        nop
+
+.if CACHED
+        .align 2
+cache_enable:
+        mov.l   ccr_ptr,r0
+        mov.l   ccr_value,r1
+        mov.l   ccr_ora_value,r2
+        or      r2,r1
+        mov.l   r1,@r0
+
+        /*
+          A branch to a cacheable area must be at least 8 instructions after
+          the CCR write.
+         */
+        nop
+        nop
+        nop
+        nop
+        nop
+        nop
+        nop
+        nop
+
+        /* zero-fill both OCRAM areas (empty unless CCR.ORA was set) */
+        mov.l   ocram0_start_ptr,r1
+        mov.l   ocram0_end_ptr,r2
+        zero_fill mov.l
+        mov.l   ocram1_start_ptr,r1
+        mov.l   ocram1_end_ptr,r2
+        zero_fill mov.l
+
+        bra     start_main
+        nop
+.endif
+
 	.align 4
 imask_all:
         .long 0xf0
@@ -22,5 +162,141 @@ zero_rb:
         .long ~(1 << 29)
 main_ptr:
 	.long _main
+bss_start_ptr:
+        .long __bss_start
+bss_end_ptr:
+        .long __bss_end
+uncached_start_ptr:
+        .long __uncached_start
+uncached_end_ptr:
+        .long __uncached_end
+fpscr_value:
+        .long (1 << 18)
+vbr_value:
+        .long vbr_base
+sb_iml2nrm_ptr:
+        .long 0xa05f6910
 stack_end_ptr:
+.if CACHED
+	.long 0x8cffc000
+.else
 	.long 0xacffc000
+.endif
+
+.if CACHED
+cache_enable_p2_ptr:
+        .long cache_enable + 0x20000000
+ccr_ptr:
+        .long 0xff00001c
+        /* ICI | ICE | OCI | CB | OCE: invalidate and enable both caches; P1
+           is copy-back, P0/U0/P3 are copy-back (WT = 0) */
+ccr_value:
+        .long (1 << 11) | (1 << 8) | (1 << 3) | (1 << 2) | (1 << 0)
+        /* ORA: operand cache RAM mode, see main.lds */
+ccr_ora_value:
+        .long __ccr_ora
+ocram0_start_ptr:
+        .long __ocram0_start
+ocram0_end_ptr:
+        .long __ocram0_end
+ocram1_start_ptr:
+        .long __ocram1_start
+ocram1_end_ptr:
+        .long __ocram1_end
+.endif
+
+        /*
+          Exception vector table
+
+          VBR + 0x100: general exceptions
+          VBR + 0x400: TLB miss exceptions
+          VBR + 0x600: interrupts
+
+          No exceptions are expected; each exception vector loops forever, so
+          that the exception can be inspected (EXPEVT, SPC) with a debugger.
+
+          On entry to the interrupt vector, SR.BL, SR.MD and SR.RB are set:
+          r0-r7 are bank 1 registers, separate from the interrupted code's r0-r7
+          (bank 0), and r8-r14 are preserved by interrupt_dispatch
+          (callee-saved). Every other register that a C function may clobber is
+          saved here. SR.BL stays set until `rte`, so interrupts do not nest.
+
+          interrupt_dispatch (interrupt.h) is a weak reference: programs that do
+          not include interrupt.h never unmask interrupts.
+
+          See sh7091pm_e.pdf "Exception Handling".
+         */
+        .section .text.vector
+        .balign 32
+        .weak   _interrupt_dispatch
+vbr_base:
+        .org    0x100
+general_exception:
+        bra     general_exception
+        nop
+
+        .org    0x400
+tlb_miss_exception:
+        bra     tlb_miss_exception
+        nop
+
+        .org    0x600
+interrupt:
+        sts.l   pr,@-r15
+        sts.l   mach,@-r15
+        sts.l   macl,@-r15
+        sts.l   fpul,@-r15
+        sts.l   fpscr,@-r15
+
+        /*
+          the interrupted code may have been running with FPSCR.SZ or FPSCR.FR
+          set (see fpscr.h); interrupt_dispatch expects the same FPSCR as main
+         */
+        mov.l   interrupt_fpscr_value,r0
+        lds     r0,fpscr
+        fmov.s  fr0,@-r15
+        fmov.s  fr1,@-r15
+        fmov.s  fr2,@-r15
+        fmov.s  fr3,@-r15
+        fmov.s  fr4,@-r15
+        fmov.s  fr5,@-r15
+        fmov.s  fr6,@-r15
+        fmov.s  fr7,@-r15
+        fmov.s  fr8,@-r15
+        fmov.s  fr9,@-r15
+        fmov.s  fr10,@-r15
+        fmov.s  fr11,@-r15
+
+        mov.l   intevt_ptr,r4
+        mov.l   @r4,r4
+        mov.l   interrupt_dispatch_ptr,r0
+        jsr     @r0
+        nop
+
+        fmov.s  @r15+,fr11
+        fmov.s  @r15+,fr10
+        fmov.s  @r15+,fr9
+        fmov.s  @r15+,fr8
+        fmov.s  @r15+,fr7
+        fmov.s  @r15+,fr6
+        fmov.s  @r15+,fr5
+        fmov.s  @r15+,fr4
+        fmov.s  @r15+,fr3
+        fmov.s  @r15+,fr2
+        fmov.s  @r15+,fr1
+        fmov.s  @r15+,fr0
+        lds.l   @r15+,fpscr
+        lds.l   @r15+,fpul
+        lds.l   @r15+,macl
+        lds.l   @r15+,mach
+        lds.l   @r15+,pr
+        rte
+        nop
+
+	.align 4
+interrupt_fpscr_value:
+        .long (1 << 18)
+intevt_ptr:
+        .long 0xff000028
+interrupt_dispatch_ptr:
+        .long _interrupt_dispatch
@@ -0,0 +1,142 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/*
+  Triangle strip generation
+
+  A TA triangle strip of N vertices draws N - 2 triangles: every vertex after
+  the first two completes a triangle with the two vertices before it, and the
+  last vertex of each strip sets END_OF_STRIP in its parameter control word.
+  Submitting an indexed triangle list as separate triangles costs three
+  32-byte vertex parameters per triangle; as strips, each triangle costs one
+  vertex parameter, plus two per strip.
+
+  strip_build converts an indexed triangle list into strips with a greedy
+  algorithm: starting from the first unused triangle (in each of its three
+  rotations, keeping the longest result), each strip is extended with the
+  unused triangle that shares the strip's last edge, with matching winding.
+
+  Triangles in a strip alternate winding; the TA accounts for this, so a strip
+  built from consistently-wound triangles culls identically to the original
+  triangle list.
+
+  Strips are never joined with degenerate triangles. On the TA, starting a new
+  strip is free (END_OF_STRIP is a bit in a vertex that is sent anyway), while
+  a degenerate join costs two or three additional vertex parameters, so a
+  join never reduces TA FIFO traffic.
+
+  strip_build runs in O(n²) time in the number of triangles; it is intended to
+  run once at initialization, not per frame.
+ */
+
+// triangle (x, y, z) is wound x → y → z; `used` marks triangles that are
+// already part of a strip (1) or of the strip being tried (2)
+static inline int strip_find(const uint16_t * triangle, int triangle_count,
+                             const uint8_t * used,
+                             uint16_t a, uint16_t b, uint16_t * c)
+{
+  static const int next[3] = {1, 2, 0};
+
+  for (int t = 0; t < triangle_count; t++) {
+    if (used[t])
+      continue;
+    const uint16_t * v = &triangle[t * 3];
+    for (int e = 0; e < 3; e++) {
+      if (v[e] == a && v[next[e]] == b) {
+        *c = v[next[next[e]]];
+        return t;
+      }
+    }
+  }
+  return -1;
+}
+
+/*
+  Extend the `length`-vertex strip `strip` for as long as possible, marking
+  each added triangle with `mark`; returns the new length.
+ */
+int strip_extend(const uint16_t * triangle, int triangle_count,
+                 uint8_t * used, uint8_t mark,
+                 uint16_t * strip, int length)
+{
+  while (true) {
+    // the next triangle is (p, q, r) if it is an even triangle of the strip,
+    // and (q, p, r) if it is odd
+    uint16_t p = strip[length - 2];
+    uint16_t q = strip[length - 1];
+    bool odd = ((length - 2) & 1) != 0;
+
+    uint16_t r;
+    int t = odd ? strip_find(triangle, triangle_count, used, q, p, &r)
+                : strip_find(triangle, triangle_count, used, p, q, &r);
+    if (t < 0)
+      return length;
+
+    used[t] = mark;
+    strip[length] = r;
+    length += 1;
+  }
+}
+
+/*
+  Convert `triangle_count` triangles (`triangle`, three vertex indices per
+  triangle) into strips.
+
+  `strip` receives the vertex indices of every strip, concatenated; it must
+  have room for 3 × triangle_count indices. `strip_length` receives the vertex
+  count of each strip; it must have room for triangle_count entries. `used`
+  is scratch space for triangle_count bytes.
+
+  Returns the number of strips.
+ */
+int strip_build(const uint16_t * triangle, int triangle_count,
+                uint16_t * strip, uint16_t * strip_length,
+                uint8_t * used)
+{
+  for (int t = 0; t < triangle_count; t++)
+    used[t] = 0;
+
+  int strip_count = 0;
+  uint16_t * out = strip;
+
+  for (int t = 0; t < triangle_count; t++) {
+    if (used[t])
+      continue;
+
+    const uint16_t * v = &triangle[t * 3];
+    used[t] = 1;
+
+    // try each rotation of the first triangle, and keep the longest strip
+    int best_rotation = 0;
+    int best_length = 0;
+    for (int rotation = 0; rotation < 3; rotation++) {
+      out[0] = v[rotation];
+      out[1] = v[(rotation + 1) % 3];
+      out[2] = v[(rotation + 2) % 3];
+      int length = strip_extend(triangle, triangle_count, used, 2, out, 3);
+
+      for (int u = 0; u < triangle_count; u++) {
+        if (used[u] == 2)
+          used[u] = 0;
+      }
+
+      if (length > best_length) {
+        best_length = length;
+        best_rotation = rotation;
+      }
+    }
+
+    out[0] = v[best_rotation];
+    out[1] = v[(best_rotation + 1) % 3];
+    out[2] = v[(best_rotation + 2) % 3];
+    int length = strip_extend(triangle, triangle_count, used, 1, out, 3);
+
+    strip_length[strip_count] = length;
+    strip_count += 1;
+    out += length;
+  }
+
+  return strip_count;
+}
@@ -0,0 +1,232 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#include "holly.h"
+
+/*
+  TA object list allocation for all five list types
+
+  The TA writes the object lists of each tile into "object pointer blocks"
+  (OPBs), starting at TA_OL_BASE. Each list type has its own OPB size
+  (TA_ALLOC_CTRL), from 8 to 32 words; a list type with OPB size 0 is not
+  used, and must not be submitted.
+
+  With TA_ALLOC_CTRL__OPB_MODE__INCREASING_ADDRESSES, the first OPB of every
+  tile of every used list is allocated up front, list by list, in list type
+  order:
+
+    opaque                       tile 0, tile 1, ... tile N - 1
+    opaque modifier volume       tile 0, tile 1, ... tile N - 1
+    translucent                  ...
+    translucent modifier volume
+    punch through
+
+  Tiles are numbered row by row (in the order of TA_GLOB_TILE_CLIP). When an
+  OPB is full, the TA links a further OPB, of the same size, from the space
+  after these: from TA_NEXT_OPB_INIT (TA_OL_BASE + `size`) up to TA_OL_LIMIT.
+  The first OPB of each tile and list is the object list pointer of that
+  tile's region array entry (see region_array.h).
+
+  The OPB size is a tradeoff: a list with few objects per tile wastes most of
+  a large OPB (and texture memory bandwidth, when CORE reads it), while a
+  list with many objects per tile follows many OPB links with small OPBs.
+  Opaque geometry is usually the densest list; punch through geometry is
+  alpha-tested, but is otherwise rasterized as cheaply as opaque geometry,
+  without the per-pixel sorting and blending of the translucent list.
+
+  Each used list is ended with its own end of list parameter
+  (transfer_ta_global_end_of_list, see ta_parameter.h), in any order; the TA
+  then raises that list's ISTNRM__END_OF_TRANSFERRING_* event.
+  ta_alloc_list_end_events is the set of events to wait for
+  (scheduler_ta_end, see scheduler.h) before rendering.
+
+  The OPB size of each list can instead follow the scene: ta_alloc_adapt
+  chooses the next frame's OPB sizes from the OPB links that each list needed
+  in the previous frame (ta_alloc_usage, measured by scheduler.h). A list
+  that links OPBs in many tiles grows; a list that has needed no links for
+  TA_ALLOC__SHRINK_FRAMES consecutive frames shrinks. Changing the OPB sizes
+  moves every list pointer, so the region array must be rewritten.
+
+  See DCDBSysArc990907E.pdf page 178-179, 186-188 and 386.
+ */
+
+// list types, as in PARAMETER_CONTROL_WORD__PARA_CONTROL__LIST_TYPE__* (see
+// ta_parameter.h)
+#define TA_ALLOC__OPAQUE 0
+#define TA_ALLOC__OPAQUE_MODIFIER_VOLUME 1
+#define TA_ALLOC__TRANSLUCENT 2
+#define TA_ALLOC__TRANSLUCENT_MODIFIER_VOLUME 3
+#define TA_ALLOC__PUNCH_THROUGH 4
+#define TA_ALLOC__LIST_COUNT 5
+
+// object pointer block sizes, in 32-bit words
+#define TA_ALLOC__OPB_NONE 0
+#define TA_ALLOC__OPB_8 8
+#define TA_ALLOC__OPB_16 16
+#define TA_ALLOC__OPB_32 32
+
+typedef struct ta_alloc {
+  int tile_x_num;
+  int tile_y_num;
+
+  // the OPB size of each list type, TA_ALLOC__OPB_*
+  uint32_t opb_words[TA_ALLOC__LIST_COUNT];
+
+  // the offset of the first OPB of each list type, relative to TA_OL_BASE
+  uint32_t list_offset[TA_ALLOC__LIST_COUNT];
+
+  // the size of the OPBs that are allocated up front; the object list area
+  // must be larger than this, by the space needed for OPB links
+  uint32_t size;
+} ta_alloc;
+
+ta_alloc ta_alloc_init(int tile_x_num, int tile_y_num, const uint32_t opb_words[TA_ALLOC__LIST_COUNT])
+{
+  ta_alloc alloc;
+  alloc.tile_x_num = tile_x_num;
+  alloc.tile_y_num = tile_y_num;
+
+  uint32_t tile_count = tile_x_num * tile_y_num;
+  uint32_t offset = 0;
+  for (int list = 0; list < TA_ALLOC__LIST_COUNT; list++) {
+    alloc.opb_words[list] = opb_words[list];
+    alloc.list_offset[list] = offset;
+    offset += tile_count * opb_words[list] * 4;
+  }
+  alloc.size = offset;
+
+  return alloc;
+}
+
+static inline bool ta_alloc_list_used(const ta_alloc * alloc, int list)
+{
+  return alloc->opb_words[list] != TA_ALLOC__OPB_NONE;
+}
+
+// the TA_ALLOC_CTRL OPB size field value of `words`
+static inline uint32_t ta_alloc_ctrl_opb(uint32_t words)
+{
+  return words == TA_ALLOC__OPB_32 ? 3 : words / 8;
+}
+
+static inline uint32_t ta_alloc_ctrl(const ta_alloc * alloc)
+{
+  return TA_ALLOC_CTRL__OPB_MODE__INCREASING_ADDRESSES
+       | TA_ALLOC_CTRL__O_OPB(ta_alloc_ctrl_opb(alloc->opb_words[TA_ALLOC__OPAQUE]))
+       | TA_ALLOC_CTRL__OM_OPB(ta_alloc_ctrl_opb(alloc->opb_words[TA_ALLOC__OPAQUE_MODIFIER_VOLUME]))
+       | TA_ALLOC_CTRL__T_OPB(ta_alloc_ctrl_opb(alloc->opb_words[TA_ALLOC__TRANSLUCENT]))
+       | TA_ALLOC_CTRL__TM_OPB(ta_alloc_ctrl_opb(alloc->opb_words[TA_ALLOC__TRANSLUCENT_MODIFIER_VOLUME]))
+       | TA_ALLOC_CTRL__PT_OPB(ta_alloc_ctrl_opb(alloc->opb_words[TA_ALLOC__PUNCH_THROUGH]));
+}
+
+static inline uint32_t ta_alloc_glob_tile_clip(const ta_alloc * alloc)
+{
+  return TA_GLOB_TILE_CLIP__TILE_Y_NUM(alloc->tile_y_num - 1)
+       | TA_GLOB_TILE_CLIP__TILE_X_NUM(alloc->tile_x_num - 1);
+}
+
+/*
+  The offset, relative to TA_OL_BASE, of the first OPB of tile (x, y) in
+  `list`.
+ */
+static inline uint32_t ta_alloc_opb_offset(const ta_alloc * alloc, int list, int x, int y)
+{
+  int tile = y * alloc->tile_x_num + x;
+  return alloc->list_offset[list] + tile * alloc->opb_words[list] * 4;
+}
+
+static inline uint32_t ta_alloc_list_end_event(int list)
+{
+  switch (list) {
+  case TA_ALLOC__OPAQUE:                      return ISTNRM__END_OF_TRANSFERRING_OPAQUE_LIST;
+  case TA_ALLOC__OPAQUE_MODIFIER_VOLUME:      return ISTNRM__END_OF_TRANSFERRING_OPAQUE_MODIFIER_VOLUME_LIST;
+  case TA_ALLOC__TRANSLUCENT:                 return ISTNRM__END_OF_TRANSFERRING_TRANSLUCENT_LIST;
+  case TA_ALLOC__TRANSLUCENT_MODIFIER_VOLUME: return ISTNRM__END_OF_TRANSFERRING_TRANSLUCENT_MODIFIER_VOLUME_LIST;
+  default:                                    return ISTNRM__END_OF_TRANSFERRING_PUNCH_THROUGH_LIST;
+  }
+}
+
+/*
+  The ISTNRM__END_OF_TRANSFERRING_* events of every used list; each is raised
+  when that list is ended.
+ */
+static inline uint32_t ta_alloc_list_end_events(const ta_alloc * alloc)
+{
+  uint32_t events = 0;
+  for (int list = 0; list < TA_ALLOC__LIST_COUNT; list++) {
+    if (ta_alloc_list_used(alloc, list))
+      events |= ta_alloc_list_end_event(list);
+  }
+  return events;
+}
+
+/*
+  The object list space used by one frame, beyond the OPBs allocated up
+  front: link_bytes[list] is the size of the OPB links that the TA allocated
+  while building `list`.
+ */
+typedef struct ta_alloc_usage {
+  uint32_t link_bytes[TA_ALLOC__LIST_COUNT];
+} ta_alloc_usage;
+
+// a list grows when it links more than one OPB per this many tiles
+#define TA_ALLOC__GROW_TILES 4
+// a list shrinks after this many consecutive frames without OPB links
+#define TA_ALLOC__SHRINK_FRAMES 60
+
+typedef struct ta_alloc_adaptive {
+  // the OPB size of each list type for the next frame, TA_ALLOC__OPB_*; a
+  // list that is not used (TA_ALLOC__OPB_NONE) is never resized
+  uint32_t opb_words[TA_ALLOC__LIST_COUNT];
+
+  // consecutive frames in which each list type has needed no OPB links
+  uint32_t quiet_frames[TA_ALLOC__LIST_COUNT];
+} ta_alloc_adaptive;
+
+/*
+  Choose the OPB sizes of the next frame, from the `usage` of a frame built
+  with `alloc`.
+ */
+void ta_alloc_adapt(ta_alloc_adaptive * adaptive, const ta_alloc * alloc, const ta_alloc_usage * usage)
+{
+  const uint32_t tile_count = alloc->tile_x_num * alloc->tile_y_num;
+
+  for (int list = 0; list < TA_ALLOC__LIST_COUNT; list++) {
+    uint32_t words = adaptive->opb_words[list];
+    if (words == TA_ALLOC__OPB_NONE || !ta_alloc_list_used(alloc, list))
+      continue;
+
+    uint32_t link_bytes = usage->link_bytes[list];
+    // there is no libgcc (-nostdlib); this is
+    // (link_bytes / opb_bytes) * TA_ALLOC__GROW_TILES > tile_count
+    uint32_t opb_bytes = alloc->opb_words[list] * 4;
+    bool grow = link_bytes * TA_ALLOC__GROW_TILES > tile_count * opb_bytes;
+
+    if (grow) {
+      adaptive->quiet_frames[list] = 0;
+      if (words < TA_ALLOC__OPB_32)
+        words *= 2;
+    } else if (link_bytes == 0) {
+      adaptive->quiet_frames[list] += 1;
+      if (adaptive->quiet_frames[list] >= TA_ALLOC__SHRINK_FRAMES && words > TA_ALLOC__OPB_8) {
+        adaptive->quiet_frames[list] = 0;
+        words /= 2;
+      }
+    } else {
+      adaptive->quiet_frames[list] = 0;
+    }
+
+    adaptive->opb_words[list] = words;
+  }
+}
+
+static inline bool ta_alloc_equal(const ta_alloc * alloc, const uint32_t opb_words[TA_ALLOC__LIST_COUNT])
+{
+  for (int list = 0; list < TA_ALLOC__LIST_COUNT; list++) {
+    if (alloc->opb_words[list] != opb_words[list])
+      return false;
+  }
+  return true;
+}
@@ -0,0 +1,461 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+// tools/ta_parameter_host.c defines TA_PARAMETER__HOST_FLUSH, and its own
+// ta_flush
+#if !defined(TA_PARAMETER__HOST_FLUSH)
+#include "ta_stream.h"
+#endif
+
+/*
+  TA parameter formats and writers
+
+  Every TA parameter format (DCDBSysArc990907E.pdf page 197-215) is described
+  once, below, as an X-macro list of the words that follow its parameter
+  control word:
+
+    F(type, name)  a field
+    R(name)        a reserved word
+    B()            the end of the first 32-byte block of a 64-byte format
+
+  TA_PARAMETER__FORMATS expands each description into:
+
+  - a struct with the same name, 32 or 64 bytes long
+
+  - a writer, `transfer_<name>`, which takes the parameter control word and
+    every field (but no reserved word) as arguments, writes them at
+    `store_queue_ix`, calls ta_flush after each complete 32-byte block, and
+    returns the address of the next parameter:
+
+      store_queue_ix = transfer_ta_vertex_parameter__polygon_type_0(store_queue_ix,
+                                                                    ta_vertex_parameter_control_word(end_of_strip),
+                                                                    x, y, z, base_color);
+
+  Each writer is specialized for its format at compile time: it contains no
+  branches other than the store queue/CH2-DMA decision in ta_flush (see
+  ta_stream.h). Reserved words are not written.
+
+  Consecutive parameters are written at consecutive 32-byte addresses, so in
+  store queue mode consecutive blocks alternate between SQ0 and SQ1 (address
+  bit 5): each block is written while the previous one is transferred. The
+  first block of a 64-byte parameter is flushed before the second block is
+  written, for the same reason.
+
+  Which vertex parameter format follows a global parameter depends on the
+  global parameter's control word (page 201):
+
+    polygon   col_type        texture  16bit_uv  volume  vertex format
+    type 0    packed          no       -         no      polygon_type_0
+    type 0/1  floating        no       -         no      polygon_type_1
+    type 1/2  intensity       no       -         no      polygon_type_2
+    type 0    packed          yes      no        no      polygon_type_3
+    type 0    packed          yes      yes       no      polygon_type_4
+    type 0/1  floating        yes      no        no      polygon_type_5
+    type 0/1  floating        yes      yes       no      polygon_type_6
+    type 1/2  intensity       yes      no        no      polygon_type_7
+    type 1/2  intensity       yes      yes       no      polygon_type_8
+    type 3    packed          no       -         yes     polygon_type_9
+    type 4    intensity       no       -         yes     polygon_type_10
+    type 3    packed          yes      no        yes     polygon_type_11
+    type 3    packed          yes      yes       yes     polygon_type_12
+    type 4    intensity       yes      no        yes     polygon_type_13
+    type 4    intensity       yes      yes       yes     polygon_type_14
+
+  Global polygon type 1 and 2 carry a floating point face color for intensity
+  mode 1 (type 2 also carries a face offset color, when `offset` is set);
+  types 3 and 4 are the two-volume equivalents of types 0 and 1/2.
+
+  Sprites (global `sprite`) use sprite_type_0 (untextured) or sprite_type_1
+  (textured) vertex parameters; each describes a whole quadrilateral, with the
+  fourth vertex's z and uv implied. Modifier volumes (global
+  `modifier_volume`) use modifier_volume vertex parameters; each describes a
+  whole triangle.
+ */
+
+/*
+  parameter_control_word bits
+
+  DCDBSysArc990907E.pdf page 198-201
+ */
+#define PARAMETER_CONTROL_WORD__PARA_CONTROL__PARA_TYPE__END_OF_LIST (0u << 29)
+#define PARAMETER_CONTROL_WORD__PARA_CONTROL__PARA_TYPE__USER_TILE_CLIP (1u << 29)
+#define PARAMETER_CONTROL_WORD__PARA_CONTROL__PARA_TYPE__OBJECT_LIST_SET (2u << 29)
+#define PARAMETER_CONTROL_WORD__PARA_CONTROL__PARA_TYPE__POLYGON_OR_MODIFIER_VOLUME (4u << 29)
+#define PARAMETER_CONTROL_WORD__PARA_CONTROL__PARA_TYPE__SPRITE (5u << 29)
+#define PARAMETER_CONTROL_WORD__PARA_CONTROL__PARA_TYPE__VERTEX_PARAMETER (7u << 29)
+#define PARAMETER_CONTROL_WORD__PARA_CONTROL__END_OF_STRIP (1 << 28)
+#define PARAMETER_CONTROL_WORD__PARA_CONTROL__LIST_TYPE__OPAQUE (0 << 24)
+#define PARAMETER_CONTROL_WORD__PARA_CONTROL__LIST_TYPE__OPAQUE_MODIFIER_VOLUME (1 << 24)
+#define PARAMETER_CONTROL_WORD__PARA_CONTROL__LIST_TYPE__TRANSLUCENT (2 << 24)
+#define PARAMETER_CONTROL_WORD__PARA_CONTROL__LIST_TYPE__TRANSLUCENT_MODIFIER_VOLUME (3 << 24)
+#define PARAMETER_CONTROL_WORD__PARA_CONTROL__LIST_TYPE__PUNCH_THROUGH (4 << 24)
+
+#define PARAMETER_CONTROL_WORD__GROUP_CONTROL__GROUP_EN (1 << 23)
+#define PARAMETER_CONTROL_WORD__GROUP_CONTROL__STRIP_LEN(n) (((n) & 0x3) << 18)
+#define PARAMETER_CONTROL_WORD__GROUP_CONTROL__USER_CLIP(n) (((n) & 0x3) << 16)
+
+#define PARAMETER_CONTROL_WORD__OBJ_CONTROL__SHADOW (1 << 7)
+#define PARAMETER_CONTROL_WORD__OBJ_CONTROL__VOLUME (1 << 6)
+#define PARAMETER_CONTROL_WORD__OBJ_CONTROL__COL_TYPE__PACKED_COLOR (0 << 4)
+#define PARAMETER_CONTROL_WORD__OBJ_CONTROL__COL_TYPE__FLOATING_COLOR (1 << 4)
+#define PARAMETER_CONTROL_WORD__OBJ_CONTROL__COL_TYPE__INTENSITY_MODE_1 (2 << 4)
+#define PARAMETER_CONTROL_WORD__OBJ_CONTROL__COL_TYPE__INTENSITY_MODE_2 (3 << 4)
+#define PARAMETER_CONTROL_WORD__OBJ_CONTROL__TEXTURE (1 << 3)
+#define PARAMETER_CONTROL_WORD__OBJ_CONTROL__OFFSET (1 << 2)
+#define PARAMETER_CONTROL_WORD__OBJ_CONTROL__GOURAUD (1 << 1)
+#define PARAMETER_CONTROL_WORD__OBJ_CONTROL__16BIT_UV (1 << 0)
+
+/*
+  The parameter control word of a polygon vertex parameter; the last vertex of
+  each triangle strip sets END_OF_STRIP, and every other vertex completes a
+  triangle with the two vertices before it.
+ */
+static inline uint32_t ta_vertex_parameter_control_word(bool end_of_strip)
+{
+  return PARAMETER_CONTROL_WORD__PARA_CONTROL__PARA_TYPE__VERTEX_PARAMETER
+       | ((uint32_t)end_of_strip << 28);
+}
+
+//////////////////////////////////////////////////////////////////////////////
+// control parameters
+//////////////////////////////////////////////////////////////////////////////
+
+#define TA_GLOBAL_PARAMETER__END_OF_LIST(F, R, B) \
+  R(_res0) R(_res1) R(_res2) R(_res3) R(_res4) R(_res5) R(_res6)
+
+#define TA_CONTROL_PARAMETER__USER_TILE_CLIP(F, R, B) \
+  R(_res0) R(_res1) R(_res2)                          \
+  F(uint32_t, user_clip_x_min)                        \
+  F(uint32_t, user_clip_y_min)                        \
+  F(uint32_t, user_clip_x_max)                        \
+  F(uint32_t, user_clip_y_max)
+
+#define TA_CONTROL_PARAMETER__OBJECT_LIST_SET(F, R, B) \
+  F(uint32_t, object_pointer)                          \
+  R(_res0) R(_res1)                                    \
+  F(uint32_t, bounding_box_x_min)                      \
+  F(uint32_t, bounding_box_y_min)                      \
+  F(uint32_t, bounding_box_x_max)                      \
+  F(uint32_t, bounding_box_y_max)
+
+//////////////////////////////////////////////////////////////////////////////
+// global parameters
+//////////////////////////////////////////////////////////////////////////////
+
+#define TA_GLOBAL_PARAMETER__POLYGON_TYPE_0(F, R, B) \
+  F(uint32_t, isp_tsp_instruction_word)              \
+  F(uint32_t, tsp_instruction_word)                  \
+  F(uint32_t, texture_control_word)                  \
+  R(_res0) R(_res1)                                  \
+  F(uint32_t, data_size_for_sort_dma)                \
+  F(uint32_t, next_address_for_sort_dma)
+
+#define TA_GLOBAL_PARAMETER__POLYGON_TYPE_1(F, R, B) \
+  F(uint32_t, isp_tsp_instruction_word)              \
+  F(uint32_t, tsp_instruction_word)                  \
+  F(uint32_t, texture_control_word)                  \
+  F(float, face_color_alpha)                         \
+  F(float, face_color_r)                             \
+  F(float, face_color_g)                             \
+  F(float, face_color_b)
+
+#define TA_GLOBAL_PARAMETER__POLYGON_TYPE_2(F, R, B) \
+  F(uint32_t, isp_tsp_instruction_word)              \
+  F(uint32_t, tsp_instruction_word)                  \
+  F(uint32_t, texture_control_word)                  \
+  R(_res0) R(_res1)                                  \
+  F(uint32_t, data_size_for_sort_dma)                \
+  F(uint32_t, next_address_for_sort_dma)             \
+  B()                                                \
+  F(float, face_color_alpha)                         \
+  F(float, face_color_r)                             \
+  F(float, face_color_g)                             \
+  F(float, face_color_b)                             \
+  F(float, face_offset_color_alpha)                  \
+  F(float, face_offset_color_r)                      \
+  F(float, face_offset_color_g)                      \
+  F(float, face_offset_color_b)
+
+#define TA_GLOBAL_PARAMETER__POLYGON_TYPE_3(F, R, B) \
+  F(uint32_t, isp_tsp_instruction_word)              \
+  F(uint32_t, tsp_instruction_word_0)                \
+  F(uint32_t, texture_control_word_0)                \
+  F(uint32_t, tsp_instruction_word_1)                \
+  F(uint32_t, texture_control_word_1)                \
+  F(uint32_t, data_size_for_sort_dma)                \
+  F(uint32_t, next_address_for_sort_dma)
+
+#define TA_GLOBAL_PARAMETER__POLYGON_TYPE_4(F, R, B) \
+  F(uint32_t, isp_tsp_instruction_word)              \
+  F(uint32_t, tsp_instruction_word_0)                \
+  F(uint32_t, texture_control_word_0)                \
+  F(uint32_t, tsp_instruction_word_1)                \
+  F(uint32_t, texture_control_word_1)                \
+  F(uint32_t, data_size_for_sort_dma)                \
+  F(uint32_t, next_address_for_sort_dma)             \
+  B()                                                \
+  F(float, face_color_alpha_0)                       \
+  F(float, face_color_r_0)                           \
+  F(float, face_color_g_0)                           \
+  F(float, face_color_b_0)                           \
+  F(float, face_color_alpha_1)                       \
+  F(float, face_color_r_1)                           \
+  F(float, face_color_g_1)                           \
+  F(float, face_color_b_1)
+
+#define TA_GLOBAL_PARAMETER__SPRITE(F, R, B) \
+  F(uint32_t, isp_tsp_instruction_word)      \
+  F(uint32_t, tsp_instruction_word)          \
+  F(uint32_t, texture_control_word)          \
+  F(uint32_t, base_color)                    \
+  F(uint32_t, offset_color)                  \
+  F(uint32_t, data_size_for_sort_dma)        \
+  F(uint32_t, next_address_for_sort_dma)
+
+#define TA_GLOBAL_PARAMETER__MODIFIER_VOLUME(F, R, B) \
+  F(uint32_t, isp_tsp_instruction_word)               \
+  R(_res0) R(_res1) R(_res2) R(_res3) R(_res4) R(_res5)
+
+//////////////////////////////////////////////////////////////////////////////
+// vertex parameters
+//////////////////////////////////////////////////////////////////////////////
+
+#define TA_VERTEX_PARAMETER__POLYGON_TYPE_0(F, R, B) \
+  F(float, x) F(float, y) F(float, z)                \
+  R(_res0) R(_res1)                                  \
+  F(uint32_t, base_color)                            \
+  R(_res2)
+
+#define TA_VERTEX_PARAMETER__POLYGON_TYPE_1(F, R, B) \
+  F(float, x) F(float, y) F(float, z)                \
+  F(float, base_color_alpha)                         \
+  F(float, base_color_r)                             \
+  F(float, base_color_g)                             \
+  F(float, base_color_b)
+
+#define TA_VERTEX_PARAMETER__POLYGON_TYPE_2(F, R, B) \
+  F(float, x) F(float, y) F(float, z)                \
+  R(_res0) R(_res1)                                  \
+  F(float, base_intensity)                           \
+  R(_res2)
+
+#define TA_VERTEX_PARAMETER__POLYGON_TYPE_3(F, R, B) \
+  F(float, x) F(float, y) F(float, z)                \
+  F(float, u) F(float, v)                            \
+  F(uint32_t, base_color)                            \
+  F(uint32_t, offset_color)
+
+#define TA_VERTEX_PARAMETER__POLYGON_TYPE_4(F, R, B) \
+  F(float, x) F(float, y) F(float, z)                \
+  F(uint32_t, u_v)                                   \
+  R(_res0)                                           \
+  F(uint32_t, base_color)                            \
+  F(uint32_t, offset_color)
+
+#define TA_VERTEX_PARAMETER__POLYGON_TYPE_5(F, R, B) \
+  F(float, x) F(float, y) F(float, z)                \
+  F(float, u) F(float, v)                            \
+  R(_res0) R(_res1)                                  \
+  B()                                                \
+  F(float, base_color_alpha)                         \
+  F(float, base_color_r)                             \
+  F(float, base_color_g)                             \
+  F(float, base_color_b)                             \
+  F(float, offset_color_alpha)                       \
+  F(float, offset_color_r)                           \
+  F(float, offset_color_g)                           \
+  F(float, offset_color_b)
+
+#define TA_VERTEX_PARAMETER__POLYGON_TYPE_6(F, R, B) \
+  F(float, x) F(float, y) F(float, z)                \
+  F(uint32_t, u_v)                                   \
+  R(_res0) R(_res1) R(_res2)                         \
+  B()                                                \
+  F(float, base_color_alpha)                         \
+  F(float, base_color_r)                             \
+  F(float, base_color_g)                             \
+  F(float, base_color_b)                             \
+  F(float, offset_color_alpha)                       \
+  F(float, offset_color_r)                           \
+  F(float, offset_color_g)                           \
+  F(float, offset_color_b)
+
+#define TA_VERTEX_PARAMETER__POLYGON_TYPE_7(F, R, B) \
+  F(float, x) F(float, y) F(float, z)                \
+  F(float, u) F(float, v)                            \
+  F(float, base_intensity)                           \
+  F(float, offset_intensity)
+
+#define TA_VERTEX_PARAMETER__POLYGON_TYPE_8(F, R, B) \
+  F(float, x) F(float, y) F(float, z)                \
+  F(uint32_t, u_v)                                   \
+  R(_res0)                                           \
+  F(float, base_intensity)                           \
+  F(float, offset_intensity)
+
+#define TA_VERTEX_PARAMETER__POLYGON_TYPE_9(F, R, B) \
+  F(float, x) F(float, y) F(float, z)                \
+  F(uint32_t, base_color_0)                          \
+  F(uint32_t, base_color_1)                          \
+  R(_res0) R(_res1)
+
+#define TA_VERTEX_PARAMETER__POLYGON_TYPE_10(F, R, B) \
+  F(float, x) F(float, y) F(float, z)                 \
+  F(float, base_intensity_0)                          \
+  F(float, base_intensity_1)                          \
+  R(_res0) R(_res1)
+
+#define TA_VERTEX_PARAMETER__POLYGON_TYPE_11(F, R, B) \
+  F(float, x) F(float, y) F(float, z)                 \
+  F(float, u_0) F(float, v_0)                         \
+  F(uint32_t, base_color_0)                           \
+  F(uint32_t, offset_color_0)                         \
+  B()                                                 \
+  F(float, u_1) F(float, v_1)                         \
+  F(uint32_t, base_color_1)                           \
+  F(uint32_t, offset_color_1)                         \
+  R(_res0) R(_res1) R(_res2) R(_res3)
+
+#define TA_VERTEX_PARAMETER__POLYGON_TYPE_12(F, R, B) \
+  F(float, x) F(float, y) F(float, z)                 \
+  F(uint32_t, u_v_0)                                  \
+  R(_res0)                                            \
+  F(uint32_t, base_color_0)                           \
+  F(uint32_t, offset_color_0)                         \
+  B()                                                 \
+  F(uint32_t, u_v_1)                                  \
+  R(_res1)                                            \
+  F(uint32_t, base_color_1)                           \
+  F(uint32_t, offset_color_1)                         \
+  R(_res2) R(_res3) R(_res4) R(_res5)
+
+#define TA_VERTEX_PARAMETER__POLYGON_TYPE_13(F, R, B) \
+  F(float, x) F(float, y) F(float, z)                 \
+  F(float, u_0) F(float, v_0)                         \
+  F(float, base_intensity_0)                          \
+  F(float, offset_intensity_0)                        \
+  B()                                                 \
+  F(float, u_1) F(float, v_1)                         \
+  F(float, base_intensity_1)                          \
+  F(float, offset_intensity_1)                        \
+  R(_res0) R(_res1) R(_res2) R(_res3)
+
+#define TA_VERTEX_PARAMETER__POLYGON_TYPE_14(F, R, B) \
+  F(float, x) F(float, y) F(float, z)                 \
+  F(uint32_t, u_v_0)                                  \
+  R(_res0)                                            \
+  F(float, base_intensity_0)                          \
+  F(float, offset_intensity_0)                        \
+  B()                                                 \
+  F(uint32_t, u_v_1)                                  \
+  R(_res1)                                            \
+  F(float, base_intensity_1)                          \
+  F(float, offset_intensity_1)                        \
+  R(_res2) R(_res3) R(_res4) R(_res5)
+
+#define TA_VERTEX_PARAMETER__SPRITE_TYPE_0(F, R, B) \
+  F(float, a_x) F(float, a_y) F(float, a_z)         \
+  F(float, b_x) F(float, b_y) F(float, b_z)         \
+  F(float, c_x)                                     \
+  B()                                               \
+  F(float, c_y) F(float, c_z)                       \
+  F(float, d_x) F(float, d_y)                       \
+  R(_res0) R(_res1) R(_res2) R(_res3)
+
+#define TA_VERTEX_PARAMETER__SPRITE_TYPE_1(F, R, B) \
+  F(float, a_x) F(float, a_y) F(float, a_z)         \
+  F(float, b_x) F(float, b_y) F(float, b_z)         \
+  F(float, c_x)                                     \
+  B()                                               \
+  F(float, c_y) F(float, c_z)                       \
+  F(float, d_x) F(float, d_y)                       \
+  R(_res0)                                          \
+  F(uint32_t, a_u_v)                                \
+  F(uint32_t, b_u_v)                                \
+  F(uint32_t, c_u_v)
+
+#define TA_VERTEX_PARAMETER__MODIFIER_VOLUME(F, R, B) \
+  F(float, a_x) F(float, a_y) F(float, a_z)           \
+  F(float, b_x) F(float, b_y) F(float, b_z)           \
+  F(float, c_x)                                       \
+  B()                                                 \
+  F(float, c_y) F(float, c_z)                         \
+  R(_res0) R(_res1) R(_res2) R(_res3) R(_res4) R(_res5)
+
+#define TA_PARAMETER__FORMATS(X)                                                     \
+  X(ta_global_parameter__end_of_list,        TA_GLOBAL_PARAMETER__END_OF_LIST)       \
+  X(ta_control_parameter__user_tile_clip,    TA_CONTROL_PARAMETER__USER_TILE_CLIP)   \
+  X(ta_control_parameter__object_list_set,   TA_CONTROL_PARAMETER__OBJECT_LIST_SET)  \
+  X(ta_global_parameter__polygon_type_0,     TA_GLOBAL_PARAMETER__POLYGON_TYPE_0)    \
+  X(ta_global_parameter__polygon_type_1,     TA_GLOBAL_PARAMETER__POLYGON_TYPE_1)    \
+  X(ta_global_parameter__polygon_type_2,     TA_GLOBAL_PARAMETER__POLYGON_TYPE_2)    \
+  X(ta_global_parameter__polygon_type_3,     TA_GLOBAL_PARAMETER__POLYGON_TYPE_3)    \
+  X(ta_global_parameter__polygon_type_4,     TA_GLOBAL_PARAMETER__POLYGON_TYPE_4)    \
+  X(ta_global_parameter__sprite,             TA_GLOBAL_PARAMETER__SPRITE)            \
+  X(ta_global_parameter__modifier_volume,    TA_GLOBAL_PARAMETER__MODIFIER_VOLUME)   \
+  X(ta_vertex_parameter__polygon_type_0,     TA_VERTEX_PARAMETER__POLYGON_TYPE_0)    \
+  X(ta_vertex_parameter__polygon_type_1,     TA_VERTEX_PARAMETER__POLYGON_TYPE_1)    \
+  X(ta_vertex_parameter__polygon_type_2,     TA_VERTEX_PARAMETER__POLYGON_TYPE_2)    \
+  X(ta_vertex_parameter__polygon_type_3,     TA_VERTEX_PARAMETER__POLYGON_TYPE_3)    \
+  X(ta_vertex_parameter__polygon_type_4,     TA_VERTEX_PARAMETER__POLYGON_TYPE_4)    \
+  X(ta_vertex_parameter__polygon_type_5,     TA_VERTEX_PARAMETER__POLYGON_TYPE_5)    \
+  X(ta_vertex_parameter__polygon_type_6,     TA_VERTEX_PARAMETER__POLYGON_TYPE_6)    \
+  X(ta_vertex_parameter__polygon_type_7,     TA_VERTEX_PARAMETER__POLYGON_TYPE_7)    \
+  X(ta_vertex_parameter__polygon_type_8,     TA_VERTEX_PARAMETER__POLYGON_TYPE_8)    \
+  X(ta_vertex_parameter__polygon_type_9,     TA_VERTEX_PARAMETER__POLYGON_TYPE_9)    \
+  X(ta_vertex_parameter__polygon_type_10,    TA_VERTEX_PARAMETER__POLYGON_TYPE_10)   \
+  X(ta_vertex_parameter__polygon_type_11,    TA_VERTEX_PARAMETER__POLYGON_TYPE_11)   \
+  X(ta_vertex_parameter__polygon_type_12,    TA_VERTEX_PARAMETER__POLYGON_TYPE_12)   \
+  X(ta_vertex_parameter__polygon_type_13,    TA_VERTEX_PARAMETER__POLYGON_TYPE_13)   \
+  X(ta_vertex_parameter__polygon_type_14,    TA_VERTEX_PARAMETER__POLYGON_TYPE_14)   \
+  X(ta_vertex_parameter__sprite_type_0,      TA_VERTEX_PARAMETER__SPRITE_TYPE_0)     \
+  X(ta_vertex_parameter__sprite_type_1,      TA_VERTEX_PARAMETER__SPRITE_TYPE_1)     \
+  X(ta_vertex_parameter__modifier_volume,    TA_VERTEX_PARAMETER__MODIFIER_VOLUME)
+
+//////////////////////////////////////////////////////////////////////////////
+// generated structs and writers
+//////////////////////////////////////////////////////////////////////////////
+
+#define TA_PARAMETER__IGNORE(...)
+#define TA_PARAMETER__STRUCT_FIELD(type, name) type name;
+#define TA_PARAMETER__STRUCT_RESERVED(name) uint32_t name;
+#define TA_PARAMETER__ARGUMENT(type, name) , type name
+#define TA_PARAMETER__WRITE_FIELD(type, name) parameter->name = name;
+#define TA_PARAMETER__WRITE_BLOCK() ta_flush(store_queue_ix);
+
+#define TA_PARAMETER__DEFINE(name, FORMAT)                                                       \
+  typedef struct name {                                                                          \
+    uint32_t parameter_control_word;                                                             \
+    FORMAT(TA_PARAMETER__STRUCT_FIELD, TA_PARAMETER__STRUCT_RESERVED, TA_PARAMETER__IGNORE)      \
+  } name;                                                                                        \
+  static_assert((sizeof (name)) == 32 || (sizeof (name)) == 64);                                 \
+                                                                                                 \
+  static inline uint32_t transfer_##name(uint32_t store_queue_ix,                                \
+                                         uint32_t parameter_control_word                         \
+                                         FORMAT(TA_PARAMETER__ARGUMENT,                          \
+                                                TA_PARAMETER__IGNORE,                            \
+                                                TA_PARAMETER__IGNORE))                           \
+  {                                                                                              \
+    volatile name * parameter = (volatile name *)(uintptr_t)store_queue_ix;                      \
+                                                                                                 \
+    parameter->parameter_control_word = parameter_control_word;                                  \
+    FORMAT(TA_PARAMETER__WRITE_FIELD, TA_PARAMETER__IGNORE, TA_PARAMETER__WRITE_BLOCK)           \
+                                                                                                 \
+    /* start transfer of the last (or only) 32-byte block to the TA */                           \
+    ta_flush(store_queue_ix + (sizeof (name)) - 32);                                             \
+                                                                                                 \
+    return store_queue_ix + (sizeof (name));                                                     \
+  }
+
+TA_PARAMETER__FORMATS(TA_PARAMETER__DEFINE)
+
+/*
+  The end of the current list; every list that is started must be ended.
+ */
+static inline uint32_t transfer_ta_global_end_of_list(uint32_t store_queue_ix)
+{
+  return transfer_ta_global_parameter__end_of_list(store_queue_ix,
+                                                   PARAMETER_CONTROL_WORD__PARA_CONTROL__PARA_TYPE__END_OF_LIST);
+}
@@ -0,0 +1,180 @@
+#pragma once
+
+#include <stdint.h>
+
+#include "ch2_dma.h"
+#include "holly.h"
+#include "sh7091.h"
+
+/*
+  TA parameter stream: store queue or CH2-DMA submission
+
+  TA parameters (global parameters, vertex parameters, end of list, ...) are
+  written by `transfer_ta_*` functions as 32-byte blocks at an ever-increasing
+  address, conventionally named `store_queue_ix`. After each 32-byte block is
+  written, `ta_flush(store_queue_ix)` is called.
+
+  In TA_STREAM__STORE_QUEUE mode, `store_queue_ix` is a store queue address,
+  and `ta_flush` starts the store queue burst to the TA polygon converter FIFO
+  (`pref`). The CPU stalls whenever it writes to a store queue that is still
+  transferring a previous block to the TA.
+
+  In TA_STREAM__DMA mode, `store_queue_ix` is instead an address in the
+  system memory ring buffer `ta_stream_ring`. Parameters are transferred to
+  the TA with CH2-DMA (see ch2_dma.h), in bursts of at least
+  TA_STREAM_KICK_SIZE bytes: `ta_flush` starts a new burst of everything
+  written so far whenever the previous burst has completed. The CPU continues
+  transforming and writing parameters while the DMA unit and the TA consume
+  the previous burst.
+
+  The ring buffer is split in two halves; consecutive frames alternate between
+  them, so a frame can be built while the final burst of the previous frame is
+  still in flight. A frame larger than one half is supported by calling
+  `ta_stream_reserve` before writing each object: when the object does not
+  fit in the remainder of the half, the stream waits for all outstanding
+  bursts and restarts at the beginning of the half.
+
+  A frame is:
+
+    uint32_t store_queue_ix = ta_stream_begin(mode);
+    store_queue_ix = transfer_ta_...(store_queue_ix, ...);
+    ...
+    ta_stream_end(store_queue_ix);
+
+    // all parameters have been handed off; wait for the TA to receive them
+    ta_stream_wait();
+
+  After ta_stream_end, `ta_stream_state.bytes` is the number of TA parameter
+  bytes in the frame.
+ */
+
+#define TA_STREAM__STORE_QUEUE 0
+#define TA_STREAM__DMA 1
+
+#define TA_STREAM_RING_SIZE (64 * 1024)
+#define TA_STREAM_KICK_SIZE 1024
+
+uint8_t ta_stream_ring[TA_STREAM_RING_SIZE] __attribute__((aligned(32)));
+
+typedef struct ta_stream {
+  uint32_t mode;
+  uint32_t half;   // DMA: the ring buffer half used by the current frame
+  uint32_t start;  // DMA: beginning of the current half
+  uint32_t end;    // DMA: end of the current half
+  uint32_t kicked; // DMA: beginning of the not-yet-submitted parameters
+  bool dma_in_flight;
+  uint32_t bytes;  // TA parameter bytes submitted in the current frame
+} ta_stream;
+
+ta_stream ta_stream_state;
+
+/* The TA polygon converter FIFO is a Holly functional unit. */
+#define TA_STREAM__TA_POLYGON_CONVERTER_FIFO 0x10000000
+
+static inline bool ta_stream_dma_busy()
+{
+  return ta_stream_state.dma_in_flight && ch2_dma_busy();
+}
+
+static inline void ta_stream_dma_wait()
+{
+  if (ta_stream_state.dma_in_flight) {
+    ch2_dma_wait();
+    ta_stream_state.dma_in_flight = false;
+  }
+}
+
+// submit [kicked, ix) to the TA with CH2-DMA
+static inline void ta_stream_kick(uint32_t ix)
+{
+  if (ix == ta_stream_state.kicked)
+    return;
+
+  ta_stream_dma_wait();
+
+  ch2_dma_ta_fifo((const void *)ta_stream_state.kicked, ix - ta_stream_state.kicked);
+  ta_stream_state.bytes += ix - ta_stream_state.kicked;
+  ta_stream_state.kicked = ix;
+  ta_stream_state.dma_in_flight = true;
+}
+
+uint32_t ta_stream_begin(uint32_t mode)
+{
+  ta_stream_state.mode = mode;
+  ta_stream_state.bytes = 0;
+
+  if (mode == TA_STREAM__STORE_QUEUE) {
+    // set the store queue destination address to the TA Polygon Converter FIFO
+    *SH7091__CCN__QACR0 = SH7091__CCN__QACR__AREA(TA_STREAM__TA_POLYGON_CONVERTER_FIFO);
+    *SH7091__CCN__QACR1 = SH7091__CCN__QACR__AREA(TA_STREAM__TA_POLYGON_CONVERTER_FIFO);
+
+    return 0xe0000000;
+  } else {
+    const uint32_t half_size = TA_STREAM_RING_SIZE / 2;
+
+    // the other half may still be in flight; this half is not
+    ta_stream_state.half ^= 1;
+    ta_stream_state.start = (uint32_t)&ta_stream_ring[ta_stream_state.half * half_size];
+    ta_stream_state.end = ta_stream_state.start + half_size;
+    ta_stream_state.kicked = ta_stream_state.start;
+
+    return ta_stream_state.start;
+  }
+}
+
+/*
+  Called after each 32-byte parameter block is written at `ix`.
+ */
+static inline void ta_flush(uint32_t ix)
+{
+  if (ta_stream_state.mode == TA_STREAM__STORE_QUEUE) {
+    // start store queue transfer of the block at `ix` to the TA
+    pref(ix);
+  } else {
+    uint32_t next = ix + 32;
+    if ((next - ta_stream_state.kicked) >= TA_STREAM_KICK_SIZE && !ta_stream_dma_busy())
+      ta_stream_kick(next);
+  }
+}
+
+/*
+  Ensure that `size` bytes of parameters can be written at `ix`; returns the
+  address that the parameters should be written to instead.
+ */
+uint32_t ta_stream_reserve(uint32_t ix, uint32_t size)
+{
+  if (ta_stream_state.mode == TA_STREAM__STORE_QUEUE)
+    return ix;
+
+  if (ix + size <= ta_stream_state.end)
+    return ix;
+
+  // submit everything in this half, and wait until the DMA unit has finished
+  // reading it before it is overwritten
+  ta_stream_kick(ix);
+  ta_stream_dma_wait();
+
+  ta_stream_state.kicked = ta_stream_state.start;
+  return ta_stream_state.start;
+}
+
+/*
+  Hand off all remaining parameters in the current frame, without waiting.
+ */
+void ta_stream_end(uint32_t ix)
+{
+  if (ta_stream_state.mode == TA_STREAM__DMA)
+    ta_stream_kick(ix);
+  else
+    ta_stream_state.bytes = ix - 0xe0000000;
+}
+
+/*
+  Wait until every parameter in the current frame has been transferred to the
+  TA.
+ */
+void ta_stream_wait()
+{
+  if (ta_stream_state.mode == TA_STREAM__DMA)
+    ta_stream_dma_wait();
+}
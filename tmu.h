@@ -0,0 +1,59 @@
+#pragma once
+
+#include <stdint.h>
+
+#include "sh7091.h"
+
+/*
+  A free-running timer for on-target measurements.
+
+  TMU channel 0 counts down from 0xffffffff at Pφ/4. The Dreamcast peripheral
+  clock (Pφ) is 50 MHz, so one tick is 80 ns, and the counter wraps after ~343
+  seconds.
+
+  See sh7091pm_e.pdf printed page 311-327.
+ */
+
+#define TMU_TICKS_PER_SECOND 12500000
+
+// the SH4 core clock (Iφ) is 200 MHz
+#define TMU_CPU_CYCLES_PER_SECOND 200000000
+
+void tmu_init()
+{
+  *SH7091__TMU__TSTR &= ~SH7091__TMU__TSTR__STR0;
+
+  *SH7091__TMU__TCR0 = SH7091__TMU__TCR__TPSC__PCK_DIV_4;
+  *SH7091__TMU__TCOR0 = 0xffffffff;
+  *SH7091__TMU__TCNT0 = 0xffffffff;
+
+  *SH7091__TMU__TSTR |= SH7091__TMU__TSTR__STR0;
+}
+
+// the number of ticks since tmu_init; differences between two tmu_ticks() are
+// correct across a single counter wrap
+static inline uint32_t tmu_ticks()
+{
+  return ~(*SH7091__TMU__TCNT0);
+}
+
+static inline uint32_t tmu_ticks_to_us(uint32_t ticks)
+{
+  // 80 ns per tick
+  return (ticks * 2) / 25;
+}
+
+/*
+  Measurements are reported in floating point: programs are built without
+  libgcc (-nostdlib), so there is no non-constant integer division.
+ */
+static inline float tmu_ticks_to_seconds(uint32_t ticks)
+{
+  return (float)ticks * (1.0f / TMU_TICKS_PER_SECOND);
+}
+
+// 16 CPU cycles per tick
+static inline float tmu_ticks_to_cycles(uint32_t ticks)
+{
+  return (float)ticks * ((float)TMU_CPU_CYCLES_PER_SECOND / (float)TMU_TICKS_PER_SECOND);
+}
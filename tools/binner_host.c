@@ -0,0 +1,307 @@
+/*
+  binner_host: run the CPU tile binner (see binner.h) on the host
+
+  This is a host (not SH4) program:
+
+    gcc -std=gnu23 -O2 -I. tools/binner_host.c -o binner_host
+    ./binner_host [triangles] [strips] [width] [height]
+
+  A deterministic pseudo-random scene of `triangles` independent triangles
+  and `strips` 20-vertex strips is binned into `width` × `height` pixels.
+  The output is then checked:
+
+  - every non-empty tile's object list ends with an end of list link, and
+    every entry points inside the ISP/TSP parameters that were written
+
+  - the tile that contains the centroid of each independent triangle lists
+    that triangle
+
+  - the tile that contains the centroid of each strip triangle has a triangle
+    strip entry whose START is the triangle's strip (of at most
+    BINNER__STRIP_VERTICES vertices), and whose MASK selects the triangle
+
+  followed by the object list statistics and the average time of
+  binner_build.
+
+  Without arguments, 2000 triangles and 100 strips are binned at 640 × 480,
+  at 600 × 450 (neither a multiple of 32) and at 1280 × 600 (760 tiles, more
+  than a region_array.h tile set holds).
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "binner.h"
+
+#define PARAMETER_CAPACITY (1024 * 1024)
+#define OBJECT_LIST_CAPACITY (1024 * 1024)
+#define STRIP_LENGTH 20
+#define ITERATIONS 100
+
+static uint32_t isp_tsp_parameter[PARAMETER_CAPACITY];
+static uint32_t object_list[OBJECT_LIST_CAPACITY];
+static region_array_entry region_array[BINNER__TILE_MAX];
+static binner b;
+
+static uint32_t random_state = 1;
+
+static float random_float(float min, float max)
+{
+  // xorshift32
+  random_state ^= random_state << 13;
+  random_state ^= random_state >> 17;
+  random_state ^= random_state << 5;
+  return min + (max - min) * (float)(random_state >> 8) * (1.0f / 16777216.0f);
+}
+
+static binner_vertex random_vertex(float x, float y, float radius)
+{
+  return (binner_vertex){
+    x + random_float(-radius, radius),
+    y + random_float(-radius, radius),
+    random_float(0.1f, 1.0f),
+    random_state & 0xffffff,
+  };
+}
+
+/*
+  Whether an entry of `tile` includes the BINNER__TRIANGLES parameter at
+  `word`.
+ */
+static bool tile_lists_triangle(int tile, uint32_t word)
+{
+  if (region_array[tile].list_pointer.opaque & REGION_ARRAY__LIST_POINTER__EMPTY)
+    return false;
+
+  for (uint32_t i = b.tile_offset[tile];; i++) {
+    uint32_t entry = object_list[i];
+    uint32_t start = (entry & 0x1fffff) - b.isp_tsp_parameter_offset / 4;
+
+    if ((entry >> 29) == 0b111)
+      return false;
+
+    // triangle strip entries never include a BINNER__TRIANGLES parameter
+    if ((entry >> 29) == 0b100) {
+      uint32_t count = ((entry >> 25) & 0xf) + 1;
+      if (word >= start && word < start + count * BINNER__TRIANGLE_WORDS)
+        return true;
+    }
+  }
+}
+
+/*
+  Whether `tile` has a triangle strip entry for the strip parameter at `word`
+  that selects triangle `k` of the strip.
+ */
+static bool tile_lists_strip_triangle(int tile, uint32_t word, int k)
+{
+  if (region_array[tile].list_pointer.opaque & REGION_ARRAY__LIST_POINTER__EMPTY)
+    return false;
+
+  for (uint32_t i = b.tile_offset[tile];; i++) {
+    uint32_t entry = object_list[i];
+    uint32_t start = (entry & 0x1fffff) - b.isp_tsp_parameter_offset / 4;
+
+    if ((entry >> 29) == 0b111)
+      return false;
+
+    if ((entry >> 31) == 0 && start == word) {
+      uint32_t mask = (entry >> 25) & 0x3f;
+      uint32_t skip = (entry >> 21) & 0x7;
+      return (mask & (1 << (5 - k))) && skip == BINNER__SKIP;
+    }
+  }
+}
+
+// whether the centroid of triangle `v` is on screen; if it is, its tile
+static bool centroid_tile(int width, int height, const binner_vertex * v, int * tile)
+{
+  float x = (v[0].x + v[1].x + v[2].x) * (1.0f / 3.0f);
+  float y = (v[0].y + v[1].y + v[2].y) * (1.0f / 3.0f);
+  if (x < 0.0f || y < 0.0f || x >= (float)width || y >= (float)height)
+    return false;
+
+  *tile = (int)(y / 32.0f) * b.tile_x_num + (int)(x / 32.0f);
+  return true;
+}
+
+static int check(int width, int height, const binner_object * objects, int length)
+{
+  int errors = 0;
+  const int tile_count = b.tile_x_num * b.tile_y_num;
+
+  for (int tile = 0; tile < tile_count; tile++) {
+    if (region_array[tile].list_pointer.opaque & REGION_ARRAY__LIST_POINTER__EMPTY)
+      continue;
+
+    for (uint32_t i = b.tile_offset[tile];; i++) {
+      if (i >= b.object_list_words) {
+        printf("tile %d: object list is not ended\n", tile);
+        errors += 1;
+        break;
+      }
+      uint32_t entry = object_list[i];
+      if ((entry >> 29) == 0b111) {
+        if (!(entry & OBJECT_LIST__OBJECT_POINTER_BLOCK_LINK__END_OF_LIST)) {
+          printf("tile %d: unexpected object pointer block link\n", tile);
+          errors += 1;
+        }
+        break;
+      }
+      uint32_t start = (entry & 0x1fffff) - b.isp_tsp_parameter_offset / 4;
+      if (start >= b.isp_tsp_parameter_words) {
+        printf("tile %d: entry %08x is outside of the ISP/TSP parameters\n", tile, entry);
+        errors += 1;
+      }
+    }
+  }
+
+  // the parameter words of each object, as binner_pass writes them
+  uint32_t word = 0;
+  for (int i = 0; i < length; i++) {
+    const binner_vertex * v = objects[i].vertex;
+
+    if (objects[i].type == BINNER__TRIANGLES) {
+      for (int j = 0; j + 3 <= objects[i].vertex_count; j += 3, word += BINNER__TRIANGLE_WORDS) {
+        int tile;
+        if (binner_triangle_sign(&v[j], &v[j + 1], &v[j + 2]) == 0.0f
+            || !centroid_tile(width, height, &v[j], &tile))
+          continue;
+
+        if (!tile_lists_triangle(tile, word)) {
+          printf("triangle at word %u is missing from tile %d\n", word, tile);
+          errors += 1;
+        }
+      }
+      continue;
+    }
+
+    for (int first = 0; first + 3 <= objects[i].vertex_count; first += BINNER__STRIP_VERTICES - 2) {
+      int count = objects[i].vertex_count - first;
+      if (count > BINNER__STRIP_VERTICES)
+        count = BINNER__STRIP_VERTICES;
+      const binner_vertex * s = &v[first];
+
+      for (int k = 0; k < count - 2; k++) {
+        int tile;
+        if (binner_triangle_sign(&s[k], &s[k + 1], &s[k + 2]) == 0.0f
+            || !centroid_tile(width, height, &s[k], &tile))
+          continue;
+
+        if (!tile_lists_strip_triangle(tile, word, k)) {
+          printf("triangle %d of the strip at word %u is missing from tile %d\n", k, word, tile);
+          errors += 1;
+        }
+      }
+
+      word += BINNER__HEADER_WORDS + count * BINNER__VERTEX_WORDS;
+    }
+  }
+
+  if (word != b.isp_tsp_parameter_words) {
+    printf("%u ISP/TSP parameter words were written; expected %u\n", b.isp_tsp_parameter_words, word);
+    errors += 1;
+  }
+
+  return errors;
+}
+
+static int run(int triangle_count, int strip_count, int width, int height)
+{
+  random_state = 1;
+
+  binner_vertex * triangles = malloc((sizeof (binner_vertex)) * 3 * triangle_count);
+  binner_vertex * strips = malloc((sizeof (binner_vertex)) * STRIP_LENGTH * strip_count);
+  binner_object * objects = malloc((sizeof (binner_object)) * (1 + strip_count));
+
+  for (int i = 0; i < triangle_count; i++) {
+    float x = random_float(-32.0f, (float)width + 32.0f);
+    float y = random_float(-32.0f, (float)height + 32.0f);
+    float radius = random_float(4.0f, 64.0f);
+    for (int k = 0; k < 3; k++)
+      triangles[i * 3 + k] = random_vertex(x, y, radius);
+  }
+
+  for (int i = 0; i < strip_count; i++) {
+    float x = random_float(0.0f, (float)width);
+    float y = random_float(0.0f, (float)height);
+    for (int k = 0; k < STRIP_LENGTH; k++)
+      strips[i * STRIP_LENGTH + k] = random_vertex(x + (float)(k / 2) * 12.0f, y + (float)(k & 1) * 16.0f, 2.0f);
+  }
+
+  objects[0] = (binner_object){
+    .type = BINNER__TRIANGLES,
+    .vertex = triangles,
+    .vertex_count = triangle_count * 3,
+  };
+  for (int i = 0; i < strip_count; i++) {
+    objects[1 + i] = (binner_object){
+      .type = BINNER__STRIP,
+      .vertex = &strips[i * STRIP_LENGTH],
+      .vertex_count = STRIP_LENGTH,
+    };
+  }
+
+  b.tile_x_num = (width + 31) / 32;
+  b.tile_y_num = (height + 31) / 32;
+  b.isp_tsp_parameter = isp_tsp_parameter;
+  b.isp_tsp_parameter_offset = 0x40;
+  b.isp_tsp_parameter_capacity = PARAMETER_CAPACITY;
+  b.object_list = object_list;
+  b.object_list_start = 0x100000;
+  b.object_list_capacity = OBJECT_LIST_CAPACITY;
+  b.region_array = region_array;
+
+  struct timespec start, end;
+  clock_gettime(CLOCK_MONOTONIC, &start);
+  bool ok = true;
+  for (int i = 0; i < ITERATIONS; i++)
+    ok = ok && binner_build(&b, objects, 1 + strip_count);
+  clock_gettime(CLOCK_MONOTONIC, &end);
+
+  if (!ok) {
+    printf("%d × %d: binner_build failed (tile count or capacity exceeded)\n", width, height);
+    return 1;
+  }
+
+  int errors = check(width, height, objects, 1 + strip_count);
+
+  free(triangles);
+  free(strips);
+  free(objects);
+
+  double us = ((double)(end.tv_sec - start.tv_sec) * 1e6 + (double)(end.tv_nsec - start.tv_nsec) * 1e-3) / ITERATIONS;
+  printf("%d × %d pixels\n", width, height);
+  printf("tiles: %d × %d\n", b.tile_x_num, b.tile_y_num);
+  printf("triangles: %u\n", b.triangles);
+  printf("tiles covered: %u\n", b.tiles_covered);
+  printf("object list entries: %u (%.2f per covered tile)\n", b.entries,
+         b.tiles_covered ? (double)b.entries / b.tiles_covered : 0.0);
+  printf("object list bytes: %u\n", b.object_list_words * 4);
+  printf("ISP/TSP parameter bytes: %u\n", b.isp_tsp_parameter_words * 4);
+  printf("binner_build time (average, us): %.1f\n", us);
+  printf("errors: %d\n\n", errors);
+
+  return errors;
+}
+
+int main(int argc, char ** argv)
+{
+  if (argc > 1) {
+    const int triangle_count = atoi(argv[1]);
+    const int strip_count = argc > 2 ? atoi(argv[2]) : 100;
+    const int width = argc > 3 ? atoi(argv[3]) : 640;
+    const int height = argc > 4 ? atoi(argv[4]) : 480;
+
+    return run(triangle_count, strip_count, width, height) == 0 ? 0 : 1;
+  }
+
+  int errors = run(2000, 100, 640, 480)
+             + run(2000, 100, 600, 450)
+             + run(2000, 100, 1280, 600);
+
+  return errors == 0 ? 0 : 1;
+}
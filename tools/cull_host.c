@@ -0,0 +1,267 @@
+/*
+  cull_host: check the culling decisions of cull.h on the host
+
+  This is a host (not SH4) program:
+
+    gcc -std=gnu23 -O2 -I. tools/cull_host.c -o cull_host -lm
+    ./cull_host [cube.mesh]
+
+  Without an argument, the cube.mesh next to this source is checked: it is
+  included with #embed where the compiler supports it, and otherwise read
+  from the directory of __FILE__ (the path given to the compiler, so build
+  with an absolute path to run from any directory). A mesh that can not be
+  read is a failure.
+
+  The cube (cube.mesh, see mesh_format.h) is transformed as the cube demos
+  transform it (mesh_view_init(theta, 240, 320, 240)) at several fixed angles,
+  and cull_back_faces must keep exactly the triangles that face the viewer:
+
+  - theta = 0: the cube is axis-aligned in front of the viewer; only the
+    face at z = -1 is visible (2 triangles)
+
+  - theta = π/4, 2.5 and 4.0: three faces are visible (6 triangles)
+
+  - theta = 1.0: two faces are visible (4 triangles)
+
+  Each expected count is also checked against an independent count, from the
+  view-space face normals.
+
+  A strip with a repeated vertex checks that the zero-area triangle is
+  dropped without being counted as back-facing. cull_sphere is then checked
+  against spheres inside, straddling and outside the view frustum.
+
+  Each failed check is printed; the exit status is the number of failures.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "cull.h"
+#include "mesh.h"
+#include "mesh_format.h"
+
+#define VERTEX_MAX 64
+#define TRIANGLE_MAX 64
+
+static int errors = 0;
+
+static void expect(bool condition, const char * what, double theta)
+{
+  if (!condition) {
+    printf("theta %.4f: %s\n", theta, what);
+    errors += 1;
+  }
+}
+
+static uint8_t * read_file(const char * path)
+{
+  FILE * f = fopen(path, "rb");
+  if (f == NULL)
+    return NULL;
+  fseek(f, 0, SEEK_END);
+  long size = ftell(f);
+  fseek(f, 0, SEEK_SET);
+  uint8_t * data = malloc(size);
+  if (fread(data, 1, size, f) != (size_t)size) {
+    free(data);
+    data = NULL;
+  }
+  fclose(f);
+  return data;
+}
+
+#if defined(__has_embed)
+static const uint8_t cube_mesh[] __attribute__((aligned(4))) = {
+  #embed "../cube.mesh"
+};
+#endif
+
+// the cube.mesh of the repository, relative to this source
+static const uint8_t * cube_mesh_data(const char ** path)
+{
+#if defined(__has_embed)
+  *path = "cube.mesh";
+  return cube_mesh;
+#else
+  static char buf[4096];
+  const char * slash = strrchr(__FILE__, '/');
+  int directory_length = slash == NULL ? 0 : (int)(slash - __FILE__ + 1);
+  snprintf(buf, (sizeof (buf)), "%.*s../cube.mesh", directory_length, __FILE__);
+  *path = buf;
+  return read_file(buf);
+#endif
+}
+
+static vec3 sub(vec3 a, vec3 b)
+{
+  return (vec3){a.x - b.x, a.y - b.y, a.z - b.z};
+}
+
+static vec3 cross(vec3 a, vec3 b)
+{
+  return (vec3){a.y * b.z - a.z * b.y, a.z * b.x - a.x * b.z, a.x * b.y - a.y * b.x};
+}
+
+static float dot(vec3 a, vec3 b)
+{
+  return a.x * b.x + a.y * b.y + a.z * b.z;
+}
+
+/*
+  The triangles of `mesh` that face the viewer, from their view-space
+  normals rather than from their screen-space winding.
+ */
+static int facing_triangles(const mesh_format_header * mesh, const mesh_view * view)
+{
+  const vec3 * position = mesh_format_position(mesh);
+  const uint16_t * strip = mesh_format_strip(mesh);
+  const uint16_t * strip_length = mesh_format_strip_length(mesh);
+
+  int count = 0;
+  for (uint32_t i = 0; i < mesh->strip_count; i++) {
+    for (int t = 0; t < strip_length[i] - 2; t++) {
+      vec3 a = mesh_vertex_view_space(position[strip[t]], view);
+      vec3 b = mesh_vertex_view_space(position[strip[t + 1]], view);
+      vec3 c = mesh_vertex_view_space(position[strip[t + 2]], view);
+      // odd triangles of a strip are wound the other way
+      vec3 n = (t & 1) ? cross(sub(c, a), sub(b, a)) : cross(sub(b, a), sub(c, a));
+      // counter-clockwise from outside, with the viewer at the origin
+      if (dot(n, a) < 0.0f)
+        count += 1;
+    }
+    strip += strip_length[i];
+  }
+  return count;
+}
+
+// the non-degenerate triangles in the output of cull_back_faces
+static int kept_triangles(const vec3 * screen, const uint16_t * strip, const uint16_t * strip_length, int strip_count)
+{
+  int count = 0;
+  for (int i = 0; i < strip_count; i++) {
+    for (int t = 0; t < strip_length[i] - 2; t++) {
+      if (cull_signed_area(screen[strip[t]], screen[strip[t + 1]], screen[strip[t + 2]]) != 0.0f)
+        count += 1;
+    }
+    strip += strip_length[i];
+  }
+  return count;
+}
+
+static void check_back_faces(const mesh_format_header * mesh, float theta, int expected)
+{
+  static vec3 screen[VERTEX_MAX];
+  static uint16_t out_strip[TRIANGLE_MAX * 4];
+  static uint16_t out_strip_length[TRIANGLE_MAX];
+
+  mesh_view view = mesh_view_init(theta, 240.f, 320.f, 240.f);
+  int behind = mesh_transform(mesh_format_position(mesh), screen, mesh->vertex_count, &view);
+  expect(behind == 0, "the cube crosses the near plane", theta);
+
+  cull_state = (cull_counters){};
+  int strip_count = cull_back_faces(screen,
+                                    mesh_format_strip(mesh), mesh_format_strip_length(mesh), mesh->strip_count,
+                                    out_strip, out_strip_length);
+  int kept = kept_triangles(screen, out_strip, out_strip_length, strip_count);
+
+  printf("theta %.4f: %d of %u triangles kept (expected %d), %u back-facing\n",
+         theta, kept, cull_state.triangles_tested, expected, cull_state.triangles_back_facing);
+
+  expect(kept == expected, "kept triangle count", theta);
+  expect(facing_triangles(mesh, &view) == expected, "view-space normals disagree with the expected count", theta);
+  expect(cull_state.triangles_back_facing + kept == cull_state.triangles_tested,
+         "every cube triangle is either kept or back-facing", theta);
+}
+
+static void check_degenerate()
+{
+  // a front-facing triangle, a zero-area triangle (the repeated vertex), and
+  // another front-facing triangle
+  static const vec3 screen[] = {
+    { 100.0f, 100.0f, 1.0f },
+    { 100.0f, 200.0f, 1.0f },
+    { 200.0f, 100.0f, 1.0f },
+    { 200.0f, 200.0f, 1.0f },
+  };
+  static const uint16_t strip[] = { 0, 1, 2, 2, 3 };
+  static const uint16_t strip_length[] = { 5 };
+  uint16_t out_strip[3 * 4];
+  uint16_t out_strip_length[3];
+
+  cull_state = (cull_counters){};
+  cull_back_faces(screen, strip, strip_length, 1, out_strip, out_strip_length);
+  expect(cull_state.triangles_tested == 3, "degenerate strip: triangles tested", 0.0);
+  expect(cull_state.triangles_back_facing == 0, "degenerate strip: a zero-area triangle is counted as back-facing", 0.0);
+}
+
+static void check_frustum()
+{
+  mesh_view view = mesh_view_init(0.0f, 240.f, 320.f, 240.f);
+  cull_frustum frustum = cull_frustum_init(&view, 640.f, 480.f, MESH__NEAR_Z);
+
+  // the left edge of the screen is at view space x / z = -320 / 240
+  const float left = -320.0f / 240.0f;
+
+  static const struct {
+    vec3 center;
+    float radius;
+    bool outside;
+    const char * what;
+  } sphere[] = {
+    { {  0.0f,  0.0f,  3.0f },              1.7320508f, false, "the cube" },
+    { {  0.0f,  0.0f, -5.0f },              1.0f,       true,  "behind the viewer" },
+    { {  0.0f,  0.0f,  0.0f },              0.05f,      true,  "in front of the near plane" },
+    { {  100.0f, 0.0f, 3.0f },              1.0f,       true,  "right of the screen" },
+    { {  0.0f, -100.0f, 3.0f },             1.0f,       true,  "above the screen" },
+    { {  left * 3.0f - 0.5f, 0.0f, 3.0f },  1.0f,       false, "straddling the left edge" },
+    { {  left * 3.0f - 1.0f, 0.0f, 3.0f },  0.1f,       true,  "just left of the screen" },
+  };
+
+  for (size_t i = 0; i < (sizeof (sphere)) / (sizeof (sphere[0])); i++) {
+    bool outside = cull_sphere(&frustum, sphere[i].center, sphere[i].radius);
+    if (outside != sphere[i].outside) {
+      printf("cull_sphere: %s: %s\n", sphere[i].what, outside ? "outside" : "inside");
+      errors += 1;
+    }
+  }
+
+  // the cube itself, as the demos test it
+  for (int i = 0; i < 8; i++) {
+    float theta = (float)i * 0.8f;
+    mesh_view v = mesh_view_init(theta, 240.f, 320.f, 240.f);
+    cull_frustum f = cull_frustum_init(&v, 640.f, 480.f, MESH__NEAR_Z);
+    expect(!cull_sphere(&f, mesh_vertex_view_space((vec3){0, 0, 0}, &v), 1.7320508f),
+           "the cube is culled by the view frustum", theta);
+  }
+}
+
+int main(int argc, char ** argv)
+{
+  const char * path = argc > 1 ? argv[1] : NULL;
+  const uint8_t * data = path != NULL ? read_file(path) : cube_mesh_data(&path);
+  if (data == NULL) {
+    printf("%s: can not read\n", path);
+    return 1;
+  }
+
+  const mesh_format_header * mesh = mesh_format_header_of(data);
+  if (mesh->magic != MESH_FORMAT__MAGIC || mesh->version != MESH_FORMAT__VERSION || mesh->vertex_count > VERTEX_MAX) {
+    printf("%s: not a packed mesh\n", path);
+    return 1;
+  }
+
+  check_back_faces(mesh, 0.0f, 2);
+  check_back_faces(mesh, 0.7853982f, 6);
+  check_back_faces(mesh, 1.0f, 4);
+  check_back_faces(mesh, 2.5f, 6);
+  check_back_faces(mesh, 4.0f, 6);
+  check_degenerate();
+  check_frustum();
+
+  printf("errors: %d\n", errors);
+
+  return errors;
+}
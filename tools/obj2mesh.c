@@ -0,0 +1,387 @@
+/*
+  obj2mesh: convert a Wavefront .obj file to a packed mesh (see mesh_format.h)
+
+  This is a host (not SH4) program:
+
+    gcc -std=gnu23 -O2 -I. tools/obj2mesh.c -o obj2mesh -lm
+    ./obj2mesh cube.obj cube.mesh
+
+  Only `v`, `vt`, `vn` and `f` statements are used; everything else
+  (materials, groups, smoothing) is ignored. Faces with more than three
+  vertices are triangulated as a fan. Winding is preserved.
+
+  .obj texture coordinates have their origin at the bottom left of the image;
+  TA texture coordinates have their origin at the top left, so v is written
+  as 1 - v.
+ */
+
+#include <math.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "mesh_format.h"
+#include "strip.h"
+
+typedef struct obj_corner {
+  // zero-based indices into the .obj arrays; -1 if absent
+  int position;
+  int texture;
+  int normal;
+} obj_corner;
+
+typedef struct obj {
+  vec3 * position;
+  int position_length;
+  vec2 * texture;
+  int texture_length;
+  vec3 * normal;
+  int normal_length;
+
+  // three corners per triangle
+  obj_corner * corner;
+  int triangle_length;
+} obj;
+
+static void * grow(void * p, int length, int size)
+{
+  // arrays grow in powers of two; `length` is the length before appending
+  if ((length & (length - 1)) != 0)
+    return p;
+  int capacity = length == 0 ? 1 : length * 2;
+  p = realloc(p, (size_t)capacity * size);
+  if (p == NULL) {
+    fprintf(stderr, "obj2mesh: out of memory\n");
+    exit(1);
+  }
+  return p;
+}
+
+#define APPEND(array, length, value)                            \
+  do {                                                          \
+    (array) = grow((array), (length), (sizeof (*(array))));     \
+    (array)[(length)++] = (value);                              \
+  } while (0)
+
+// .obj indices are one-based, or negative (relative to the end of the array)
+static int obj_index(int index, int length)
+{
+  if (index > 0)
+    return index - 1;
+  if (index < 0)
+    return length + index;
+  return -1;
+}
+
+static bool obj_parse_corner(const char * token, const obj * o, obj_corner * corner)
+{
+  int p = 0;
+  int t = 0;
+  int n = 0;
+
+  if (sscanf(token, "%d//%d", &p, &n) == 2) {
+    // v//vn
+  } else {
+    int fields = sscanf(token, "%d/%d/%d", &p, &t, &n);
+    if (fields < 1)
+      return false;
+  }
+
+  corner->position = obj_index(p, o->position_length);
+  corner->texture = obj_index(t, o->texture_length);
+  corner->normal = obj_index(n, o->normal_length);
+
+  return corner->position >= 0 && corner->position < o->position_length
+      && corner->texture < o->texture_length
+      && corner->normal < o->normal_length;
+}
+
+static bool obj_read(FILE * f, const char * filename, obj * o)
+{
+  char line[4096];
+  int line_number = 0;
+  int corner_length = 0;
+
+  while (fgets(line, (sizeof (line)), f) != NULL) {
+    line_number += 1;
+
+    if (strncmp(line, "v ", 2) == 0) {
+      vec3 v = {0};
+      sscanf(line + 2, "%f %f %f", &v.x, &v.y, &v.z);
+      APPEND(o->position, o->position_length, v);
+    } else if (strncmp(line, "vt ", 3) == 0) {
+      vec2 v = {0};
+      sscanf(line + 3, "%f %f", &v.u, &v.v);
+      APPEND(o->texture, o->texture_length, v);
+    } else if (strncmp(line, "vn ", 3) == 0) {
+      vec3 v = {0};
+      sscanf(line + 3, "%f %f %f", &v.x, &v.y, &v.z);
+      APPEND(o->normal, o->normal_length, v);
+    } else if (strncmp(line, "f ", 2) == 0) {
+      obj_corner first;
+      obj_corner previous;
+      int count = 0;
+
+      for (char * token = strtok(line + 2, " \t\r\n"); token != NULL; token = strtok(NULL, " \t\r\n")) {
+        obj_corner corner;
+        if (!obj_parse_corner(token, o, &corner)) {
+          fprintf(stderr, "%s:%d: invalid face vertex `%s`\n", filename, line_number, token);
+          return false;
+        }
+
+        if (count == 0) {
+          first = corner;
+        } else if (count >= 2) {
+          // fan triangulation
+          APPEND(o->corner, corner_length, first);
+          APPEND(o->corner, corner_length, previous);
+          APPEND(o->corner, corner_length, corner);
+        }
+        previous = corner;
+        count += 1;
+      }
+
+      if (count < 3) {
+        fprintf(stderr, "%s:%d: face with fewer than 3 vertices\n", filename, line_number);
+        return false;
+      }
+    }
+  }
+
+  o->triangle_length = corner_length / 3;
+  return true;
+}
+
+/*
+  Unique (position, texture, normal) combinations, found with an open
+  addressing hash table.
+ */
+typedef struct vertex_table {
+  obj_corner * vertex;
+  int length;
+
+  int * slot; // vertex index + 1; 0 if empty
+  int slot_length;
+} vertex_table;
+
+static uint32_t vertex_hash(obj_corner c)
+{
+  uint32_t h = 2166136261u;
+  h = (h ^ (uint32_t)c.position) * 16777619u;
+  h = (h ^ (uint32_t)c.texture) * 16777619u;
+  h = (h ^ (uint32_t)c.normal) * 16777619u;
+  return h;
+}
+
+static int vertex_table_index(vertex_table * table, obj_corner c)
+{
+  uint32_t mask = table->slot_length - 1;
+  for (uint32_t i = vertex_hash(c) & mask; ; i = (i + 1) & mask) {
+    int slot = table->slot[i];
+    if (slot == 0) {
+      table->slot[i] = table->length + 1;
+      table->vertex[table->length] = c;
+      return table->length++;
+    }
+    obj_corner v = table->vertex[slot - 1];
+    if (v.position == c.position && v.texture == c.texture && v.normal == c.normal)
+      return slot - 1;
+  }
+}
+
+/*
+  The center of the bounding box, and the largest distance from it; this is
+  not the smallest bounding sphere, but is never more than √3 times larger.
+ */
+static void bounding_sphere(const vec3 * position, int length, vec3 * center, float * radius)
+{
+  vec3 min = position[0];
+  vec3 max = position[0];
+  for (int i = 1; i < length; i++) {
+    min.x = fminf(min.x, position[i].x);
+    min.y = fminf(min.y, position[i].y);
+    min.z = fminf(min.z, position[i].z);
+    max.x = fmaxf(max.x, position[i].x);
+    max.y = fmaxf(max.y, position[i].y);
+    max.z = fmaxf(max.z, position[i].z);
+  }
+
+  *center = (vec3){(min.x + max.x) * 0.5f, (min.y + max.y) * 0.5f, (min.z + max.z) * 0.5f};
+
+  float r2 = 0.0f;
+  for (int i = 0; i < length; i++) {
+    float dx = position[i].x - center->x;
+    float dy = position[i].y - center->y;
+    float dz = position[i].z - center->z;
+    r2 = fmaxf(r2, dx * dx + dy * dy + dz * dz);
+  }
+  *radius = sqrtf(r2);
+}
+
+static uint32_t align4(uint32_t offset)
+{
+  return (offset + 3) & ~3u;
+}
+
+int main(int argc, char * argv[])
+{
+  if (argc != 3) {
+    fprintf(stderr, "usage: %s input.obj output.mesh\n", argv[0]);
+    return 1;
+  }
+
+  FILE * in = fopen(argv[1], "r");
+  if (in == NULL) {
+    perror(argv[1]);
+    return 1;
+  }
+  obj o = {0};
+  bool ok = obj_read(in, argv[1], &o);
+  fclose(in);
+  if (!ok)
+    return 1;
+  if (o.triangle_length == 0) {
+    fprintf(stderr, "%s: no faces\n", argv[1]);
+    return 1;
+  }
+
+  //
+  // deduplicate vertices
+  //
+
+  int corner_length = o.triangle_length * 3;
+
+  vertex_table table = {0};
+  table.vertex = calloc(corner_length, (sizeof (obj_corner)));
+  table.slot_length = 1;
+  while (table.slot_length < corner_length * 2)
+    table.slot_length *= 2;
+  table.slot = calloc(table.slot_length, (sizeof (int)));
+
+  uint16_t * triangle = calloc(corner_length, (sizeof (uint16_t)));
+  for (int i = 0; i < corner_length; i++) {
+    int index = vertex_table_index(&table, o.corner[i]);
+    if (index > UINT16_MAX) {
+      fprintf(stderr, "%s: more than %d unique vertices\n", argv[1], UINT16_MAX + 1);
+      return 1;
+    }
+    triangle[i] = index;
+  }
+
+  //
+  // build strips
+  //
+
+  uint16_t * strip = calloc(corner_length, (sizeof (uint16_t)));
+  uint16_t * strip_length = calloc(o.triangle_length, (sizeof (uint16_t)));
+  uint8_t * used = calloc(o.triangle_length, 1);
+  int strip_count = strip_build(triangle, o.triangle_length, strip, strip_length, used);
+
+  int strip_vertex_count = 0;
+  for (int i = 0; i < strip_count; i++)
+    strip_vertex_count += strip_length[i];
+
+  //
+  // renumber vertices in order of first use
+  //
+
+  int * order = malloc((sizeof (int)) * table.length);
+  for (int i = 0; i < table.length; i++)
+    order[i] = -1;
+
+  int vertex_count = 0;
+  obj_corner * vertex = calloc(table.length, (sizeof (obj_corner)));
+  for (int i = 0; i < strip_vertex_count; i++) {
+    if (order[strip[i]] < 0) {
+      order[strip[i]] = vertex_count;
+      vertex[vertex_count] = table.vertex[strip[i]];
+      vertex_count += 1;
+    }
+    strip[i] = order[strip[i]];
+  }
+
+  vec3 * position = calloc(vertex_count, (sizeof (vec3)));
+  vec3 * normal = calloc(vertex_count, (sizeof (vec3)));
+  vec2 * texture = calloc(vertex_count, (sizeof (vec2)));
+  for (int i = 0; i < vertex_count; i++) {
+    position[i] = o.position[vertex[i].position];
+    if (vertex[i].normal >= 0)
+      normal[i] = o.normal[vertex[i].normal];
+    if (vertex[i].texture >= 0) {
+      vec2 t = o.texture[vertex[i].texture];
+      texture[i] = (vec2){t.u, 1.0f - t.v};
+    }
+  }
+
+  //
+  // unique positions, numbered in order of first use
+  //
+
+  int * position_order = malloc((sizeof (int)) * o.position_length);
+  for (int i = 0; i < o.position_length; i++)
+    position_order[i] = -1;
+
+  int unique_position_count = 0;
+  vec3 * unique_position = calloc(vertex_count, (sizeof (vec3)));
+  uint16_t * position_index = calloc(vertex_count, (sizeof (uint16_t)));
+  for (int i = 0; i < vertex_count; i++) {
+    int p = vertex[i].position;
+    if (position_order[p] < 0) {
+      position_order[p] = unique_position_count;
+      unique_position[unique_position_count] = o.position[p];
+      unique_position_count += 1;
+    }
+    position_index[i] = position_order[p];
+  }
+
+  //
+  // write
+  //
+
+  mesh_format_header header = {
+    .magic = MESH_FORMAT__MAGIC,
+    .version = MESH_FORMAT__VERSION,
+    .vertex_count = vertex_count,
+    .strip_count = strip_count,
+    .strip_vertex_count = strip_vertex_count,
+    .unique_position_count = unique_position_count,
+  };
+  header.position_offset = (sizeof (header));
+  header.normal_offset = header.position_offset + (sizeof (vec3)) * vertex_count;
+  header.texture_offset = header.normal_offset + (sizeof (vec3)) * vertex_count;
+  header.unique_position_offset = header.texture_offset + (sizeof (vec2)) * vertex_count;
+  header.strip_length_offset = header.unique_position_offset + (sizeof (vec3)) * unique_position_count;
+  header.strip_offset = align4(header.strip_length_offset + (sizeof (uint16_t)) * strip_count);
+  header.position_index_offset = align4(header.strip_offset + (sizeof (uint16_t)) * strip_vertex_count);
+  uint32_t size = align4(header.position_index_offset + (sizeof (uint16_t)) * vertex_count);
+
+  bounding_sphere(position, vertex_count, &header.center, &header.radius);
+
+  uint8_t * buf = calloc(size, 1);
+  memcpy(buf, &header, (sizeof (header)));
+  memcpy(buf + header.position_offset, position, (sizeof (vec3)) * vertex_count);
+  memcpy(buf + header.normal_offset, normal, (sizeof (vec3)) * vertex_count);
+  memcpy(buf + header.texture_offset, texture, (sizeof (vec2)) * vertex_count);
+  memcpy(buf + header.strip_length_offset, strip_length, (sizeof (uint16_t)) * strip_count);
+  memcpy(buf + header.strip_offset, strip, (sizeof (uint16_t)) * strip_vertex_count);
+  memcpy(buf + header.unique_position_offset, unique_position, (sizeof (vec3)) * unique_position_count);
+  memcpy(buf + header.position_index_offset, position_index, (sizeof (uint16_t)) * vertex_count);
+
+  FILE * out = fopen(argv[2], "wb");
+  if (out == NULL) {
+    perror(argv[2]);
+    return 1;
+  }
+  if (fwrite(buf, 1, size, out) != size) {
+    perror(argv[2]);
+    return 1;
+  }
+  fclose(out);
+
+  fprintf(stderr, "%s: %d triangles, %d vertices (%d unique positions), %d strips (%d strip vertices), radius %f\n",
+          argv[2], o.triangle_length, vertex_count, unique_position_count, strip_count, strip_vertex_count, header.radius);
+
+  return 0;
+}
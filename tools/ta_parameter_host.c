@@ -0,0 +1,356 @@
+/*
+  ta_parameter_host: check the TA parameter encodings of ta_parameter.h on
+  the host
+
+  This is a host (not SH4) program:
+
+    gcc -std=gnu23 -O2 -no-pie -I. tools/ta_parameter_host.c -o ta_parameter_host
+    ./ta_parameter_host
+
+  (-no-pie keeps the parameter buffer below 4GB, where a uint32_t
+  `store_queue_ix` can address it.)
+
+  Every format in TA_PARAMETER__FORMATS is written by its `transfer_<name>`
+  writer into a host buffer, with ta_flush replaced by a stub that records
+  the address of each flushed block. Each field is written with a value that
+  identifies it, and the result is checked against the layouts of
+  DCDBSysArc990907E.pdf page 197-215:
+
+  - word 0 is the parameter control word
+
+  - each field is at the word of its layout, including the second 32-byte
+    block of the 64-byte formats; every field of the format is listed
+
+  - reserved words, and the words after the parameter, are not written
+
+  - the writer flushes each 32-byte block once, in order, and returns the
+    address of the next parameter
+
+  Each failed check is printed; the exit status is the number of failures.
+ */
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <string.h>
+
+//////////////////////////////////////////////////////////////////////////////
+// ta_flush
+//////////////////////////////////////////////////////////////////////////////
+
+#define TA_PARAMETER__HOST_FLUSH
+
+static uint32_t flushed[4];
+static int flushed_length;
+
+static inline void ta_flush(uint32_t ix)
+{
+  if (flushed_length < 4)
+    flushed[flushed_length] = ix;
+  flushed_length += 1;
+}
+
+#include "ta_parameter.h"
+
+//////////////////////////////////////////////////////////////////////////////
+// writers
+//////////////////////////////////////////////////////////////////////////////
+
+// the value written to the field at byte offset `offset`; both interpretations
+// are normal floats, so they pass through float arguments unchanged
+static inline uint32_t tag(uint32_t offset)
+{
+  return 0x5a000000 | offset;
+}
+
+static inline float tag_float(uint32_t offset)
+{
+  uint32_t bits = tag(offset);
+  float f;
+  memcpy(&f, &bits, 4);
+  return f;
+}
+
+#define TAG_uint32_t(offset) tag(offset)
+#define TAG_float(offset) tag_float(offset)
+
+#define ARGUMENT(type, field) , TAG_##type(offsetof(format, field))
+#define COUNT_FIELD(type, field) + 1
+
+/*
+  write_<name>: `transfer_<name>`, with every field set to its tag
+
+  fields_<name>: the number of fields of the format
+ */
+#define DEFINE_WRITER(name, FORMAT)                                                                   \
+  static uint32_t write_##name(uint32_t store_queue_ix, uint32_t parameter_control_word)              \
+  {                                                                                                   \
+    typedef name format __attribute__((unused));                                                      \
+    return transfer_##name(store_queue_ix, parameter_control_word                                     \
+                           FORMAT(ARGUMENT, TA_PARAMETER__IGNORE, TA_PARAMETER__IGNORE));             \
+  }                                                                                                   \
+  static const int fields_##name = 0 FORMAT(COUNT_FIELD, TA_PARAMETER__IGNORE, TA_PARAMETER__IGNORE);
+
+TA_PARAMETER__FORMATS(DEFINE_WRITER)
+
+//////////////////////////////////////////////////////////////////////////////
+// checks
+//////////////////////////////////////////////////////////////////////////////
+
+#define SENTINEL 0xdeadbeef
+
+// two parameters of room, so that the words after a 64-byte parameter are
+// also checked; the parameter is written at the second 32-byte block
+static uint32_t buffer[48] __attribute__((aligned(32)));
+#define PARAMETER_WORD 8
+
+static int errors = 0;
+
+static struct {
+  const char * name;
+  uint32_t size;
+  uint32_t listed;
+  int listed_fields;
+} check_state;
+
+static void expect(bool condition, const char * what)
+{
+  if (!condition) {
+    printf("%s: %s\n", check_state.name, what);
+    errors += 1;
+  }
+}
+
+static void check_begin(const char * name, uint32_t size, uint32_t parameter_control_word,
+                        uint32_t (* write)(uint32_t, uint32_t))
+{
+  check_state.name = name;
+  check_state.size = size;
+  check_state.listed = 1;
+  check_state.listed_fields = 0;
+
+  for (size_t i = 0; i < (sizeof (buffer)) / 4; i++)
+    buffer[i] = SENTINEL;
+  flushed_length = 0;
+
+  uint32_t * parameter = &buffer[PARAMETER_WORD];
+  uint32_t ix = (uint32_t)(uintptr_t)parameter;
+  if ((uintptr_t)ix != (uintptr_t)parameter) {
+    expect(false, "the parameter buffer is not below 4GB (build with -no-pie)");
+    return;
+  }
+
+  uint32_t next = write(ix, parameter_control_word);
+
+  expect(next == ix + size, "the writer does not return the address of the next parameter");
+  expect(parameter[0] == parameter_control_word, "word 0 is not the parameter control word");
+
+  expect(flushed_length == (int)(size / 32), "the writer does not flush each 32-byte block once");
+  for (int i = 0; i < flushed_length && i < 4; i++)
+    expect(flushed[i] == ix + i * 32, "a block is flushed out of order, or at the wrong address");
+}
+
+static void check_word(const char * field, uint32_t offset, uint32_t word)
+{
+  const uint32_t * parameter = &buffer[PARAMETER_WORD];
+
+  if (offset != word * 4 || parameter[word] != tag(offset)) {
+    printf("%s: %s: expected at word %u; struct word %u, word %u is %08x\n",
+           check_state.name, field, word, offset / 4, word, parameter[word]);
+    errors += 1;
+  }
+  check_state.listed |= 1 << word;
+  check_state.listed_fields += 1;
+}
+
+static void check_end(int fields)
+{
+  const uint32_t * parameter = &buffer[PARAMETER_WORD];
+
+  expect(check_state.listed_fields == fields, "the layout does not list every field");
+
+  // reserved words, and everything after the parameter
+  for (uint32_t word = 1; word < (sizeof (buffer)) / 4 - PARAMETER_WORD; word++) {
+    if (word < check_state.size / 4 && (check_state.listed & (1 << word)))
+      continue;
+    if (parameter[word] != SENTINEL) {
+      printf("%s: word %u is reserved or outside the parameter, but is written\n", check_state.name, word);
+      errors += 1;
+    }
+  }
+  expect(buffer[PARAMETER_WORD - 1] == SENTINEL, "the word before the parameter is written");
+}
+
+#define W(field, word) check_word(#field, offsetof(format, field), word);
+
+#define CHECK(name, size, parameter_control_word, WORDS)                     \
+  {                                                                          \
+    typedef name format __attribute__((unused));                             \
+    expect((sizeof (name)) == size, "struct size");                          \
+    check_begin(#name, size, parameter_control_word, write_##name);          \
+    WORDS                                                                    \
+    check_end(fields_##name);                                                \
+  }
+
+#define PCW(x) PARAMETER_CONTROL_WORD__##x
+
+int main()
+{
+  const uint32_t vertex = ta_vertex_parameter_control_word(true);
+
+  // control parameters, page 198-200
+
+  CHECK(ta_global_parameter__end_of_list, 32,
+        PCW(PARA_CONTROL__PARA_TYPE__END_OF_LIST),
+        )
+
+  CHECK(ta_control_parameter__user_tile_clip, 32,
+        PCW(PARA_CONTROL__PARA_TYPE__USER_TILE_CLIP),
+        W(user_clip_x_min, 4) W(user_clip_y_min, 5) W(user_clip_x_max, 6) W(user_clip_y_max, 7))
+
+  CHECK(ta_control_parameter__object_list_set, 32,
+        PCW(PARA_CONTROL__PARA_TYPE__OBJECT_LIST_SET),
+        W(object_pointer, 1)
+        W(bounding_box_x_min, 4) W(bounding_box_y_min, 5) W(bounding_box_x_max, 6) W(bounding_box_y_max, 7))
+
+  // global parameters, page 201-206
+
+  CHECK(ta_global_parameter__polygon_type_0, 32,
+        PCW(PARA_CONTROL__PARA_TYPE__POLYGON_OR_MODIFIER_VOLUME) | PCW(OBJ_CONTROL__COL_TYPE__PACKED_COLOR),
+        W(isp_tsp_instruction_word, 1) W(tsp_instruction_word, 2) W(texture_control_word, 3)
+        W(data_size_for_sort_dma, 6) W(next_address_for_sort_dma, 7))
+
+  CHECK(ta_global_parameter__polygon_type_1, 32,
+        PCW(PARA_CONTROL__PARA_TYPE__POLYGON_OR_MODIFIER_VOLUME) | PCW(OBJ_CONTROL__COL_TYPE__INTENSITY_MODE_1),
+        W(isp_tsp_instruction_word, 1) W(tsp_instruction_word, 2) W(texture_control_word, 3)
+        W(face_color_alpha, 4) W(face_color_r, 5) W(face_color_g, 6) W(face_color_b, 7))
+
+  CHECK(ta_global_parameter__polygon_type_2, 64,
+        PCW(PARA_CONTROL__PARA_TYPE__POLYGON_OR_MODIFIER_VOLUME) | PCW(OBJ_CONTROL__COL_TYPE__INTENSITY_MODE_1)
+        | PCW(OBJ_CONTROL__OFFSET),
+        W(isp_tsp_instruction_word, 1) W(tsp_instruction_word, 2) W(texture_control_word, 3)
+        W(data_size_for_sort_dma, 6) W(next_address_for_sort_dma, 7)
+        W(face_color_alpha, 8) W(face_color_r, 9) W(face_color_g, 10) W(face_color_b, 11)
+        W(face_offset_color_alpha, 12) W(face_offset_color_r, 13) W(face_offset_color_g, 14)
+        W(face_offset_color_b, 15))
+
+  CHECK(ta_global_parameter__polygon_type_3, 32,
+        PCW(PARA_CONTROL__PARA_TYPE__POLYGON_OR_MODIFIER_VOLUME) | PCW(OBJ_CONTROL__VOLUME),
+        W(isp_tsp_instruction_word, 1)
+        W(tsp_instruction_word_0, 2) W(texture_control_word_0, 3)
+        W(tsp_instruction_word_1, 4) W(texture_control_word_1, 5)
+        W(data_size_for_sort_dma, 6) W(next_address_for_sort_dma, 7))
+
+  CHECK(ta_global_parameter__polygon_type_4, 64,
+        PCW(PARA_CONTROL__PARA_TYPE__POLYGON_OR_MODIFIER_VOLUME) | PCW(OBJ_CONTROL__VOLUME)
+        | PCW(OBJ_CONTROL__COL_TYPE__INTENSITY_MODE_1),
+        W(isp_tsp_instruction_word, 1)
+        W(tsp_instruction_word_0, 2) W(texture_control_word_0, 3)
+        W(tsp_instruction_word_1, 4) W(texture_control_word_1, 5)
+        W(data_size_for_sort_dma, 6) W(next_address_for_sort_dma, 7)
+        W(face_color_alpha_0, 8) W(face_color_r_0, 9) W(face_color_g_0, 10) W(face_color_b_0, 11)
+        W(face_color_alpha_1, 12) W(face_color_r_1, 13) W(face_color_g_1, 14) W(face_color_b_1, 15))
+
+  CHECK(ta_global_parameter__sprite, 32,
+        PCW(PARA_CONTROL__PARA_TYPE__SPRITE) | PCW(OBJ_CONTROL__TEXTURE),
+        W(isp_tsp_instruction_word, 1) W(tsp_instruction_word, 2) W(texture_control_word, 3)
+        W(base_color, 4) W(offset_color, 5)
+        W(data_size_for_sort_dma, 6) W(next_address_for_sort_dma, 7))
+
+  CHECK(ta_global_parameter__modifier_volume, 32,
+        PCW(PARA_CONTROL__PARA_TYPE__POLYGON_OR_MODIFIER_VOLUME) | PCW(PARA_CONTROL__LIST_TYPE__OPAQUE_MODIFIER_VOLUME),
+        W(isp_tsp_instruction_word, 1))
+
+  // vertex parameters, page 207-215
+
+  CHECK(ta_vertex_parameter__polygon_type_0, 32, vertex,
+        W(x, 1) W(y, 2) W(z, 3)
+        W(base_color, 6))
+
+  CHECK(ta_vertex_parameter__polygon_type_1, 32, vertex,
+        W(x, 1) W(y, 2) W(z, 3)
+        W(base_color_alpha, 4) W(base_color_r, 5) W(base_color_g, 6) W(base_color_b, 7))
+
+  CHECK(ta_vertex_parameter__polygon_type_2, 32, vertex,
+        W(x, 1) W(y, 2) W(z, 3)
+        W(base_intensity, 6))
+
+  CHECK(ta_vertex_parameter__polygon_type_3, 32, vertex,
+        W(x, 1) W(y, 2) W(z, 3)
+        W(u, 4) W(v, 5) W(base_color, 6) W(offset_color, 7))
+
+  CHECK(ta_vertex_parameter__polygon_type_4, 32, vertex,
+        W(x, 1) W(y, 2) W(z, 3)
+        W(u_v, 4) W(base_color, 6) W(offset_color, 7))
+
+  CHECK(ta_vertex_parameter__polygon_type_5, 64, vertex,
+        W(x, 1) W(y, 2) W(z, 3)
+        W(u, 4) W(v, 5)
+        W(base_color_alpha, 8) W(base_color_r, 9) W(base_color_g, 10) W(base_color_b, 11)
+        W(offset_color_alpha, 12) W(offset_color_r, 13) W(offset_color_g, 14) W(offset_color_b, 15))
+
+  CHECK(ta_vertex_parameter__polygon_type_6, 64, vertex,
+        W(x, 1) W(y, 2) W(z, 3)
+        W(u_v, 4)
+        W(base_color_alpha, 8) W(base_color_r, 9) W(base_color_g, 10) W(base_color_b, 11)
+        W(offset_color_alpha, 12) W(offset_color_r, 13) W(offset_color_g, 14) W(offset_color_b, 15))
+
+  CHECK(ta_vertex_parameter__polygon_type_7, 32, vertex,
+        W(x, 1) W(y, 2) W(z, 3)
+        W(u, 4) W(v, 5) W(base_intensity, 6) W(offset_intensity, 7))
+
+  CHECK(ta_vertex_parameter__polygon_type_8, 32, vertex,
+        W(x, 1) W(y, 2) W(z, 3)
+        W(u_v, 4) W(base_intensity, 6) W(offset_intensity, 7))
+
+  CHECK(ta_vertex_parameter__polygon_type_9, 32, vertex,
+        W(x, 1) W(y, 2) W(z, 3)
+        W(base_color_0, 4) W(base_color_1, 5))
+
+  CHECK(ta_vertex_parameter__polygon_type_10, 32, vertex,
+        W(x, 1) W(y, 2) W(z, 3)
+        W(base_intensity_0, 4) W(base_intensity_1, 5))
+
+  CHECK(ta_vertex_parameter__polygon_type_11, 64, vertex,
+        W(x, 1) W(y, 2) W(z, 3)
+        W(u_0, 4) W(v_0, 5) W(base_color_0, 6) W(offset_color_0, 7)
+        W(u_1, 8) W(v_1, 9) W(base_color_1, 10) W(offset_color_1, 11))
+
+  CHECK(ta_vertex_parameter__polygon_type_12, 64, vertex,
+        W(x, 1) W(y, 2) W(z, 3)
+        W(u_v_0, 4) W(base_color_0, 6) W(offset_color_0, 7)
+        W(u_v_1, 8) W(base_color_1, 10) W(offset_color_1, 11))
+
+  CHECK(ta_vertex_parameter__polygon_type_13, 64, vertex,
+        W(x, 1) W(y, 2) W(z, 3)
+        W(u_0, 4) W(v_0, 5) W(base_intensity_0, 6) W(offset_intensity_0, 7)
+        W(u_1, 8) W(v_1, 9) W(base_intensity_1, 10) W(offset_intensity_1, 11))
+
+  CHECK(ta_vertex_parameter__polygon_type_14, 64, vertex,
+        W(x, 1) W(y, 2) W(z, 3)
+        W(u_v_0, 4) W(base_intensity_0, 6) W(offset_intensity_0, 7)
+        W(u_v_1, 8) W(base_intensity_1, 10) W(offset_intensity_1, 11))
+
+  CHECK(ta_vertex_parameter__sprite_type_0, 64, vertex,
+        W(a_x, 1) W(a_y, 2) W(a_z, 3)
+        W(b_x, 4) W(b_y, 5) W(b_z, 6)
+        W(c_x, 7) W(c_y, 8) W(c_z, 9)
+        W(d_x, 10) W(d_y, 11))
+
+  CHECK(ta_vertex_parameter__sprite_type_1, 64, vertex,
+        W(a_x, 1) W(a_y, 2) W(a_z, 3)
+        W(b_x, 4) W(b_y, 5) W(b_z, 6)
+        W(c_x, 7) W(c_y, 8) W(c_z, 9)
+        W(d_x, 10) W(d_y, 11)
+        W(a_u_v, 13) W(b_u_v, 14) W(c_u_v, 15))
+
+  CHECK(ta_vertex_parameter__modifier_volume, 64, vertex,
+        W(a_x, 1) W(a_y, 2) W(a_z, 3)
+        W(b_x, 4) W(b_y, 5) W(b_z, 6)
+        W(c_x, 7) W(c_y, 8) W(c_z, 9))
+
+  printf("errors: %d\n", errors);
+
+  return errors;
+}
@@ -0,0 +1,251 @@
+/*
+  vram_host: check the texture memory allocator of vram.h on the host
+
+  This is a host (not SH4) program:
+
+    gcc -std=gnu23 -O2 -I. tools/vram_host.c -o vram_host
+    ./vram_host
+
+  Each allocation or reservation is mapped to the bytes it occupies in each
+  bank, independently of vram.h (see the address space layout in vram.h),
+  and checked:
+
+  - the memory map of cube_ta_fullscreen_textured.c: every region is placed,
+    no two regions share a byte of either bank, the boot rom framebuffer is
+    where the boot rom left it, and each region is in its requested bank
+    with its requested alignment
+
+  - a reservation that overlaps a region, or crosses the end of a bank,
+    fails and is counted in `failed`; so does an allocation that does not
+    fit
+
+  - a 64-bit region occupies the same offsets of both banks, so 32-bit
+    regions are placed after it in both
+
+  - VRAM__BANK_ANY places a region in the bank with fewer bytes in use
+
+  - a freed region is reused (first fit), and vram_stats reports the free
+    blocks, the largest free block and the fragmentation of each bank
+
+  The memory map is printed; each failed check is printed, and the exit
+  status is the number of failures.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+
+#include "vram.h"
+
+static int errors = 0;
+
+static void expect(bool condition, const char * what)
+{
+  if (!condition) {
+    printf("%s\n", what);
+    errors += 1;
+  }
+}
+
+/*
+  The offsets that a region occupies: [start, end) of each bank in `banks`.
+ */
+typedef struct span {
+  uint32_t banks;
+  uint32_t start;
+  uint32_t end;
+} span;
+
+static span span32(uint32_t address, uint32_t size)
+{
+  return (span){ 1 << (address / VRAM__BANK_SIZE), address % VRAM__BANK_SIZE, address % VRAM__BANK_SIZE + size };
+}
+
+// 64-bit address A is at offset ((A & ~7) / 2) + (A & 3) of bank ((A >> 2) & 1)
+static span span64(uint32_t address, uint32_t size)
+{
+  uint32_t last = address + size - 1;
+  return (span){ VRAM__BANK_ANY, (address & ~7) / 2 + (address & 3), (last & ~7) / 2 + (last & 3) + 1 };
+}
+
+static bool spans_overlap(span a, span b)
+{
+  return (a.banks & b.banks) && a.start < b.end && b.start < a.end;
+}
+
+static void check_no_overlap(const vram * v)
+{
+  for (int i = 0; i < v->length; i++) {
+    const vram_region * a = &v->region[i];
+    span sa = a->view == 64 ? span64(a->address, a->view_size) : span32(a->address, a->view_size);
+    expect(sa.end <= VRAM__BANK_SIZE, "a region crosses the end of a bank");
+
+    for (int j = i + 1; j < v->length; j++) {
+      const vram_region * b = &v->region[j];
+      span sb = b->view == 64 ? span64(b->address, b->view_size) : span32(b->address, b->view_size);
+      if (spans_overlap(sa, sb)) {
+        printf("%s (%06x) overlaps %s (%06x)\n", a->name, a->address, b->name, b->address);
+        errors += 1;
+      }
+    }
+  }
+}
+
+static void print_map(const vram * v)
+{
+  for (int i = 0; i < v->length; i++) {
+    const vram_region * r = &v->region[i];
+    printf("  %-24s %2u-bit %06x - %06x\n", r->name, r->view, r->address, r->address + r->view_size);
+  }
+  for (int bank = 0; bank < 2; bank++) {
+    vram_bank_stats stats = vram_stats(v, bank);
+    printf("  bank %d: %u bytes used, %u free blocks, largest %u, fragmentation %u/1000\n",
+           bank, stats.used, stats.free_blocks, stats.largest_free, stats.fragmentation_permille);
+  }
+}
+
+static bool in_bank(uint32_t address, int bank)
+{
+  return address / VRAM__BANK_SIZE == (uint32_t)bank;
+}
+
+/*
+  The layout of cube_ta_fullscreen_textured.c, in the same order.
+ */
+static void check_demo_map()
+{
+  // two 24-byte region array entries per tile (see region_array.h)
+  const uint32_t region_array_size = 24 * 2 * (640 / 32) * (480 / 32);
+  const uint32_t framebuffer_size = 640 * 480 * 2;
+  const uint32_t object_list_size = 0x40000;
+  const uint32_t isp_tsp_parameter_size = 0x80000;
+  const uint32_t texture_size = 256 * 256 * 2;
+
+  vram v;
+  vram_init(&v);
+
+  const uint32_t boot_framebuffer_start = 0x200000;
+  expect(vram_reserve32(&v, "boot rom framebuffer", boot_framebuffer_start, framebuffer_size),
+         "demo: the boot rom framebuffer can not be reserved");
+
+  uint32_t framebuffer[2];
+  for (int i = 0; i < 2; i++)
+    framebuffer[i] = vram_alloc32(&v, "framebuffer", framebuffer_size, 32, VRAM__BANK_ANY);
+
+  uint32_t backdrop_object_list = vram_alloc32(&v, "backdrop object list", 0x20000, 32, VRAM__BANK_0);
+
+  uint32_t object_list[2], isp_tsp_parameter[2], region_array[2];
+  for (int i = 0; i < 2; i++) {
+    object_list[i]       = vram_alloc32(&v, "object list", object_list_size, 32, VRAM__BANK_0);
+    isp_tsp_parameter[i] = vram_alloc32(&v, "ISP/TSP parameters", isp_tsp_parameter_size, 0x100000, VRAM__BANK_1);
+    region_array[i]      = vram_alloc32(&v, "region array", region_array_size, 32, VRAM__BANK_ANY);
+  }
+
+  uint32_t texture = vram_alloc64(&v, "texture", texture_size, 32);
+
+  printf("cube_ta_fullscreen_textured.c:\n");
+  print_map(&v);
+
+  expect(v.failed == 0, "demo: an allocation failed");
+  check_no_overlap(&v);
+
+  for (int i = 0; i < 2; i++) {
+    expect(framebuffer[i] != boot_framebuffer_start, "demo: a framebuffer is allocated over the boot rom framebuffer");
+    expect(in_bank(object_list[i], 0), "demo: an object list is not in bank 0");
+    expect(in_bank(isp_tsp_parameter[i], 1), "demo: an ISP/TSP parameter area is not in bank 1");
+    expect((isp_tsp_parameter[i] & 0xfffff) == 0, "demo: an ISP/TSP parameter area is not 1 MiB aligned");
+    expect((region_array[i] & 31) == 0, "demo: a region array is not 32-byte aligned");
+  }
+  expect(in_bank(backdrop_object_list, 0), "demo: the backdrop object list is not in bank 0");
+  expect(texture != VRAM__NONE && (texture & 31) == 0, "demo: the texture is not 32-byte aligned");
+}
+
+static void check_failures()
+{
+  vram v;
+  vram_init(&v);
+
+  uint32_t a = vram_alloc32(&v, "a", 0x1000, 32, VRAM__BANK_0);
+  expect(a == 0, "failures: the first region is not at the beginning of bank 0");
+
+  expect(!vram_reserve32(&v, "overlap", 0x800, 0x1000), "failures: an overlapping reservation succeeds");
+  expect(!vram_reserve32(&v, "crossing", VRAM__BANK_SIZE - 0x100, 0x200), "failures: a reservation across the banks succeeds");
+  expect(!vram_reserve64(&v, "overlap64", 0x1000, 0x100), "failures: an overlapping 64-bit reservation succeeds");
+  expect(vram_alloc32(&v, "too large", VRAM__BANK_SIZE, 32, VRAM__BANK_0) == VRAM__NONE,
+         "failures: an allocation larger than the free space succeeds");
+  expect(v.failed == 4, "failures: failed is not the number of failures");
+
+  check_no_overlap(&v);
+}
+
+static void check_views()
+{
+  vram v;
+  vram_init(&v);
+
+  // 0x2000 bytes of the 64-bit address space: 0x1000 bytes of each bank
+  uint32_t texture = vram_alloc64(&v, "texture", 0x2000, 32);
+  uint32_t bank_0 = vram_alloc32(&v, "bank 0", 0x100, 32, VRAM__BANK_0);
+  uint32_t bank_1 = vram_alloc32(&v, "bank 1", 0x100, 32, VRAM__BANK_1);
+
+  expect(texture == 0, "views: the 64-bit region is not at the beginning");
+  expect(bank_0 == 0x1000, "views: a bank 0 region is not placed after the 64-bit region");
+  expect(bank_1 == VRAM__BANK_SIZE + 0x1000, "views: a bank 1 region is not placed after the 64-bit region");
+
+  // bank 0 has fewer bytes in use
+  uint32_t any_1 = vram_alloc32(&v, "bank 1 again", 0x100, 32, VRAM__BANK_1);
+  uint32_t any = vram_alloc32(&v, "any", 0x100, 32, VRAM__BANK_ANY);
+  expect(any_1 == VRAM__BANK_SIZE + 0x1100, "views: the second bank 1 region is misplaced");
+  expect(in_bank(any, 0), "views: VRAM__BANK_ANY does not choose the emptier bank");
+
+  expect(v.failed == 0, "views: an allocation failed");
+  check_no_overlap(&v);
+}
+
+static void check_free_and_stats()
+{
+  vram v;
+  vram_init(&v);
+
+  uint32_t a = vram_alloc32(&v, "a", 0x10000, 32, VRAM__BANK_0);
+  uint32_t b = vram_alloc32(&v, "b", 0x10000, 32, VRAM__BANK_0);
+  uint32_t c = vram_alloc32(&v, "c", 0x10000, 32, VRAM__BANK_0);
+  (void)a; (void)c;
+
+  expect(vram_free(&v, b, 32), "stats: a region can not be freed");
+  expect(!vram_free(&v, b, 32), "stats: a region is freed twice");
+  expect(!vram_free(&v, c, 64), "stats: a 32-bit region is freed as a 64-bit region");
+
+  // a hole of 0x10000, then the rest of the bank after c
+  vram_bank_stats stats = vram_stats(&v, 0);
+  const uint32_t rest = VRAM__BANK_SIZE - 0x30000;
+  const uint32_t expected_permille = 1000 - (uint32_t)(1000.0 * rest / (rest + 0x10000));
+  expect(stats.used == 0x20000, "stats: used");
+  expect(stats.peak == 0x30000, "stats: peak");
+  expect(stats.free_blocks == 2, "stats: free blocks");
+  expect(stats.largest_free == rest, "stats: largest free block");
+  expect(stats.fragmentation_permille + 1 >= expected_permille && stats.fragmentation_permille <= expected_permille + 1,
+         "stats: fragmentation");
+
+  // first fit: the hole is reused
+  expect(vram_alloc32(&v, "d", 0x8000, 32, VRAM__BANK_0) == b, "stats: the freed region is not reused");
+
+  stats = vram_stats(&v, 1);
+  expect(stats.used == 0 && stats.free_blocks == 1 && stats.largest_free == VRAM__BANK_SIZE
+         && stats.fragmentation_permille == 0,
+         "stats: the unused bank is not one free block");
+
+  check_no_overlap(&v);
+}
+
+int main()
+{
+  check_demo_map();
+  check_failures();
+  check_views();
+  check_free_and_stats();
+
+  printf("errors: %d\n", errors);
+
+  return errors;
+}
@@ -0,0 +1,309 @@
+#include <stdint.h>
+
+#include "binner.h"
+#include "holly.h"
+#include "interrupt.h"
+#include "matrix.h"
+#include "scif.h"
+#include "sq.h"
+#include "tmu.h"
+
+/*
+  triangle_core_fullscreen, with many triangles and strips binned on the CPU
+
+  As in triangle_core.c, the TA is completely unused: the region array, object
+  lists and ISP/TSP parameters are built by binner_build (see binner.h) in
+  system memory, copied to texture memory with the store queues (sq_copy),
+  and rendered once by CORE.
+
+  This demo presumes the boot rom has initialized Holly with the values
+  needed to display the "PRODUCED BY OR UNDER LICENSE FROM SEGA ENTERPRESES,
+  LTD." screen (see triangle_core.c).
+
+  The time spent binning, copying and rendering is printed over the SCIF.
+ */
+
+/* Texture memory access
+
+  texture_memory64 and texture_memory32 refer two different addressing schemes
+  over the same 8MB of physical texture memory.
+
+  Generally speaking the texture_memory64 address scheme is used for textures
+  (any texture memory address referenced by `texture_control_word`), and
+  texture_memory32 is used for everything else.
+
+  E_DC_HW_outline.pdf "2.4 System memory mapping" (PDF page 10)
+ */
+const uint32_t texture_memory32 = 0xa5000000;
+
+/******************************************************************************
+ Scene
+ ******************************************************************************/
+
+// a ring of independent triangles around the center of the screen
+#define RING_TRIANGLES 64
+// horizontal ribbons, each one strip
+#define RIBBONS 6
+#define RIBBON_VERTICES 66
+
+binner_vertex ring_vertex[RING_TRIANGLES * 3];
+binner_vertex ribbon_vertex[RIBBONS][RIBBON_VERTICES];
+binner_object scene[1 + RIBBONS];
+
+/*
+  isp_tsp_instruction_word bits
+
+  DCDBSysArc990907E.pdf page 222-225
+ */
+#define ISP_TSP_INSTRUCTION_WORD__DEPTH_COMPARE_MODE__GREATER (4 << 29)
+#define ISP_TSP_INSTRUCTION_WORD__DEPTH_COMPARE_MODE__ALWAYS (7 << 29)
+
+#define ISP_TSP_INSTRUCTION_WORD__CULLING_MODE__NO_CULLING (0 << 27)
+
+#define ISP_TSP_INSTRUCTION_WORD__GOURAUD_SHADING (1 << 23)
+
+/*
+  tsp_instruction_word bits
+
+  DCDBSysArc990907E.pdf page 226-232
+ */
+#define TSP_INSTRUCTION_WORD__SRC_ALPHA_INSTR__ONE (1 << 29)
+#define TSP_INSTRUCTION_WORD__DST_ALPHA_INSTR__ZERO (0 << 26)
+#define TSP_INSTRUCTION_WORD__FOG_CONTROL__NO_FOG (0b10 << 22)
+
+void build_scene()
+{
+  const uint32_t isp_tsp_instruction_word = ISP_TSP_INSTRUCTION_WORD__DEPTH_COMPARE_MODE__GREATER
+                                          | ISP_TSP_INSTRUCTION_WORD__CULLING_MODE__NO_CULLING
+                                          | ISP_TSP_INSTRUCTION_WORD__GOURAUD_SHADING;
+
+  const uint32_t tsp_instruction_word = TSP_INSTRUCTION_WORD__SRC_ALPHA_INSTR__ONE
+                                      | TSP_INSTRUCTION_WORD__DST_ALPHA_INSTR__ZERO
+                                      | TSP_INSTRUCTION_WORD__FOG_CONTROL__NO_FOG;
+
+  const float tau = 6.2831855f;
+
+  for (int i = 0; i < RING_TRIANGLES; i++) {
+    float s0, c0, s1, c1;
+    fsca(tau * (float)i * (1.0f / RING_TRIANGLES), &s0, &c0);
+    fsca(tau * ((float)i + 0.8f) * (1.0f / RING_TRIANGLES), &s1, &c1);
+
+    binner_vertex * v = &ring_vertex[i * 3];
+    v[0] = (binner_vertex){320.0f + c0 * 100.0f, 240.0f + s0 * 100.0f, 0.5f, 0xff0000};
+    v[1] = (binner_vertex){320.0f + c0 * 220.0f, 240.0f + s0 * 220.0f, 0.5f, 0x00ff00};
+    v[2] = (binner_vertex){320.0f + c1 * 220.0f, 240.0f + s1 * 220.0f, 0.5f, 0x0000ff};
+  }
+
+  scene[0] = (binner_object){
+    .type = BINNER__TRIANGLES,
+    .isp_tsp_instruction_word = isp_tsp_instruction_word,
+    .tsp_instruction_word = tsp_instruction_word,
+    .texture_control_word = 0,
+    .vertex = ring_vertex,
+    .vertex_count = RING_TRIANGLES * 3,
+  };
+
+  // the ribbons are behind the ring
+  for (int r = 0; r < RIBBONS; r++) {
+    float y = 40.0f + (float)r * 80.0f;
+    for (int i = 0; i < RIBBON_VERTICES; i++) {
+      float s, c;
+      fsca(tau * (float)(i / 2) * (1.0f / 16.0f) + (float)r, &s, &c);
+      (void)c;
+
+      float x = (float)(i / 2) * (640.0f / (RIBBON_VERTICES / 2 - 1));
+      float top = y + s * 16.0f;
+      ribbon_vertex[r][i] = (binner_vertex){
+        x,
+        (i & 1) ? top + 24.0f : top,
+        0.25f,
+        (i & 1) ? 0x202080 : 0xc0c0ff,
+      };
+    }
+
+    scene[1 + r] = (binner_object){
+      .type = BINNER__STRIP,
+      .isp_tsp_instruction_word = isp_tsp_instruction_word,
+      .tsp_instruction_word = tsp_instruction_word,
+      .texture_control_word = 0,
+      .vertex = ribbon_vertex[r],
+      .vertex_count = RIBBON_VERTICES,
+    };
+  }
+}
+
+/******************************************************************************
+ Binner output
+ ******************************************************************************/
+
+#define ISP_TSP_PARAMETER_WORDS 8192
+#define OBJECT_LIST_WORDS 8192
+
+binner scene_binner;
+
+uint32_t binned_isp_tsp_parameter[ISP_TSP_PARAMETER_WORDS] __attribute__((aligned(32)));
+uint32_t binned_object_list[OBJECT_LIST_WORDS] __attribute__((aligned(32)));
+region_array_entry binned_region_array[BINNER__TILE_MAX] __attribute__((aligned(32)));
+
+/******************************************************************************
+ ISP/TSP Parameter
+ ******************************************************************************/
+
+typedef struct isp_tsp_parameter__polygon {
+  uint32_t isp_tsp_instruction_word;
+  uint32_t tsp_instruction_word;
+  uint32_t texture_control_word;
+  binner_vertex a;
+  binner_vertex b;
+  binner_vertex c;
+} isp_tsp_parameter__polygon;
+
+void transfer_isp_tsp_background_parameter(uint32_t isp_tsp_parameter_start)
+{
+  /*
+    Create a minimal background parameter:
+      - non-textured
+      - packed color
+      - single volume
+   */
+
+  volatile isp_tsp_parameter__polygon * params = (volatile isp_tsp_parameter__polygon *)(texture_memory32 + isp_tsp_parameter_start);
+
+  params[0].isp_tsp_instruction_word = ISP_TSP_INSTRUCTION_WORD__DEPTH_COMPARE_MODE__ALWAYS
+                                     | ISP_TSP_INSTRUCTION_WORD__CULLING_MODE__NO_CULLING;
+
+  params[0].tsp_instruction_word = TSP_INSTRUCTION_WORD__SRC_ALPHA_INSTR__ONE
+                                 | TSP_INSTRUCTION_WORD__DST_ALPHA_INSTR__ZERO
+                                 | TSP_INSTRUCTION_WORD__FOG_CONTROL__NO_FOG;
+
+  params[0].texture_control_word = 0;
+
+  // top left
+  params[0].a.x =  0.0f;
+  params[0].a.y =  0.0f;
+  params[0].a.z =  0.00001f;
+  params[0].a.color = 0x202020; // dark gray
+
+  // top right
+  params[0].b.x = 32.0f;
+  params[0].b.y =  0.0f;
+  params[0].b.z =  0.00001f;
+  params[0].b.color = 0x202020;
+
+  // bottom right
+  params[0].c.x = 32.0f;
+  params[0].c.y = 32.0f;
+  params[0].c.z =  0.00001f;
+  params[0].c.color = 0x202020;
+
+  // bottom left (implied)
+}
+
+/* background */
+#define ISP_BACKGND_T__SKIP(n) (((n) & 0x7) << 24)
+#define ISP_BACKGND_T__TAG_ADDRESS(n) (((n) & 0x1fffff) << 3)
+#define ISP_BACKGND_T__TAG_OFFSET(n) (((n) & 0x7) << 0)
+
+void main()
+{
+  /*
+    a very simple memory map:
+
+    the ordering within texture memory is not significant, and could be
+    anything
+  */
+  uint32_t framebuffer_start       = 0x200000; // intentionally the same address that the boot rom used to draw the SEGA logo
+  uint32_t isp_tsp_parameter_start = 0x400000;
+  uint32_t region_array_start      = 0x500000;
+  uint32_t object_list_start       = 0x100000;
+
+  // background_offset is relative to the beginning of isp_tsp_parameter_start;
+  // the binned ISP/TSP parameters follow the background
+  uint32_t background_offset         = (sizeof (isp_tsp_parameter__polygon)) * 0;
+  uint32_t binned_parameter_offset   = (sizeof (isp_tsp_parameter__polygon)) * 1;
+
+  scif_init();
+  tmu_init();
+
+  build_scene();
+
+  scene_binner.tile_x_num = 640 / 32;
+  scene_binner.tile_y_num = 480 / 32;
+  scene_binner.isp_tsp_parameter = binned_isp_tsp_parameter;
+  scene_binner.isp_tsp_parameter_offset = binned_parameter_offset;
+  scene_binner.isp_tsp_parameter_capacity = ISP_TSP_PARAMETER_WORDS;
+  scene_binner.object_list = binned_object_list;
+  scene_binner.object_list_start = object_list_start;
+  scene_binner.object_list_capacity = OBJECT_LIST_WORDS;
+  scene_binner.region_array = binned_region_array;
+
+  uint32_t bin_start = tmu_ticks();
+  bool binned = binner_build(&scene_binner, scene, 1 + RIBBONS);
+  uint32_t bin_ticks = tmu_ticks() - bin_start;
+
+  if (!binned) {
+    scif_string("binner_build: the scene does not fit\n");
+    scif_flush();
+    return;
+  }
+
+  // copy the binner output to texture memory
+  uint32_t copy_start = tmu_ticks();
+  sq_copy(texture_memory32 + isp_tsp_parameter_start + binned_parameter_offset,
+          binned_isp_tsp_parameter, scene_binner.isp_tsp_parameter_words * 4);
+  sq_copy(texture_memory32 + object_list_start,
+          binned_object_list, scene_binner.object_list_words * 4);
+  sq_copy(texture_memory32 + region_array_start,
+          binned_region_array, (sizeof (region_array_entry)) * scene_binner.tile_x_num * scene_binner.tile_y_num);
+  sq_wait();
+  uint32_t copy_ticks = tmu_ticks() - copy_start;
+
+  transfer_isp_tsp_background_parameter(isp_tsp_parameter_start);
+
+  // configure CORE
+
+  // REGION_BASE is the (texture memory-relative) address of the region array.
+  *REGION_BASE = region_array_start;
+
+  // PARAM_BASE is the (texture memory-relative) address of ISP/TSP parameters.
+  // Anything that references an ISP/TSP parameter does so relative to this
+  // address (and not relative to the beginning of texture memory).
+  *PARAM_BASE = isp_tsp_parameter_start;
+
+  // Set the offset of the background ISP/TSP parameter, relative to PARAM_BASE
+  // SKIP is related to the size of each vertex
+  *ISP_BACKGND_T = ISP_BACKGND_T__TAG_ADDRESS(background_offset / 4)
+                 | ISP_BACKGND_T__TAG_OFFSET(0)
+                 | ISP_BACKGND_T__SKIP(1);
+
+  // FB_W_SOF1 is the (texture memory-relative) address of the framebuffer that
+  // will be written to when a tile is rendered/flushed.
+  *FB_W_SOF1 = framebuffer_start;
+
+  // discard a stale end of render status from the boot rom
+  interrupt_clear(ISTNRM__END_OF_RENDER_TSP);
+
+  // start the actual render--the rendering process begins by interpreting the
+  // region array
+  uint32_t render_start = tmu_ticks();
+  *STARTRENDER = 1;
+
+  // interrupt_init is not called, so this polls ISTNRM
+  interrupt_wait(ISTNRM__END_OF_RENDER_TSP);
+  uint32_t render_ticks = tmu_ticks() - render_start;
+
+  *FB_R_SOF1 = framebuffer_start;
+
+  scif_label_base10("cached", CACHED);
+  scif_label_base10("triangles", scene_binner.triangles);
+  scif_label_base10("tiles covered", scene_binner.tiles_covered);
+  scif_label_base10("object list entries", scene_binner.entries);
+  scif_label_base10("object list bytes", scene_binner.object_list_words * 4);
+  scif_label_base10("ISP/TSP parameter bytes", scene_binner.isp_tsp_parameter_words * 4);
+  scif_label_base10("binner_build time (us)", tmu_ticks_to_us(bin_ticks));
+  scif_label_base10("copy time (us)", tmu_ticks_to_us(copy_ticks));
+  scif_label_base10("render time (us)", tmu_ticks_to_us(render_ticks));
+  scif_flush();
+
+  // return from main; this will effectively jump back to the serial loader
+}
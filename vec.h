@@ -0,0 +1,16 @@
+#pragma once
+
+/*
+  Vector types shared by the mesh, matrix and lighting modules.
+ */
+
+typedef struct vec2 {
+  float u;
+  float v;
+} vec2;
+
+typedef struct vec3 {
+  float x;
+  float y;
+  float z;
+} vec3;
@@ -0,0 +1,101 @@
+#include <stdint.h>
+
+#include "mesh.h"
+#include "scif.h"
+#include "sections.h"
+#include "tmu.h"
+
+/*
+  Vertex throughput benchmark: operand cache RAM vs cached system memory, and
+  the scalar transform vs the XMTRX/ftrv transform
+
+  This benchmark only produces meaningful results when built with CACHED=1:
+
+    CACHED=1 ./build.sh vertex_bench
+
+  The same transform is run over the same number of vertices with each
+  combination of:
+
+  - the input positions and output screen-space vertices in operand cache RAM
+    (see main.lds and sections.h), or identical arrays in (cached) system
+    memory
+
+  - the scalar transform (mesh_transform), or the equivalent single matrix
+    loaded into XMTRX (mesh_transform_xmtrx, as used by cube_ta_fullscreen.c;
+    see matrix.h)
+
+  The results are printed over the SCIF.
+ */
+
+// 12 bytes per vertex; 320 vertices fill 3840 of the 4096 bytes in each OCRAM
+// area.
+#define VERTEX_COUNT 320
+#define ITERATIONS 100
+
+vec3 ocram_position[VERTEX_COUNT] __ocram0;
+vec3 ocram_screen[VERTEX_COUNT] __ocram1;
+
+vec3 sdram_position[VERTEX_COUNT] __attribute__((aligned(32)));
+vec3 sdram_screen[VERTEX_COUNT] __attribute__((aligned(32)));
+
+void initialize_positions(vec3 * position, int length)
+{
+  // an arbitrary, deterministic point cloud inside the [-1, 1] cube
+  for (int i = 0; i < length; i++) {
+    position[i].x = (float)((i * 7) % 17) / 8.0f - 1.0f;
+    position[i].y = (float)((i * 5) % 13) / 6.0f - 1.0f;
+    position[i].z = (float)((i * 3) % 11) / 5.0f - 1.0f;
+  }
+}
+
+uint32_t benchmark(const vec3 * position, vec3 * screen, bool xmtrx)
+{
+  float theta = 0.0f;
+
+  uint32_t start = tmu_ticks();
+  for (int i = 0; i < ITERATIONS; i++) {
+    mesh_view view = mesh_view_init(theta, 240.f, 320.f, 240.f);
+    if (xmtrx) {
+      // the matrix is composed once per mesh, as in transfer_ta_cube
+      mat4 m = mesh_view_matrix(&view);
+      mesh_transform_xmtrx(position, screen, VERTEX_COUNT, &m);
+    } else {
+      mesh_transform(position, screen, VERTEX_COUNT, &view);
+    }
+    theta += 0.01f;
+  }
+  return tmu_ticks() - start;
+}
+
+void report(const char * name, uint32_t ticks)
+{
+  const float vertices = VERTEX_COUNT * ITERATIONS;
+  const float seconds = tmu_ticks_to_seconds(ticks);
+
+  scif_string(name);
+  scif_character('\n');
+  scif_label_base10("  total time (us)", tmu_ticks_to_us(ticks));
+  scif_label_base10("  vertices per second", (uint32_t)(vertices / seconds));
+}
+
+void main()
+{
+  scif_init();
+  tmu_init();
+
+  initialize_positions(ocram_position, VERTEX_COUNT);
+  initialize_positions(sdram_position, VERTEX_COUNT);
+
+  uint32_t sdram_ticks = benchmark(sdram_position, sdram_screen, false);
+  uint32_t ocram_ticks = benchmark(ocram_position, ocram_screen, false);
+  uint32_t sdram_xmtrx_ticks = benchmark(sdram_position, sdram_screen, true);
+  uint32_t ocram_xmtrx_ticks = benchmark(ocram_position, ocram_screen, true);
+
+  scif_label_base10("cached", CACHED);
+  scif_label_base10("vertices", VERTEX_COUNT * ITERATIONS);
+  report("system memory, scalar", sdram_ticks);
+  report("operand cache RAM, scalar", ocram_ticks);
+  report("system memory, ftrv", sdram_xmtrx_ticks);
+  report("operand cache RAM, ftrv", ocram_xmtrx_ticks);
+  scif_flush();
+}
@@ -0,0 +1,336 @@
+#pragma once
+
+#include <stdbool.h>
+#include <stdint.h>
+
+/*
+  Texture memory allocation
+
+  Texture memory is 8MB, in two 4MB banks. The "32-bit" address space
+  (texture_memory32) maps the banks one after the other:
+
+    0x000000 - 0x3fffff  bank 0
+    0x400000 - 0x7fffff  bank 1
+
+  The "64-bit" address space (texture_memory64) interleaves them, 32 bits at a
+  time: 64-bit address A is at offset ((A & ~7) / 2) + (A & 3) of bank
+  ((A >> 2) & 1). A region of the 64-bit address space therefore occupies the
+  same offsets, half of its size, in both banks. Textures are read from the
+  64-bit address space; framebuffers, object lists, ISP/TSP parameters and
+  region arrays are in the 32-bit address space.
+
+  E_DC_HW_outline.pdf "2.4 System memory mapping" (PDF page 10)
+
+  vram tracks the regions of both banks in the same (per-bank offset) terms,
+  so that 32-bit and 64-bit regions never overlap:
+
+  - vram_alloc32 and vram_alloc64 return the lowest aligned free region (first
+    fit) of the 32-bit or 64-bit address space.
+
+  - vram_alloc32 places a region in one of `banks`. Data that is accessed at
+    the same time (the object lists and ISP/TSP parameters that the TA writes,
+    and CORE reads, together) can be placed in opposite banks, so that the
+    accesses of one do not interrupt the open page of the other. With
+    VRAM__BANK_ANY, the bank with the fewest bytes in use is tried first.
+
+  - vram_reserve32 and vram_reserve64 record a region at a fixed address (for
+    example the framebuffer that the boot rom is displaying), and fail if it
+    overlaps another region.
+
+  A failed allocation or reservation returns VRAM__NONE (or false), and is
+  counted in `failed`: a program checks `failed` once, at boot, after laying
+  out its memory map.
+
+  vram_stats reports the free space of each bank: the number of free blocks,
+  the largest free block, and the fragmentation (the share of the free space
+  that is not in the largest free block), along with the peak use.
+ */
+
+#define VRAM__BANK_SIZE 0x400000
+
+#define VRAM__BANK_0 (1 << 0)
+#define VRAM__BANK_1 (1 << 1)
+#define VRAM__BANK_ANY (VRAM__BANK_0 | VRAM__BANK_1)
+
+#define VRAM__REGION_MAX 32
+
+#define VRAM__NONE 0xffffffff
+
+typedef struct vram_region {
+  // the region in each bank of `banks`
+  uint32_t offset;
+  uint32_t size;
+  uint32_t banks;
+
+  // the address and size that were allocated, in the 32-bit (view == 32) or
+  // 64-bit (view == 64) address space
+  uint32_t address;
+  uint32_t view_size;
+  uint32_t view;
+
+  const char * name;
+} vram_region;
+
+typedef struct vram {
+  vram_region region[VRAM__REGION_MAX];
+  int length;
+
+  // bytes in use, and the most ever in use, in each bank
+  uint32_t used[2];
+  uint32_t peak[2];
+
+  // allocations and reservations that failed
+  uint32_t failed;
+} vram;
+
+typedef struct vram_bank_stats {
+  uint32_t used;
+  uint32_t peak;
+  uint32_t free_blocks;
+  uint32_t largest_free;
+  // of the free bytes, how many per 1000 are outside the largest free block
+  uint32_t fragmentation_permille;
+} vram_bank_stats;
+
+void vram_init(vram * v)
+{
+  v->length = 0;
+  for (int bank = 0; bank < 2; bank++) {
+    v->used[bank] = 0;
+    v->peak[bank] = 0;
+  }
+  v->failed = 0;
+}
+
+static inline uint32_t vram_align(uint32_t offset, uint32_t align)
+{
+  return (offset + align - 1) & ~(align - 1);
+}
+
+static inline bool vram_overlaps(const vram * v, uint32_t offset, uint32_t size, uint32_t banks)
+{
+  for (int i = 0; i < v->length; i++) {
+    const vram_region * r = &v->region[i];
+    if ((r->banks & banks) && offset < r->offset + r->size && r->offset < offset + size)
+      return true;
+  }
+  return false;
+}
+
+/*
+  The lowest `align`ed offset at which `size` bytes are free in every bank of
+  `banks`, or VRAM__NONE.
+ */
+uint32_t vram_fit(const vram * v, uint32_t size, uint32_t align, uint32_t banks)
+{
+  uint32_t best = VRAM__NONE;
+
+  // a free block begins at the beginning of a bank, or at the end of a region
+  for (int i = -1; i < v->length; i++) {
+    uint32_t offset = 0;
+    if (i >= 0) {
+      if (!(v->region[i].banks & banks))
+        continue;
+      offset = vram_align(v->region[i].offset + v->region[i].size, align);
+    }
+
+    if (offset >= best || offset + size > VRAM__BANK_SIZE)
+      continue;
+    if (!vram_overlaps(v, offset, size, banks))
+      best = offset;
+  }
+
+  return best;
+}
+
+bool vram_add(vram * v, const char * name, uint32_t offset, uint32_t size, uint32_t banks,
+              uint32_t address, uint32_t view_size, uint32_t view)
+{
+  if (v->length == VRAM__REGION_MAX)
+    return false;
+
+  v->region[v->length++] = (vram_region){
+    .offset = offset,
+    .size = size,
+    .banks = banks,
+    .address = address,
+    .view_size = view_size,
+    .view = view,
+    .name = name,
+  };
+
+  for (int bank = 0; bank < 2; bank++) {
+    if (!(banks & (1 << bank)))
+      continue;
+    v->used[bank] += size;
+    if (v->used[bank] > v->peak[bank])
+      v->peak[bank] = v->used[bank];
+  }
+
+  return true;
+}
+
+/*
+  `size` bytes of the 32-bit address space, in one bank of `banks`, at an
+  `align`ed (a power of two, at most VRAM__BANK_SIZE) address. Returns the
+  address, relative to the beginning of the 32-bit address space.
+ */
+uint32_t vram_alloc32(vram * v, const char * name, uint32_t size, uint32_t align, uint32_t banks)
+{
+  // with both banks allowed, the bank with fewer bytes in use is tried first
+  int first = (banks == VRAM__BANK_ANY && v->used[1] < v->used[0]) ? 1 : 0;
+
+  for (int i = 0; i < 2; i++) {
+    int bank = first ^ i;
+    if (!(banks & (1 << bank)))
+      continue;
+
+    uint32_t offset = vram_fit(v, size, align, 1 << bank);
+    if (offset == VRAM__NONE)
+      continue;
+
+    uint32_t address = bank * VRAM__BANK_SIZE + offset;
+    if (!vram_add(v, name, offset, size, 1 << bank, address, size, 32))
+      break;
+    return address;
+  }
+
+  v->failed += 1;
+  return VRAM__NONE;
+}
+
+/*
+  `size` bytes of the 64-bit address space (half of `size` in each bank), at
+  an `align`ed (a power of two, at least 8) address. Returns the address,
+  relative to the beginning of the 64-bit address space.
+ */
+uint32_t vram_alloc64(vram * v, const char * name, uint32_t size, uint32_t align)
+{
+  size = vram_align(size, 8);
+
+  uint32_t offset = vram_fit(v, size / 2, align / 2, VRAM__BANK_ANY);
+  if (offset == VRAM__NONE || !vram_add(v, name, offset, size / 2, VRAM__BANK_ANY, offset * 2, size, 64)) {
+    v->failed += 1;
+    return VRAM__NONE;
+  }
+
+  return offset * 2;
+}
+
+/*
+  Record `size` bytes at `address` of the 32-bit address space. The region may
+  not cross the boundary between the banks.
+ */
+bool vram_reserve32(vram * v, const char * name, uint32_t address, uint32_t size)
+{
+  uint32_t bank = address / VRAM__BANK_SIZE;
+  uint32_t offset = address & (VRAM__BANK_SIZE - 1);
+
+  bool reserved = bank < 2
+               && offset + size <= VRAM__BANK_SIZE
+               && !vram_overlaps(v, offset, size, 1 << bank)
+               && vram_add(v, name, offset, size, 1 << bank, address, size, 32);
+
+  if (!reserved)
+    v->failed += 1;
+  return reserved;
+}
+
+/*
+  Record `size` bytes at (8-byte aligned) `address` of the 64-bit address
+  space.
+ */
+bool vram_reserve64(vram * v, const char * name, uint32_t address, uint32_t size)
+{
+  size = vram_align(size, 8);
+  uint32_t offset = address / 2;
+
+  bool reserved = (address & 7) == 0
+               && offset + size / 2 <= VRAM__BANK_SIZE
+               && !vram_overlaps(v, offset, size / 2, VRAM__BANK_ANY)
+               && vram_add(v, name, offset, size / 2, VRAM__BANK_ANY, address, size, 64);
+
+  if (!reserved)
+    v->failed += 1;
+  return reserved;
+}
+
+/*
+  Free the region at `address` of the `view` (32 or 64) address space.
+ */
+bool vram_free(vram * v, uint32_t address, uint32_t view)
+{
+  for (int i = 0; i < v->length; i++) {
+    vram_region * r = &v->region[i];
+    if (r->address != address || r->view != view)
+      continue;
+
+    for (int bank = 0; bank < 2; bank++) {
+      if (r->banks & (1 << bank))
+        v->used[bank] -= r->size;
+    }
+
+    v->length -= 1;
+    *r = v->region[v->length];
+    return true;
+  }
+  return false;
+}
+
+vram_bank_stats vram_stats(const vram * v, int bank)
+{
+  vram_bank_stats stats = {
+    .used = v->used[bank],
+    .peak = v->peak[bank],
+    .free_blocks = 0,
+    .largest_free = 0,
+    .fragmentation_permille = 0,
+  };
+
+  const uint32_t banks = 1 << bank;
+
+  // each free block begins at the beginning of the bank, or at the end of a
+  // region that is not followed by another region
+  for (int i = -1; i < v->length; i++) {
+    uint32_t start = 0;
+    if (i >= 0) {
+      if (!(v->region[i].banks & banks))
+        continue;
+      start = v->region[i].offset + v->region[i].size;
+    }
+
+    // count each block once, from the first region that ends at `start`
+    bool counted = false;
+    for (int j = -1; j < i && !counted; j++) {
+      uint32_t end = (j < 0) ? 0 : v->region[j].offset + v->region[j].size;
+      counted = (j < 0 || (v->region[j].banks & banks)) && end == start;
+    }
+    if (counted)
+      continue;
+
+    uint32_t end = VRAM__BANK_SIZE;
+    bool inside = false;
+    for (int j = 0; j < v->length; j++) {
+      const vram_region * r = &v->region[j];
+      if (!(r->banks & banks))
+        continue;
+      if (r->offset <= start && start < r->offset + r->size)
+        inside = true;
+      if (r->offset >= start && r->offset < end)
+        end = r->offset;
+    }
+    if (inside || end == start)
+      continue;
+
+    stats.free_blocks += 1;
+    if (end - start > stats.largest_free)
+      stats.largest_free = end - start;
+  }
+
+  // in floating point, as in tmu.h
+  uint32_t free = VRAM__BANK_SIZE - stats.used;
+  if (free != 0)
+    stats.fragmentation_permille = 1000 - (uint32_t)(1000.0f * (float)stats.largest_free / (float)free);
+
+  return stats;
+}